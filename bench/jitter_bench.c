@@ -0,0 +1,172 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/timerfd.h>
+#include "../include/realtime.h"
+#include "../include/timing_stats.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define DEFAULT_PERIOD_US 1000
+#define DEFAULT_ITERATIONS 5000
+#define DEFAULT_LOAD_THREADS 4
+#define BENCH_CPU 0
+#define BENCH_PRIORITY 80
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+struct Bench_Run {
+    long period_us;
+    long iterations;
+    struct Timing_Stats stats;
+};
+
+/*******************************************************************************
+*                                Global Variables                              *
+*******************************************************************************/
+
+static volatile int stop_load = 0;
+
+/*******************************************************************************
+*                            Function Implementations                          *
+*******************************************************************************/
+
+/**
+ * @brief Spins on the CPU to compete with the sampling thread
+ * 
+ * @param arg unused
+ * @return NULL
+ */
+static void* load_worker(void* arg __attribute__((unused))) {
+    volatile uint64_t counter = 0;
+
+    while (!stop_load) {
+        ++counter;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Waits on a periodic timerfd the same way sensor_worker does and records
+ *          how late each wakeup is
+ * 
+ * @param arg the Bench_Run to fill in
+ * @return NULL
+ */
+static void* sampling_worker(void* arg) {
+    struct Bench_Run* run = arg;
+    struct itimerspec timerspec = {0};
+    struct Sensor_Data sample = {0};
+    uint64_t expirations = 0;
+    uint64_t result;
+    int timer_fd = timerfd_create(CLOCK_MONOTONIC, 0);
+
+    clock_gettime(CLOCK_MONOTONIC, &timerspec.it_value);
+    timerspec.it_value.tv_sec += 1;
+    timerspec.it_interval.tv_nsec = run->period_us * 1000;
+    timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &timerspec, NULL);
+
+    for (long i = 0; i < run->iterations; ++i) {
+        if (read(timer_fd, &result, sizeof(result)) != sizeof(result)) {
+            break;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &sample.monotonic);
+        expirations += result;
+        sample.overruns += result - 1;
+
+        uint64_t offset_ns = (expirations - 1) * run->period_us * 1000;
+        sample.scheduled.tv_sec = timerspec.it_value.tv_sec + offset_ns / 1000000000;
+        sample.scheduled.tv_nsec = timerspec.it_value.tv_nsec + offset_ns % 1000000000;
+        if (sample.scheduled.tv_nsec >= 1000000000) {
+            sample.scheduled.tv_nsec -= 1000000000;
+            ++sample.scheduled.tv_sec;
+        }
+
+        timing_stats_add(&run->stats, &sample);
+    }
+
+    close(timer_fd);
+    return NULL;
+}
+
+/**
+ * @brief Runs the sampling thread against the load threads and prints its lateness
+ * 
+ * @param name the name of the run
+ * @param realtime whether to pin, prefault, and use SCHED_FIFO for the sampling thread
+ * @param run the run's parameters
+ * @param load_threads the number of competing threads
+ */
+static void bench(const char* name, bool realtime, struct Bench_Run* run, int load_threads) {
+    pthread_t loads[load_threads];
+    pthread_t sampler;
+    pthread_attr_t attr;
+    int error = -1;
+
+    memset(&run->stats, 0, sizeof(run->stats));
+    stop_load = 0;
+
+    for (int i = 0; i < load_threads; ++i) {
+        pthread_create(&loads[i], NULL, load_worker, NULL);
+    }
+
+    if (realtime && realtime_thread_attr(&attr, BENCH_CPU, BENCH_PRIORITY) == NOERR) {
+        error = pthread_create(&sampler, &attr, sampling_worker, run);
+        pthread_attr_destroy(&attr);
+
+        if (error != 0) {
+            fprintf(stderr, "%s: SCHED_FIFO refused (error %d), needs CAP_SYS_NICE\n", 
+                    name, error);
+        }
+    }
+
+    if (error != 0) {
+        pthread_create(&sampler, NULL, sampling_worker, run);
+    }
+
+    pthread_join(sampler, NULL);
+    stop_load = 1;
+    for (int i = 0; i < load_threads; ++i) {
+        pthread_join(loads[i], NULL);
+    }
+
+    printf("%-10s samples %6lu  overruns %5u  p50 %7lu us  p99 %7lu us  "
+            "p99.9 %7lu us  max %7lu us\n", name, run->stats.samples, run->stats.overruns,
+            timing_stats_percentile(&run->stats, 50), timing_stats_percentile(&run->stats, 99),
+            timing_stats_percentile(&run->stats, 99.9), run->stats.max_lateness_us);
+}
+
+/**
+ * @brief Compares the sampling lateness with and without real-time mode
+ * 
+ * Usage: jitter_bench [period_us] [iterations] [load_threads]
+ */
+int main(int argc, char** argv) {
+    struct Bench_Run run = {
+        .period_us = argc > 1 ? atol(argv[1]) : DEFAULT_PERIOD_US,
+        .iterations = argc > 2 ? atol(argv[2]) : DEFAULT_ITERATIONS,
+    };
+    int load_threads = argc > 3 ? atoi(argv[3]) : DEFAULT_LOAD_THREADS;
+
+    if (run.period_us <= 0 || run.period_us >= 1000000 || run.iterations <= 0) {
+        fprintf(stderr, "Usage: %s [period_us < 1000000] [iterations] [load_threads]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bench("default", false, &run, load_threads);
+
+    if (realtime_lock_memory() != NOERR) {
+        fprintf(stderr, "mlockall failed, continuing without locked memory\n");
+    }
+    realtime_prefault_stack(REALTIME_PREFAULT_SIZE);
+    bench("realtime", true, &run, load_threads);
+
+    return EXIT_SUCCESS;
+}
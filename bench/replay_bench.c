@@ -0,0 +1,139 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/bus_capture.h"
+#include "../include/i2c_bus.h"
+#include "../include/device_io.h"
+#include "../include/functions.h"
+#include "../include/sensor_data.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define DEFAULT_PASSES 100
+#define PAYLOAD_SIZE 64
+#define REPLAY_ADAPTER 1
+#define MAX_DEVICES 8
+
+/*******************************************************************************
+*                            Function Implementations                          *
+*******************************************************************************/
+
+/**
+ * @brief Gets the current CLOCK_MONOTONIC time in nanoseconds
+ *
+ * @return the current monotonic time in nanoseconds
+ */
+static uint64_t now_ns(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Reads the device's captured samples the way its worker does and formats
+ *          each channel's payload the way the publisher does
+ *
+ * @param capture the capture being replayed
+ * @param device_addr the device's hex address on the I2C bus
+ * @param fd the device's file descriptor
+ * @param errors the out parameter incremented for every read that failed
+ * @return the number of samples read
+ */
+static uint64_t replay_device(struct Bus_Capture* capture, uint8_t device_addr, int* fd,
+                              uint64_t* errors) {
+    char payload[PAYLOAD_SIZE];
+    float data[MAX_DATAPOINTS];
+    int num_data = channel_count(device_addr);
+    uint64_t samples = 0;
+
+    while (!bus_capture_done(capture, device_addr)) {
+        bool is_ready = false;
+
+        if (read_data_flag(&is_ready, device_addr, fd) != NOERR) {
+            ++*errors;
+            continue;
+        }
+
+        if (!is_ready) {
+            continue;
+        }
+
+        if (read_into_buffer(data, num_data, device_addr, fd) != NOERR) {
+            ++*errors;
+            continue;
+        }
+
+        for (int channel = 0; channel < num_data; ++channel) {
+            snprintf(payload, sizeof(payload), "%.2f", data[channel]);
+            //Keeps the compiler from dropping the payloads
+            __asm__ __volatile__("" : : "g"(payload) : "memory");
+        }
+        ++samples;
+    }
+
+    return samples;
+}
+
+/**
+ * @brief Replays a capture through the drivers' commands and decoders as fast as
+ *          they run, without waiting for the devices' execution times
+ *
+ * Usage: replay_bench <capture file> [passes]
+ */
+int main(int argc, char** argv) {
+    struct Bus_Capture capture;
+    long passes = argc > 2 ? atol(argv[2]) : DEFAULT_PASSES;
+    const uint8_t* devices;
+    int num_devices;
+    int fds[MAX_DEVICES];
+    uint64_t samples = 0;
+    uint64_t errors = 0;
+    uint64_t start;
+    double elapsed_s;
+    int8_t error;
+
+    if (argc < 2 || passes <= 0) {
+        fprintf(stderr, "Usage: %s <capture file> [passes]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if ((error = bus_capture_open(&capture, argv[1])) != NOERR) {
+        fprintf(stderr, "Unable to open %s, returned with error %d\n", argv[1], error);
+        return EXIT_FAILURE;
+    }
+
+    i2c_bus_replay(&capture);
+    devices = known_devices(&num_devices);
+    for (int i = 0; i < num_devices; ++i) {
+        if (device_init(REPLAY_ADAPTER, devices[i], &fds[i]) != NOERR) {
+            fprintf(stderr, "Unable to initialize device %d\n", devices[i]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    start = now_ns();
+    for (long pass = 0; pass < passes; ++pass) {
+        bus_capture_rewind(&capture);
+        for (int i = 0; i < num_devices; ++i) {
+            samples += replay_device(&capture, devices[i], &fds[i], &errors);
+        }
+    }
+    elapsed_s = (double)(now_ns() - start) / 1e9;
+
+    printf("%llu transactions  %llu samples  %llu errors  %.3f s\n",
+            (unsigned long long)(bus_capture_count(&capture) * (uint64_t)passes),
+            (unsigned long long)samples, (unsigned long long)errors, elapsed_s);
+    printf("%.0f transactions/s  %.0f samples/s\n",
+            (double)bus_capture_count(&capture) * (double)passes / elapsed_s, (double)samples / elapsed_s);
+
+    for (int i = 0; i < num_devices; ++i) {
+        device_free(devices[i], &fds[i]);
+    }
+    i2c_bus_replay(NULL);
+    bus_capture_close(&capture);
+    return EXIT_SUCCESS;
+}
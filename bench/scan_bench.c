@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../include/scan.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+//A day of readings at the default 5 second period
+#define DEFAULT_LENGTH 17280
+#define DEFAULT_ITERATIONS 2000
+#define NAN_EVERY 50
+#define THRESHOLD 35.0f
+
+/*******************************************************************************
+*                            Function Implementations                          *
+*******************************************************************************/
+
+typedef void (*Scan_Kernel)(const float*, uint32_t, float, struct Scan_Result*);
+
+/**
+ * @brief Gets the current CLOCK_MONOTONIC time in nanoseconds
+ * 
+ * @return the current monotonic time in nanoseconds
+ */
+static uint64_t now_ns(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Times the kernel over the column and prints the time per scan
+ * 
+ * @param name the name of the kernel
+ * @param kernel the kernel
+ * @param values the column
+ * @param length the length of the column
+ * @param iterations the number of scans timed
+ * @return the time per scan in nanoseconds
+ */
+static double bench(const char* name, Scan_Kernel kernel, const float* values, uint32_t length,
+                    long iterations) {
+    struct Scan_Result result;
+    uint64_t start = now_ns();
+    double elapsed_ns;
+
+    for (long i = 0; i < iterations; ++i) {
+        scan_init(&result);
+        kernel(values, length, THRESHOLD, &result);
+        //Keeps the compiler from dropping the scans
+        __asm__ __volatile__("" : : "g"(&result) : "memory");
+    }
+
+    elapsed_ns = (double)(now_ns() - start) / iterations;
+    printf("%-7s %10.1f us/scan  %6.2f ns/value  count %u  nan %u  above %u  "
+            "min %.1f  max %.1f  mean %.2f\n", name, elapsed_ns / 1000, elapsed_ns / length,
+            result.count, result.nan_count, result.above, result.min, result.max,
+            scan_mean(&result));
+
+    return elapsed_ns;
+}
+
+/**
+ * @brief Compares the scalar and vectorized scan kernels over a PM2.5-like column
+ * 
+ * Usage: scan_bench [length] [iterations]
+ */
+int main(int argc, char** argv) {
+    long length = argc > 1 ? atol(argv[1]) : DEFAULT_LENGTH;
+    long iterations = argc > 2 ? atol(argv[2]) : DEFAULT_ITERATIONS;
+    double scalar_ns;
+    double vector_ns;
+    float* values;
+
+    if (length <= 0 || length > UINT32_MAX || iterations <= 0) {
+        fprintf(stderr, "Usage: %s [length] [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if ((values = malloc(sizeof(float) * (size_t)length)) == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    srand(1);
+    for (long i = 0; i < length; ++i) {
+        values[i] = i % NAN_EVERY == 0 ? NAN : (float)(rand() % 600) / 10.0f;
+    }
+
+    scalar_ns = bench("scalar", scan_column_scalar, values, (uint32_t)length, iterations);
+    vector_ns = bench(scan_kernel(), scan_column, values, (uint32_t)length, iterations);
+    printf("speedup %.2fx\n", scalar_ns / vector_ns);
+
+    free(values);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,379 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "../include/clock_source.h"
+#include "../include/i2c_bus.h"
+#include "../include/sensirion.h"
+#include "../include/device_io.h"
+#include "../include/functions.h"
+#include "../include/sensor_data.h"
+#include "../include/record_join.h"
+#include "../include/backlog.h"
+#include "../include/columnar.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define DEFAULT_GATEWAYS MAX_BUSES
+#define DEFAULT_HOURS 24
+#define PERIOD_US 1000000
+#define LATENESS_MS 1000
+#define PUBLISH_BATCH 16
+#define PAYLOAD_SIZE 64
+#define MAX_DEVICES 8
+//2024-03-01T00:00:00Z, so every run stamps the same times
+#define START_REALTIME_NS 1709251200000000000ULL
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief A simulated Sensirion device, told apart by its adapter and address
+ */
+struct Sim_Device {
+    int fd;
+    uint8_t address;
+    uint16_t command;
+};
+
+/**
+ * @brief Answers every read with valid words that drift slowly with the clock,
+ *          and a one word response, a data ready flag, with ready
+ */
+struct Simulator {
+    int num_devices;
+    struct Sim_Device devices[MAX_BUSES * MAX_DEVICES];
+    uint64_t transfers;
+};
+
+struct Bench_Device {
+    uint8_t address;
+    int fd;
+    uint32_t sequence;
+    uint32_t overruns;
+    struct Clock_Timer timer;
+    struct Column_Writer writer;
+};
+
+/**
+ * @brief The devices on one adapter and the join of their samples, standing in for
+ *          a gateway's publisher
+ */
+struct Gateway {
+    int num_devices;
+    struct Bench_Device devices[MAX_DEVICES];
+    struct Record_Join join;
+};
+
+/*******************************************************************************
+*                                Global Variables                              *
+*******************************************************************************/
+
+static struct Simulator simulator;
+static struct Gateway gateways[MAX_BUSES];
+static struct Backlog backlog;
+
+/*******************************************************************************
+*                            Function Implementations                          *
+*******************************************************************************/
+
+/**
+ * @brief Gets the simulated device on the adapter at the address, adding it the
+ *          first time it is addressed
+ *
+ * @param fd the adapter's file descriptor
+ * @param device_addr the device's hex address on the I2C bus
+ * @return the simulated device or NULL if there are too many
+ */
+static struct Sim_Device* sim_device(int fd, uint8_t device_addr) {
+    for (int i = 0; i < simulator.num_devices; ++i) {
+        if (simulator.devices[i].fd == fd && simulator.devices[i].address == device_addr) {
+            return &simulator.devices[i];
+        }
+    }
+
+    if (simulator.num_devices == MAX_BUSES * MAX_DEVICES) {
+        return NULL;
+    }
+
+    struct Sim_Device* device = &simulator.devices[simulator.num_devices++];
+    device->fd = fd;
+    device->address = device_addr;
+    device->command = 0;
+    return device;
+}
+
+/**
+ * @brief Takes a command written to a simulated device
+ *
+ * @param context unused
+ * @param fd the adapter's file descriptor
+ * @param device_addr the device's hex address on the I2C bus
+ * @param data the command
+ * @param count the number of bytes written
+ * @return WRITE_ERR if there are too many devices or no command was written, NOERR otherwise
+ */
+static int8_t sim_write(void* context __attribute__((unused)), int fd, uint8_t device_addr,
+                        const uint8_t* data, uint16_t count) {
+    struct Sim_Device* device = sim_device(fd, device_addr);
+
+    ++simulator.transfers;
+    if (device == NULL || count < SENSIRION_WORD_SIZE) {
+        return WRITE_ERR;
+    }
+
+    device->command = (uint16_t)(data[0] << 8 | data[1]);
+    return NOERR;
+}
+
+/**
+ * @brief Answers a read from a simulated device with the words and their CRCs
+ *
+ * @param context unused
+ * @param fd the adapter's file descriptor
+ * @param device_addr the device's hex address on the I2C bus
+ * @param data the out parameter for the response
+ * @param count the number of bytes read
+ * @return NACK_ERR if there are too many devices, NOERR otherwise
+ */
+static int8_t sim_read(void* context __attribute__((unused)), int fd, uint8_t device_addr,
+                       uint8_t* data, uint16_t count) {
+    struct Sim_Device* device = sim_device(fd, device_addr);
+    int words = count / (SENSIRION_WORD_SIZE + SENSIRION_CRC_LENGTH);
+    uint64_t minutes = clock_source_now_us() / 60000000;
+
+    ++simulator.transfers;
+    if (device == NULL) {
+        return NACK_ERR;
+    }
+
+    for (int i = 0; i < words; ++i) {
+        uint8_t* word = &data[i * (SENSIRION_WORD_SIZE + SENSIRION_CRC_LENGTH)];
+        //Stays well clear of the channels' invalid values
+        uint16_t value = words == 1 ? 1
+            : (uint16_t)(400 + (minutes + 131 * (uint64_t)i + device->command + (uint64_t)fd) % 600);
+
+        word[0] = (uint8_t)(value >> 8);
+        word[1] = (uint8_t)value;
+        word[2] = sensirion_crc(word);
+    }
+
+    return NOERR;
+}
+
+/**
+ * @brief Adds the sample's values to the run's checksum, FNV-1a over their bits
+ *
+ * @param checksum the running checksum
+ * @param sample the sample
+ */
+static void checksum_sample(uint64_t* checksum, const struct Sensor_Data* sample) {
+    const uint8_t* bytes = (const uint8_t*)sample->data;
+
+    for (size_t i = 0; i < sample->num_data * sizeof(float); ++i) {
+        *checksum = (*checksum ^ bytes[i]) * 0x100000001B3ULL;
+    }
+}
+
+/**
+ * @brief Formats each channel's payload of the backlog's oldest records the way
+ *          the publisher does, a batch at a time
+ *
+ * @return the number of records published
+ */
+static uint32_t publish_batch(void) {
+    const struct Joined_Record* record;
+    char payload[PAYLOAD_SIZE];
+    uint32_t published = 0;
+
+    while (published < PUBLISH_BATCH && (record = backlog_peek(&backlog)) != NULL) {
+        for (int i = 0; i < record->num_devices; ++i) {
+            for (int channel = 0; channel < record->samples[i].num_data; ++channel) {
+                snprintf(payload, sizeof(payload), "%.2f", record->samples[i].data[channel]);
+                //Keeps the compiler from dropping the payloads
+                __asm__ __volatile__("" : : "g"(payload) : "memory");
+            }
+        }
+
+        backlog_pop(&backlog);
+        ++published;
+    }
+
+    return published;
+}
+
+/**
+ * @brief Queues the records the join emitted for publishing
+ *
+ * @param records the emitted records
+ * @param num_records the number of records emitted, negative if the sample was rejected
+ * @return the number of records queued
+ */
+static uint64_t queue_records(const struct Joined_Record* records, int num_records) {
+    for (int i = 0; i < num_records; ++i) {
+        backlog_push(&backlog, &records[i]);
+    }
+
+    return num_records > 0 ? (uint64_t)num_records : 0;
+}
+
+/**
+ * @brief Finds the device whose timer expires first
+ *
+ * @param num_gateways the number of gateways
+ * @param gateway the out parameter for the device's gateway
+ * @return the device
+ */
+static struct Bench_Device* next_device(int num_gateways, struct Gateway** gateway) {
+    struct Bench_Device* next = NULL;
+
+    for (int g = 0; g < num_gateways; ++g) {
+        for (int i = 0; i < gateways[g].num_devices; ++i) {
+            if (next == NULL || gateways[g].devices[i].timer.next_ns < next->timer.next_ns) {
+                next = &gateways[g].devices[i];
+                *gateway = &gateways[g];
+            }
+        }
+    }
+
+    return next;
+}
+
+/**
+ * @brief Samples every simulated device once a second on a virtual clock and runs
+ *          the samples through the join, the backlog, the publisher's formatting and
+ *          optionally the columnar export, as fast as the code runs
+ *
+ * Usage: soak_bench [gateways] [hours] [export directory]
+ */
+int main(int argc, char** argv) {
+    static const struct I2C_Backend backend = {sim_write, sim_read, NULL};
+    int num_gateways = argc > 1 ? atoi(argv[1]) : DEFAULT_GATEWAYS;
+    double hours = argc > 2 ? atof(argv[2]) : DEFAULT_HOURS;
+    const char* export_dir = argc > 3 ? argv[3] : NULL;
+    struct Joined_Record records[JOIN_MAX_PENDING];
+    const uint8_t* addresses;
+    int num_addresses;
+    uint64_t end_us;
+    uint64_t samples = 0;
+    uint64_t errors = 0;
+    uint64_t emitted = 0;
+    uint64_t published = 0;
+    uint64_t overruns = 0;
+    uint64_t late = 0;
+    uint64_t checksum = 0xCBF29CE484222325ULL;
+    struct timespec wall_start;
+    struct timespec wall_end;
+    double elapsed_s;
+
+    if (num_gateways <= 0 || num_gateways > MAX_BUSES || hours <= 0) {
+        fprintf(stderr, "Usage: %s [gateways, at most %d] [hours] [export directory]\n",
+                argv[0], MAX_BUSES);
+        return EXIT_FAILURE;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+    clock_source_use_virtual(START_REALTIME_NS);
+    i2c_bus_simulate(&backend);
+    backlog_init(&backlog);
+    addresses = known_devices(&num_addresses);
+
+    for (int g = 0; g < num_gateways; ++g) {
+        struct Gateway* gateway = &gateways[g];
+        char directory[COLUMNAR_PATH_SIZE];
+
+        if (export_dir != NULL) {
+            snprintf(directory, sizeof(directory), "%s/gateway%d", export_dir, g);
+            mkdir(directory, 0755);
+        }
+
+        record_join_init(&gateway->join, addresses, num_addresses, PERIOD_US / 1000, LATENESS_MS);
+        gateway->num_devices = num_addresses;
+        for (int i = 0; i < num_addresses; ++i) {
+            struct Bench_Device* device = &gateway->devices[i];
+
+            device->address = addresses[i];
+            if (device_init((uint32_t)g + 1, device->address, &device->fd) != NOERR) {
+                fprintf(stderr, "Unable to initialize device %d on adapter %d\n", device->address, g + 1);
+                return EXIT_FAILURE;
+            }
+
+            if (export_dir != NULL) {
+                columnar_writer_init(&device->writer, directory, 86400, device->address,
+                                     channel_count(device->address));
+            }
+            clock_timer_start(&device->timer, PERIOD_US);
+        }
+    }
+
+    end_us = clock_source_now_us() + (uint64_t)(hours * 3600.0 * 1e6);
+    while (clock_source_now_us() < end_us) {
+        struct Gateway* gateway = NULL;
+        struct Bench_Device* device = next_device(num_gateways, &gateway);
+        struct Sensor_Data sample = {.device_addr = device->address};
+        uint64_t periods = clock_timer_wait(&device->timer);
+        bool is_ready = false;
+
+        device->overruns += (uint32_t)(periods - 1);
+        sensor_data_schedule(&sample, &device->sequence, periods);
+
+        if (read_data_flag(&is_ready, device->address, &device->fd) != NOERR || !is_ready) {
+            ++errors;
+            continue;
+        }
+
+        sample.num_data = channel_count(device->address);
+        sample.overruns = device->overruns;
+        if (read_into_buffer(sample.data, sample.num_data, device->address, &device->fd) != NOERR) {
+            ++errors;
+            continue;
+        }
+        sensor_data_stamp(&sample);
+        checksum_sample(&checksum, &sample);
+        ++samples;
+
+        if (export_dir != NULL && columnar_writer_add(&device->writer, &sample) != NOERR) {
+            ++errors;
+        }
+
+        emitted += queue_records(records, record_join_add(&gateway->join, &sample, records));
+        emitted += queue_records(records, record_join_poll(&gateway->join, monotonic_now_ms(), records));
+        published += publish_batch();
+    }
+
+    for (int g = 0; g < num_gateways; ++g) {
+        emitted += queue_records(records, record_join_flush(&gateways[g].join, records));
+        late += gateways[g].join.late_samples;
+
+        for (int i = 0; i < gateways[g].num_devices; ++i) {
+            overruns += gateways[g].devices[i].overruns;
+            if (export_dir != NULL) {
+                columnar_writer_close(&gateways[g].devices[i].writer);
+            }
+            device_free(gateways[g].devices[i].address, &gateways[g].devices[i].fd);
+        }
+    }
+    while (backlog.count > 0) {
+        published += publish_batch();
+    }
+
+    i2c_bus_simulate(NULL);
+    clock_source_use_real();
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+    elapsed_s = (double)(wall_end.tv_sec - wall_start.tv_sec)
+              + (double)(wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+
+    printf("%.1f simulated hours  %d devices  %.3f s  %.0fx real time\n", hours,
+            num_gateways * num_addresses, elapsed_s, hours * 3600.0 / elapsed_s);
+    printf("%llu samples  %llu records  %llu published  %llu transfers\n",
+            (unsigned long long)samples, (unsigned long long)emitted,
+            (unsigned long long)published, (unsigned long long)simulator.transfers);
+    printf("%llu errors  %llu overruns  %llu late  %u dropped  checksum %016llx\n",
+            (unsigned long long)errors, (unsigned long long)overruns, (unsigned long long)late,
+            backlog.dropped, (unsigned long long)checksum);
+    return EXIT_SUCCESS;
+}
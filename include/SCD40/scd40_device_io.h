@@ -10,7 +10,7 @@
 #include <sys/ioctl.h>
 #include <errno.h>
 #include "../errors.h"
-#include <linux/i2c-dev.h>
+#include "../i2c_bus.h"
 
 /*******************************************************************************
 *                              Defined Constants                               *
@@ -25,6 +25,8 @@
 /**
  * @brief Initializes the hardware and software components of the given I2C adapter
  * 
+ * The adapter's file descriptor is shared with every other device on the same bus
+ * 
  * @param adapter_num the I2C adapter to initialize
  * @param fd the out parameter file descriptor for the I2C device
  * @return int 0 is successful or INIT_FAILED if unsuccessful
@@ -6,6 +6,8 @@
 #include "scd40_buffer_manip.h"
 #include "../errors.h"
 #include "scd40_device_io.h"
+#include "../channels.h"
+#include "../sensirion.h"
 #include <unistd.h>
 #include <math.h>
 
@@ -13,12 +15,52 @@
 *                              Defined Constants                               *
 *******************************************************************************/
 #define SCD40_MAX_RETRIES 4
-#define SCD40_DATAPOINTS 3
 
-#define SCD40_START_MEASUREMENT 0x21B1
-#define SCD40_STOP_MEASUREMENT 0x3F86
-#define SCD40_READ_DATA_FLAG 0xE4B8
-#define SCD40_READ_VALUES 0xEC05
+//X(id, code, execution_us, response_words, attempts, rereads), see sensirion.h
+//The SCD40 clears a sample once it has been read, so a bad response is always sent for again
+#define SCD40_COMMANDS(X) \
+    X(START_MEASUREMENT, 0x21B1, 0, 0, 1, 0) \
+    X(STOP_MEASUREMENT, 0x3F86, 500000, 0, 1, 0) \
+    X(READ_DATA_FLAG, 0xE4B8, 1000, 1, 1, 0) \
+    X(READ_VALUES, 0xEC05, 1000, SCD40_DATAPOINTS, SCD40_MAX_RETRIES, 0) \
+    X(READ_SERIAL_NUMBER, 0x3682, 1000, 3, 1, 0) \
+    X(REINIT, 0x3646, 30000, 0, 1, 0)
+
+#define SCD40_COMMAND_ID(id, ...) SCD40_##id,
+
+//X(id, key, label, word, signedness, scale, offset, invalid, unit), see channels.h
+//The SEN55's temperature and humidity are the ones in the combined message
+#define SCD40_CHANNELS(X) \
+    X(CO2, "co2", "CO2", 0, CHANNEL_UNSIGNED, 1.0F, 0.0F, CHANNEL_NO_INVALID, "ppm") \
+    X(TEMPERATURE, "temperature", NULL, 1, CHANNEL_UNSIGNED, FAHRENHEIT_SCALE(175.0F / 65535.0F), \
+      FAHRENHEIT_OFFSET(-45.0F), CHANNEL_NO_INVALID, "F") \
+    X(HUMIDITY, "humidity", NULL, 2, CHANNEL_UNSIGNED, 100.0F / 65535.0F, 0.0F, \
+      CHANNEL_NO_INVALID, "%RH")
+
+#define SCD40_CHANNEL_ID(id, ...) SCD40_##id,
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+//The index of each channel in the sample's data
+enum Scd40_Channel {
+    SCD40_CHANNELS(SCD40_CHANNEL_ID)
+    SCD40_DATAPOINTS
+};
+
+//The index of each command in scd40_commands
+enum Scd40_Command {
+    SCD40_COMMANDS(SCD40_COMMAND_ID)
+    SCD40_NUM_COMMANDS
+};
+
+/*******************************************************************************
+*                                Global Variables                              *
+*******************************************************************************/
+
+extern const struct Channel_Descriptor scd40_channels[SCD40_DATAPOINTS];
+extern const struct Sensirion_Command scd40_commands[SCD40_NUM_COMMANDS];
 
 /*******************************************************************************
 *                           Function Definitions                               *
@@ -49,6 +91,18 @@ int8_t scd40_stop_measurement(int* fd);
  */
 int8_t scd40_read_data_flag(bool* is_ready, int* fd);
 
+/**
+ * @brief Checks whether the device is already in periodic measurement mode
+ * 
+ * The serial number can only be read while the device is idle, so a refused read
+ * followed by a successful data-ready read means the device is measuring
+ * 
+ * @param is_measuring the out parameter whether the device is measuring
+ * @param fd the opened file descriptor of the I2C device
+ * @return an error if the device doesn't respond at all, NOERR otherwise
+ */
+int8_t scd40_read_measurement_state(bool* is_measuring, int* fd);
+
 /**
  * @brief Reads the data from the device into the buffer
  * 
@@ -59,4 +113,33 @@ int8_t scd40_read_data_flag(bool* is_ready, int* fd);
  */
 int8_t scd40_read_into_buffer(float* data, size_t buffer_size, int* fd);
 
+/**
+ * @brief Stops the measurements and reinitializes the device from its EEPROM
+ * 
+ * The SCD40 has no soft reset while measuring, so it is stopped first and is left
+ * idle afterwards
+ * 
+ * @param fd the opened file descriptor of the I2C device
+ * @return an error if one is reached, NOERR otherwise
+ */
+int8_t scd40_reinit(int* fd);
+
+/**
+ * @brief Measures how long the device really takes to answer the data-ready flag,
+ * reading the values early is indistinguishable from a sample not being ready
+ * 
+ * Should be called while the device is measuring, see sensirion_calibrate()
+ * 
+ * @return an error if the device couldn't be written to or read from, else NOERROR is returned
+ */
+int8_t scd40_calibrate_delays(int* fd);
+
+/**
+ * @brief Gets the device's link counts summed over its commands
+ * 
+ * @param stats the out parameter for the counts, the delay is the data-ready flag's
+ *          plus the values'
+ */
+void scd40_read_bus_stats(struct Sensirion_Stats* stats);
+
 #endif
\ No newline at end of file
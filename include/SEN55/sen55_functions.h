@@ -6,6 +6,8 @@
 #include "sen55_buffer_manip.h"
 #include "../errors.h"
 #include "sen55_device_io.h"
+#include "../channels.h"
+#include "../sensirion.h"
 #include <unistd.h>
 #include <math.h>
 
@@ -14,18 +16,61 @@
 *******************************************************************************/
 
 #define MAX_RETRIES 4
+#define SEN55_REREADS 2
 #define MAX_NAME_CHARS 32
-#define SEN55_DATAPOINTS 8
-
-//Device Address Pointers
-#define DATA_READY_FLAG 0x202
-#define START_MEASUREMENT 0x21
-#define STOP_MEASUREMENT 0x104
-#define READ_VALUES 0x3C4
-#define READ_NAME 0xD014
-#define READ_SERIAL_NUMBER 0xD033
-#define READ_FIRMWARE 0xD100
-#define RESET 0xD304
+#define SEN55_PROBE_ATTEMPTS 11
+#define SEN55_PROBE_INTERVAL_US 100000
+
+//X(id, code, execution_us, response_words, attempts, rereads), see sensirion.h
+//The SEN55 keeps a response until the next command, so a bad one is read again first
+#define SEN55_COMMANDS(X) \
+    X(START_MEASUREMENT, 0x0021, 50000, 0, 1, 0) \
+    X(STOP_MEASUREMENT, 0x0104, 200000, 0, 1, 0) \
+    X(DATA_READY_FLAG, 0x0202, 20000, 1, 1, SEN55_REREADS) \
+    X(READ_VALUES, 0x03C4, 20000, SEN55_DATAPOINTS, MAX_RETRIES, SEN55_REREADS) \
+    X(READ_NAME, 0xD014, 20000, MAX_NAME_CHARS / 2, 1, SEN55_REREADS) \
+    X(READ_SERIAL_NUMBER, 0xD033, 20000, MAX_NAME_CHARS / 2, 1, SEN55_REREADS) \
+    X(READ_FIRMWARE, 0xD100, 20000, 1, 1, SEN55_REREADS) \
+    X(RESET, 0xD304, 100000, 0, 1, 0)
+
+#define SEN55_COMMAND_ID(id, ...) SEN55_##id,
+
+//X(id, key, label, word, signedness, scale, offset, invalid, unit), see channels.h
+#define SEN55_CHANNELS(X) \
+    X(PM1_0, "pm1_0", "Mass Concentration PM1.0", 0, CHANNEL_UNSIGNED, 0.1F, 0.0F, 0xFFFF, "ug/m3") \
+    X(PM2_5, "pm2_5", "Mass Concentration PM2.5", 1, CHANNEL_UNSIGNED, 0.1F, 0.0F, 0xFFFF, "ug/m3") \
+    X(PM4_0, "pm4_0", "Mass Concentration PM4.0", 2, CHANNEL_UNSIGNED, 0.1F, 0.0F, 0xFFFF, "ug/m3") \
+    X(PM10, "pm10", "Mass Concentration PM10", 3, CHANNEL_UNSIGNED, 0.1F, 0.0F, 0xFFFF, "ug/m3") \
+    X(HUMIDITY, "humidity", "Ambient Humidity", 4, CHANNEL_SIGNED, 0.01F, 0.0F, 0x7FFF, "%RH") \
+    X(TEMPERATURE, "temperature", "Ambient Temperature", 5, CHANNEL_SIGNED, \
+      FAHRENHEIT_SCALE(1.0F / 200.0F), FAHRENHEIT_OFFSET(0.0F), 0x7FFF, "F") \
+    X(VOC_INDEX, "voc_index", "VOC Index", 6, CHANNEL_SIGNED, 0.1F, 0.0F, 0x7FFF, "index") \
+    X(NOX_INDEX, "nox_index", "NOx Index", 7, CHANNEL_SIGNED, 0.1F, 0.0F, 0x7FFF, "index")
+
+#define SEN55_CHANNEL_ID(id, ...) SEN55_##id,
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+//The index of each channel in the sample's data
+enum Sen55_Channel {
+    SEN55_CHANNELS(SEN55_CHANNEL_ID)
+    SEN55_DATAPOINTS
+};
+
+//The index of each command in sen55_commands
+enum Sen55_Command {
+    SEN55_COMMANDS(SEN55_COMMAND_ID)
+    SEN55_NUM_COMMANDS
+};
+
+/*******************************************************************************
+*                                Global Variables                              *
+*******************************************************************************/
+
+extern const struct Channel_Descriptor sen55_channels[SEN55_DATAPOINTS];
+extern const struct Sensirion_Command sen55_commands[SEN55_NUM_COMMANDS];
 
 /*******************************************************************************
 *                           Function Definitions                               *
@@ -55,6 +100,17 @@ int8_t sen55_stop_measurement(int* fd);
  */
 int8_t sen55_read_data_flag(bool* is_ready, int* fd);
 
+/**
+ * @brief Checks whether the device is already in Measurement-Mode
+ * 
+ * The SEN55 produces a sample every second while measuring, so the data-ready flag is
+ * polled for slightly longer than that before the device is considered idle
+ * 
+ * @param is_measuring the out parameter whether the device is measuring
+ * @return an error if the device couldn't be written or read from, else NOERROR is returned
+ */
+int8_t sen55_read_measurement_state(bool* is_measuring, int* fd);
+
 /**
  * @brief Reads the data the device has ready into the inputted buffer
  * 
@@ -101,4 +157,22 @@ int8_t sen55_read_firmware(uint8_t* firmware_versio, int* fd);
  */
 int8_t sen55_reset(int* fd);
 
+/**
+ * @brief Measures how long the device really takes to answer the data-ready flag and
+ * the values
+ * 
+ * Should be called while the device is measuring, see sensirion_calibrate()
+ * 
+ * @return an error if the device couldn't be written to or read from, else NOERROR is returned
+ */
+int8_t sen55_calibrate_delays(int* fd);
+
+/**
+ * @brief Gets the device's link counts summed over its commands
+ * 
+ * @param stats the out parameter for the counts, the delay is the data-ready flag's
+ *          plus the values'
+ */
+void sen55_read_bus_stats(struct Sensirion_Stats* stats);
+
 #endif
\ No newline at end of file
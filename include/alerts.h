@@ -0,0 +1,137 @@
+#ifndef ALERTS_H
+#define ALERTS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include "sensor_data.h"
+#include "device_io.h"
+#include "errors.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define ALERT_MAX_RULES 16
+#define ALERT_MAX_CODE 48
+#define ALERT_MAX_STACK 16
+#define ALERT_MAX_DEVICES 8
+#define ALERT_NAME_SIZE 32
+
+enum Alert_Op {
+    ALERT_CONST,
+    ALERT_LOAD,     //the channel's latest reading
+    ALERT_DELTA,    //the change in the channel since its previous reading
+    ALERT_ADD,
+    ALERT_SUB,
+    ALERT_MUL,
+    ALERT_DIV,
+    ALERT_NEG,
+    ALERT_LT,
+    ALERT_LE,
+    ALERT_GT,
+    ALERT_GE,
+    ALERT_EQ,
+    ALERT_NE,
+    ALERT_AND,
+    ALERT_OR,
+    ALERT_NOT,
+};
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+struct Alert_Instruction {
+    uint8_t op;
+    uint8_t device_addr;
+    uint8_t channel;
+    float value;
+};
+
+/**
+ * @brief A rule compiled to stack-machine code
+ *
+ * The expression is true when it evaluates to anything but 0 or NAN, so a rule
+ * reading a missing or invalid channel never fires
+ */
+struct Alert_Rule {
+    char name[ALERT_NAME_SIZE];
+    uint8_t num_code;
+    struct Alert_Instruction code[ALERT_MAX_CODE];
+};
+
+/**
+ * @brief A rule changing state
+ */
+struct Alert_Event {
+    const struct Alert_Rule* rule;
+    bool active;
+    float value;
+};
+
+/**
+ * @brief The rules and the readings they are evaluated against
+ */
+struct Alert_Engine {
+    const struct Alert_Rule* rules;
+    int num_rules;
+    bool active[ALERT_MAX_RULES];
+    int num_devices;
+    uint8_t device_addrs[ALERT_MAX_DEVICES];
+    bool has_previous[ALERT_MAX_DEVICES];
+    float latest[ALERT_MAX_DEVICES][MAX_DATAPOINTS];
+    float previous[ALERT_MAX_DEVICES][MAX_DATAPOINTS];
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Compiles a "name: expression" rule
+ *
+ * Expressions are built from numbers, channels written as DEVICE.channel,
+ * delta(DEVICE.channel), the arithmetic operators + - * /, the comparisons
+ * < <= > >= == !=, and the logical operators && || !, with parentheses.
+ * For example "co2_high: SCD40.co2 > 1500 && SEN55.voc_index > 250"
+ *
+ * @param source the rule's text
+ * @param rule the out parameter for the compiled rule
+ * @return CONFIG_ERR if the rule can't be compiled, NOERR otherwise
+ */
+int8_t alert_compile(const char* source, struct Alert_Rule* rule);
+
+/**
+ * @brief Evaluates the rule's code against the latest readings
+ *
+ * @param engine the engine holding the readings
+ * @param rule the compiled rule
+ * @return the expression's value
+ */
+float alert_evaluate(const struct Alert_Engine* engine, const struct Alert_Rule* rule);
+
+/**
+ * @brief Starts evaluating the rules with every rule inactive and no readings
+ *
+ * @param engine the engine
+ * @param rules the compiled rules, must outlive the engine
+ * @param num_rules the number of rules, at most ALERT_MAX_RULES
+ */
+void alert_engine_init(struct Alert_Engine* engine, const struct Alert_Rule* rules, int num_rules);
+
+/**
+ * @brief Records the sample's readings and evaluates every rule
+ *
+ * @param engine the engine
+ * @param sample the sample just read
+ * @param events the out parameter for the rules that changed state, MUST HOLD ALERT_MAX_RULES
+ * @return the number of rules that changed state
+ */
+int alert_engine_update(struct Alert_Engine* engine, const struct Sensor_Data* sample,
+                        struct Alert_Event* events);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * The wrappers are only called by objects linked with
+ * -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free, so only the heap
+ * use of our own code is counted. Shared libraries like Paho and cJSON call the
+ * C library directly
+ */
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+void __real_free(void* pointer);
+
+void* __wrap_malloc(size_t size);
+void* __wrap_calloc(size_t count, size_t size);
+void* __wrap_realloc(void* pointer, size_t size);
+void __wrap_free(void* pointer);
+
+/**
+ * @brief Gets the number of allocations made so far, from any thread
+ *
+ * Every malloc(), calloc() and realloc() is counted, frees aren't since they
+ * can't fragment the heap on their own
+ *
+ * @return the number of allocations
+ */
+uint64_t alloc_count_total(void);
+
+/**
+ * @brief Gets the number of frees made so far, from any thread
+ *
+ * @return the number of frees
+ */
+uint64_t alloc_count_frees(void);
+
+#endif
@@ -0,0 +1,74 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "errors.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define ARENA_ALIGNMENT 16
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief A bump allocator over a single block allocated at startup
+ *
+ * Allocations are never freed one at a time, the whole arena is reset once the
+ * message built in it has been sent. The high water mark is the most the arena
+ * has ever held and every allocation that didn't fit is counted as exhausted.
+ * Overflowed is set when an allocation fails and cleared by the next reset, so
+ * a message that came out incomplete isn't sent
+ */
+struct Arena {
+    uint8_t* base;
+    size_t size;
+    size_t used;
+    size_t high_water;
+    uint32_t exhausted;
+    bool overflowed;
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Allocates the arena's block, the only time the arena touches the heap
+ *
+ * @param arena the arena to be initialized
+ * @param size the size of the block in bytes
+ * @return SIZE_ERR if the block couldn't be allocated, NOERR otherwise
+ */
+int8_t arena_init(struct Arena* arena, size_t size);
+
+/**
+ * @brief Takes the next ARENA_ALIGNMENT aligned piece of the arena
+ *
+ * @param arena the arena
+ * @param size the size of the allocation in bytes
+ * @return the allocation or NULL if the arena is exhausted
+ */
+void* arena_alloc(struct Arena* arena, size_t size);
+
+/**
+ * @brief Releases every allocation at once and clears overflowed
+ *
+ * @param arena the arena
+ */
+void arena_reset(struct Arena* arena);
+
+/**
+ * @brief Frees the arena's block
+ *
+ * @param arena the arena
+ */
+void arena_free(struct Arena* arena);
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef BACKLOG_H
+#define BACKLOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "record_join.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+//An hour of records at the default five second sampling period
+#define BACKLOG_SIZE 720
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief A fixed-size ring of the records waiting to be published
+ *
+ * Records are published oldest first. The first sent records have been handed to
+ * the client and stay until the broker confirms them, so they can be sent again
+ * after a lost connection. Once the ring is full the oldest record is evicted to
+ * make room for the newest and counted as dropped
+ */
+struct Backlog {
+    uint32_t head;
+    uint32_t count;
+    uint32_t sent;
+    uint32_t dropped;
+    struct Joined_Record records[BACKLOG_SIZE];
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Initializes an empty backlog
+ *
+ * @param backlog the backlog to be initialized
+ */
+void backlog_init(struct Backlog* backlog);
+
+/**
+ * @brief Adds the record to the end of the backlog
+ *
+ * @param backlog the backlog
+ * @param record the record to be added
+ * @return whether the oldest record had to be evicted to make room
+ */
+bool backlog_push(struct Backlog* backlog, const struct Joined_Record* record);
+
+/**
+ * @brief Gets the oldest record without removing it
+ *
+ * @param backlog the backlog
+ * @return the oldest record or NULL if the backlog is empty
+ */
+const struct Joined_Record* backlog_peek(const struct Backlog* backlog);
+
+/**
+ * @brief Removes the oldest record once it has been published
+ *
+ * @param backlog the backlog
+ */
+void backlog_pop(struct Backlog* backlog);
+
+/**
+ * @brief Gets the oldest record that hasn't been sent yet
+ *
+ * @param backlog the backlog
+ * @return the record or NULL if every record has been sent
+ */
+const struct Joined_Record* backlog_next(const struct Backlog* backlog);
+
+/**
+ * @brief Marks the record returned by backlog_next() as sent
+ *
+ * @param backlog the backlog
+ */
+void backlog_sent(struct Backlog* backlog);
+
+/**
+ * @brief Marks every sent record as unsent so they are sent again
+ *
+ * @param backlog the backlog
+ */
+void backlog_resend(struct Backlog* backlog);
+
+#endif
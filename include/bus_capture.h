@@ -0,0 +1,164 @@
+#ifndef BUS_CAPTURE_H
+#define BUS_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "clock_source.h"
+#include "errors.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define BUS_CAPTURE_MAGIC 0x43324942U
+#define BUS_CAPTURE_VERSION 1
+#define BUS_CAPTURE_RECORDS 65536
+#define BUS_CAPTURE_MAX_BYTES 48
+#define BUS_CAPTURE_ADDRESSES 128
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+enum Bus_Direction {
+    BUS_WRITE,
+    BUS_READ,
+};
+
+/**
+ * @brief A single I2C transaction, one cache line each
+ *
+ * The bytes are what was written or read, at most BUS_CAPTURE_MAX_BYTES of them, and
+ * none for a failed read. The sequence is written last and is one past the record's
+ * position in the capture, so a record being written is never replayed
+ */
+struct Bus_Capture_Record {
+    uint64_t monotonic_us;
+    _Atomic uint32_t sequence;
+    uint8_t address;
+    uint8_t direction;
+    int8_t result;
+    uint8_t count;
+    uint8_t data[BUS_CAPTURE_MAX_BYTES];
+};
+
+/**
+ * @brief The start of the capture file, followed by its ring of records
+ *
+ * Claimed counts every record ever written, the newest capacity of them are kept
+ */
+struct Bus_Capture_Header {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t record_size;
+    uint32_t capacity;
+    uint32_t reserved;
+    _Atomic uint64_t claimed;
+};
+
+/**
+ * @brief A capture file mapped for writing, or for replaying each device's
+ *          transactions in the order they were captured
+ */
+struct Bus_Capture {
+    struct Bus_Capture_Header* header;
+    struct Bus_Capture_Record* records;
+    size_t size;
+    uint64_t first;
+    uint64_t end;
+    uint64_t cursors[BUS_CAPTURE_ADDRESSES];
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Creates the capture file, or empties it, and maps it for writing
+ *
+ * @param capture the capture to be created
+ * @param path the path of the capture file
+ * @param capacity the number of records kept before the oldest are overwritten
+ * @return SIZE_ERR if the capacity is 0, INIT_ERR if the file couldn't be created
+ *          or mapped, NOERR otherwise
+ */
+int8_t bus_capture_create(struct Bus_Capture* capture, const char* path, uint32_t capacity);
+
+/**
+ * @brief Maps a capture file for replaying, starting from its oldest record
+ *
+ * @param capture the capture to be opened
+ * @param path the path of the capture file
+ * @return INIT_ERR if the file couldn't be opened or mapped, SIZE_ERR if it isn't
+ *          a capture of this version, NOERR otherwise
+ */
+int8_t bus_capture_open(struct Bus_Capture* capture, const char* path);
+
+/**
+ * @brief Unmaps the capture, the file is kept
+ *
+ * @param capture the capture to be closed
+ */
+void bus_capture_close(struct Bus_Capture* capture);
+
+/**
+ * @brief Appends a transaction to the capture, overwriting the oldest once it is full
+ *
+ * Safe to call from every worker at once, each record's slot is claimed atomically
+ *
+ * @param capture the capture being written
+ * @param address the device's hex address on the I2C bus
+ * @param direction whether the bytes were written or read
+ * @param data the bytes written or read
+ * @param count the number of bytes in the transaction
+ * @param result the transaction's error
+ */
+void bus_capture_add(struct Bus_Capture* capture, uint8_t address, enum Bus_Direction direction,
+                     const uint8_t* data, uint16_t count, int8_t result);
+
+/**
+ * @brief Gets the device's next captured transaction
+ *
+ * A transaction in the other direction is consumed and NULL returned, so a replay
+ * that diverged from the capture fails that transfer and then falls back in step
+ *
+ * @param capture the capture being replayed
+ * @param address the device's hex address on the I2C bus
+ * @param direction the direction of the transfer being replayed
+ * @return the record or NULL if the device has none left or the direction differs
+ */
+const struct Bus_Capture_Record* bus_capture_next(struct Bus_Capture* capture, uint8_t address,
+                                                  enum Bus_Direction direction);
+
+/**
+ * @brief Whether the device's replay has used up its captured transactions
+ *
+ * @param capture the capture being replayed
+ * @param address the device's hex address on the I2C bus
+ * @return whether the device has no transactions left
+ */
+bool bus_capture_done(struct Bus_Capture* capture, uint8_t address);
+
+/**
+ * @brief Starts every device's replay over from the oldest record
+ *
+ * @param capture the capture being replayed
+ */
+void bus_capture_rewind(struct Bus_Capture* capture);
+
+/**
+ * @brief Gets the number of records the capture holds
+ *
+ * @param capture the capture
+ * @return the number of records
+ */
+uint64_t bus_capture_count(const struct Bus_Capture* capture);
+
+#endif
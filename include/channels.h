@@ -0,0 +1,85 @@
+#ifndef CHANNELS_H
+#define CHANNELS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+//Signedness of a channel's 16 bit word
+#define CHANNEL_UNSIGNED false
+#define CHANNEL_SIGNED true
+
+//Marks a channel whose device has no invalid reading, no 16 bit word can match it
+#define CHANNEL_NO_INVALID INT32_MIN
+
+//Folds the conversion from Celsius to Fahrenheit into a channel's scale and offset
+#define FAHRENHEIT_SCALE(scale) ((scale) * 1.8F)
+#define FAHRENHEIT_OFFSET(offset) ((offset) * 1.8F + 32.0F)
+
+/**
+ * Each driver lists its channels once as an X-macro table, in the order they are
+ * read into the sample's data, with every entry being
+ *   X(id, key, label, word, signedness, scale, offset, invalid, unit)
+ * where
+ *   id is appended to the driver's prefix for the channel's index, e.g. SEN55_PM2_5
+ *   key is the channel's name in topics, configuration, and the local readers
+ *   label is the channel's key in the combined JSON message, NULL leaves it out
+ *   word is the index of the channel's 16 bit word in the read without CRCs
+ *   signedness is CHANNEL_SIGNED or CHANNEL_UNSIGNED
+ *   scale and offset convert the raw word, value = raw * scale + offset
+ *   invalid is the raw word the device sends for an unavailable reading
+ *   unit is the unit of the converted value
+ */
+
+//Expands a table entry into its Channel_Descriptor initializer
+#define CHANNEL_DESCRIPTOR(id, key, label, word, signedness, scale, offset, invalid, unit) \
+    {key, label, unit, word, signedness, scale, offset, invalid},
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief Describes how one of a device's channels is decoded, named and serialized
+ */
+struct Channel_Descriptor {
+    const char* key;
+    const char* label;
+    const char* unit;
+    uint8_t word;
+    bool is_signed;
+    float scale;
+    float offset;
+    int32_t invalid;
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Converts a channel's big-endian word into its value
+ *
+ * Inlined with a table entry's constants the signedness and invalid checks
+ * compile down to a select, so the decode loops don't branch per channel
+ *
+ * @param bytes the channel's two bytes
+ * @param is_signed whether the word is a two's complement int16
+ * @param scale the factor the raw word is multiplied by
+ * @param offset added after scaling
+ * @param invalid the raw word marking an unavailable reading
+ * @return the value or NAN if the reading is unavailable
+ */
+static inline float channel_decode(const uint8_t* bytes, bool is_signed, float scale,
+                                   float offset, int32_t invalid) {
+    uint16_t word = (uint16_t)(bytes[0] << 8 | bytes[1]);
+    int32_t raw = is_signed ? (int32_t)(int16_t)word : (int32_t)word;
+
+    return raw == invalid ? NAN : (float)raw * scale + offset;
+}
+
+#endif
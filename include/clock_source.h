@@ -0,0 +1,111 @@
+#ifndef CLOCK_SOURCE_H
+#define CLOCK_SOURCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+//The virtual monotonic clock starts a second in so no sample is stamped at zero
+#define CLOCK_SOURCE_VIRTUAL_START_NS 1000000000ULL
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief A periodic timer on the clock source, counting its expirations the way a
+ *          timerfd does
+ *
+ * The expirations are absolute, each one a period after the last, so waking up
+ * late doesn't shift the ones after it
+ */
+struct Clock_Timer {
+    uint64_t next_ns;
+    uint64_t period_ns;
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Switches the process to a virtual clock that only moves when it is slept on
+ *          or advanced, so a simulation runs as fast as its code does
+ *
+ * The monotonic clock starts at CLOCK_SOURCE_VIRTUAL_START_NS and the realtime clock
+ * at the given time. Should be set before any thread reads the clock
+ *
+ * @param realtime_ns the realtime clock's starting time in nanoseconds since the epoch
+ */
+void clock_source_use_virtual(uint64_t realtime_ns);
+
+/**
+ * @brief Switches the process back to the system's clocks
+ */
+void clock_source_use_real(void);
+
+/**
+ * @brief Whether the process is running on the virtual clock
+ *
+ * @return whether the clock is virtual
+ */
+bool clock_source_is_virtual(void);
+
+/**
+ * @brief Gets the current time, in place of clock_gettime()
+ *
+ * @param clock CLOCK_MONOTONIC or CLOCK_REALTIME
+ * @param now the out parameter for the current time
+ */
+void clock_source_now(clockid_t clock, struct timespec* now);
+
+/**
+ * @brief Gets the current monotonic time in microseconds
+ *
+ * @return the current monotonic time in microseconds
+ */
+uint64_t clock_source_now_us(void);
+
+/**
+ * @brief Sleeps for the given time, in place of usleep()
+ *
+ * The virtual clock is advanced instead of sleeping
+ *
+ * @param delay_us the time to sleep in microseconds
+ */
+void clock_source_sleep_us(uint64_t delay_us);
+
+/**
+ * @brief Moves the virtual clock forward to the given monotonic time, does nothing
+ *          if the clock is already past it or isn't virtual
+ *
+ * @param monotonic_ns the monotonic time in nanoseconds
+ */
+void clock_source_advance_to(uint64_t monotonic_ns);
+
+/**
+ * @brief Starts the timer with its first expiration a period from now
+ *
+ * @param timer the timer to be started
+ * @param period_us the timer's period in microseconds
+ */
+void clock_timer_start(struct Clock_Timer* timer, uint64_t period_us);
+
+/**
+ * @brief Waits for the timer's next expiration, sleeping on the system clock or
+ *          jumping the virtual clock straight to it
+ *
+ * @param timer the timer
+ * @return the number of expirations since the last wait, more than 1 when the
+ *          caller has overrun its period
+ */
+uint64_t clock_timer_wait(struct Clock_Timer* timer);
+
+#endif
@@ -0,0 +1,164 @@
+#ifndef COLUMNAR_H
+#define COLUMNAR_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+#include <math.h>
+#include "sensor_data.h"
+#include "functions.h"
+#include "device_io.h"
+#include "errors.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define COLUMNAR_MAGIC "AQC1"
+#define COLUMNAR_ROW_GROUP 720
+#define COLUMNAR_MAX_GROUPS 256
+#define COLUMNAR_NAME_SIZE 16
+#define COLUMNAR_PATH_SIZE 256
+
+enum Column_Encoding {
+    ENCODING_DELTA_OF_DELTA = 1,    //zigzag varints of the change between deltas
+    ENCODING_XOR = 2,               //varints of each float's bits XORed with the last
+};
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief The statistics of a row group, kept in the file's footer
+ *
+ * Readers compare them against their predicate to skip row groups without
+ * decoding them. NAN readings are counted but left out of the min and max
+ */
+struct Row_Group_Info {
+    uint64_t offset;
+    uint32_t num_rows;
+    uint64_t timestamp_min;
+    uint64_t timestamp_max;
+    float min[MAX_DATAPOINTS];
+    float max[MAX_DATAPOINTS];
+    uint32_t nan_count[MAX_DATAPOINTS];
+};
+
+struct Column_Footer {
+    uint8_t device_addr;
+    uint8_t num_channels;
+    char channels[MAX_DATAPOINTS][COLUMNAR_NAME_SIZE];
+    uint32_t num_groups;
+    struct Row_Group_Info groups[COLUMNAR_MAX_GROUPS];
+};
+
+/**
+ * @brief Writes a device's readings to columnar files, one file per rotation period
+ *
+ * A file is laid out as
+ *   "AQC1" | row group... | footer | uint32 footer size | "AQC1"
+ * where each row group is its uint32 row count followed by the timestamp column
+ * and then every channel's column. A column is its uint8 encoding, its uint32
+ * size in bytes, and its encoded values. Everything is little-endian. Writers
+ * encode into one shared static buffer, so they must all be used from one thread
+ */
+struct Column_Writer {
+    FILE* file;
+    char directory[COLUMNAR_PATH_SIZE];
+    uint32_t rotate_s;
+    uint64_t opened_ms;
+    uint32_t num_rows;
+    uint64_t timestamps[COLUMNAR_ROW_GROUP];
+    float values[MAX_DATAPOINTS][COLUMNAR_ROW_GROUP];
+    struct Column_Footer footer;
+};
+
+struct Column_Reader {
+    FILE* file;
+    struct Column_Footer footer;
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Initializes the writer for a device, no file is opened until the first row
+ *
+ * @param writer the writer to be initialized
+ * @param directory the directory the files are written to
+ * @param rotate_s how many seconds of readings go into each file
+ * @param device_addr the device's hex address on the I2C bus
+ * @param num_channels the number of channels the device reads
+ * @return SIZE_ERR if the directory's path is too long, NOERR otherwise
+ */
+int8_t columnar_writer_init(struct Column_Writer* writer, const char* directory,
+                            uint32_t rotate_s, uint8_t device_addr, int num_channels);
+
+/**
+ * @brief Adds the sample as a row, writing a row group once COLUMNAR_ROW_GROUP rows
+ *          are buffered and rotating the file once its period is over
+ *
+ * @param writer the device's writer
+ * @param sample the sample just read
+ * @return WRITE_ERR if the file couldn't be written, NOERR otherwise
+ */
+int8_t columnar_writer_add(struct Column_Writer* writer, const struct Sensor_Data* sample);
+
+/**
+ * @brief Writes the buffered rows and the footer and closes the file
+ *
+ * @param writer the device's writer
+ * @return WRITE_ERR if the file couldn't be written, NOERR otherwise
+ */
+int8_t columnar_writer_close(struct Column_Writer* writer);
+
+/**
+ * @brief Opens a file and reads its footer
+ *
+ * @param path the file's path
+ * @param reader the out parameter for the reader
+ * @return INIT_ERR if the file couldn't be opened, READ_ERR if it isn't a complete
+ *          columnar file, NOERR otherwise
+ */
+int8_t columnar_reader_open(const char* path, struct Column_Reader* reader);
+
+/**
+ * @brief Checks the row group's statistics against a predicate
+ *
+ * @param group the row group's statistics
+ * @param channel the index of the channel the predicate is on, -1 for only the time range
+ * @param min the lowest value of interest
+ * @param max the highest value of interest
+ * @param from_ms the start of the time range in wall-clock milliseconds
+ * @param to_ms the end of the time range in wall-clock milliseconds
+ * @return false if no row in the group can match, so the group can be skipped
+ */
+bool columnar_group_matches(const struct Row_Group_Info* group, int channel, float min,
+                            float max, uint64_t from_ms, uint64_t to_ms);
+
+/**
+ * @brief Reads and decodes a row group
+ *
+ * @param reader the reader
+ * @param group the index of the row group
+ * @param timestamps the out parameter for the timestamps, MUST HOLD COLUMNAR_ROW_GROUP
+ * @param values the out parameter for every channel's values
+ * @return READ_ERR if the row group couldn't be read or decoded, NOERR otherwise
+ */
+int8_t columnar_reader_group(struct Column_Reader* reader, uint32_t group, uint64_t* timestamps,
+                            float values[MAX_DATAPOINTS][COLUMNAR_ROW_GROUP]);
+
+/**
+ * @brief Closes the file
+ *
+ * @param reader the reader
+ */
+void columnar_reader_close(struct Column_Reader* reader);
+
+#endif
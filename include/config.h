@@ -0,0 +1,179 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include "address.h"
+#include "device_io.h"
+#include "errors.h"
+#include "topics.h"
+#include "shm_table.h"
+#include "query_server.h"
+#include "derived.h"
+#include "alerts.h"
+#include "filters.h"
+#include "bus_capture.h"
+#include "fault_inject.h"
+#include "realtime.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define CONFIG_PATH "publisher.conf"
+#define CONFIG_MAX_DEVICES 8
+#define CONFIG_STRING_SIZE 128
+
+//Defaults used for anything the configuration file leaves out
+#define CLIENTID "sensor_pub"
+#define TOPIC "sensors/data"
+#define GATEWAY "gateway"
+#define CHANNEL_TOPIC "sensors/{gateway}/{device}/{channel}"
+#define RETAIN_CHANNELS false
+#define SHM_NAME SHM_TABLE_NAME
+#define HISTORY_LENGTH 2880
+#define QUERY_SOCKET "publisher.sock"
+#define EXPORT_DIR ""
+#define EXPORT_ROTATE_S 86400
+#define DERIVED_METRICS_ENABLED true
+#define ALERT_TOPIC "sensors/alerts"
+#define ALERT_QOS 1
+#define QOS 1
+#define WAIT_TIME 5
+#define JOIN_LATENESS_MS 1000
+#define METRICS_TOPIC "sensors/metrics"
+#define METRICS_INTERVAL 12
+#define TIMING_METADATA true
+#define CALIBRATE_DELAYS false
+#define CAPTURE_FILE ""
+#define CAPTURE_RECORDS BUS_CAPTURE_RECORDS
+#define REPLAY_FILE ""
+#define FAULT_SEED 1
+#define ADAPTER_NUM 1
+//Real-time mode, the CPUs can be NO_CPU_PIN to leave the threads unpinned
+#define REALTIME_MODE false
+#define ACQUISITION_CPU 1
+#define PROCESSING_CPU 0
+#define PUBLISH_CPU 0
+#define ACQUISITION_PRIORITY 80
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+struct Device_Config {
+    uint8_t address;
+    uint32_t adapter_num;
+    uint32_t period;
+};
+
+/**
+ * @brief Everything that can be changed at runtime by editing the configuration
+ *          file and sending the publisher SIGHUP
+ */
+struct Config {
+    char address[CONFIG_STRING_SIZE];
+    char client_id[CONFIG_STRING_SIZE];
+    char topic[CONFIG_STRING_SIZE];
+    char metrics_topic[CONFIG_STRING_SIZE];
+    char gateway[CONFIG_STRING_SIZE];
+    char channel_topic[CONFIG_STRING_SIZE];
+    bool retain_channels;
+    char shm_name[CONFIG_STRING_SIZE];
+    uint32_t history_length;
+    char query_socket[QUERY_PATH_SIZE];
+    char export_dir[CONFIG_STRING_SIZE];
+    uint32_t export_rotate_s;
+    bool derived_metrics;
+    uint32_t outdoor_co2;
+    int qos;
+    uint32_t wait_time;
+    uint32_t join_lateness_ms;
+    uint32_t metrics_interval;
+    bool timing_metadata;
+    bool calibrate_delays;
+    char capture_file[CONFIG_STRING_SIZE];
+    uint32_t capture_records;
+    char replay_file[CONFIG_STRING_SIZE];
+    uint32_t fault_seed;
+    struct Realtime_Config realtime;
+    int num_faults;
+    struct Fault_Rule faults[FAULT_MAX_RULES];
+    char alert_topic[CONFIG_STRING_SIZE];
+    int alert_qos;
+    int num_alerts;
+    struct Alert_Rule alerts[ALERT_MAX_RULES];
+    int num_filters;
+    struct Filter_Config filters[FILTER_MAX];
+    int num_devices;
+    struct Device_Config devices[CONFIG_MAX_DEVICES];
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Fills the configuration with the compiled-in defaults
+ *
+ * The gateway defaults to the host's name, or GATEWAY if it can't be read
+ *
+ * @param config the configuration to be filled
+ */
+void config_defaults(struct Config* config);
+
+/**
+ * @brief Reads the configuration file on top of the compiled-in defaults
+ *
+ * Each line is a "key = value" pair and anything after a '#' is ignored. Every
+ * "device = <SEN55|SCD40|address> [adapter] [period]" line adds a device, and if
+ * there are none the SCD40 and SEN55 on ADAPTER_NUM are used. Every
+ * "alert = <name>: <expression>" line adds a rule, see alert_compile(), and every
+ * "filter = <DEVICE.channel> <type> <parameter>" line a filter, see filter_parse(), and
+ * every "fault = <target> <kind> <trigger> [amount]" line a fault, see fault_parse(). An empty
+ * channel_topic turns off the per-channel topics and an empty shm_name turns off
+ * the shared-memory table, as does an empty query_socket for the query API and
+ * an empty export_dir for the columnar export. The I2C capture and replay files,
+ * the faults and the real-time settings are only read at startup. A missing file leaves the defaults in place
+ *
+ * @param path the path of the configuration file
+ * @param config the out parameter configuration, only written to if the file is valid
+ * @param error_line the out parameter for the line number of an invalid line
+ * @return CONFIG_ERR if a line is invalid, NOERR otherwise
+ */
+int8_t config_load(const char* path, struct Config* config, int* error_line);
+
+/**
+ * @brief Whether the client has to reconnect to apply the new configuration
+ *
+ * @param old_config the configuration currently applied
+ * @param new_config the configuration being applied
+ * @return whether the broker address or client id changed
+ */
+bool config_broker_changed(const struct Config* old_config, const struct Config* new_config);
+
+/**
+ * @brief Whether a device was added or removed, regardless of the devices' order,
+ *          adapters or periods
+ *
+ * @param old_config the configuration currently applied
+ * @param new_config the configuration being applied
+ * @return whether the two configurations have different device addresses
+ */
+bool config_devices_changed(const struct Config* old_config, const struct Config* new_config);
+
+/**
+ * @brief Finds the device's configuration
+ *
+ * @param config the configuration
+ * @param address the device's hex address on the I2C bus
+ * @return the device's configuration or NULL if the device isn't configured
+ */
+const struct Device_Config* config_find_device(const struct Config* config, uint8_t address);
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef DELIVERY_H
+#define DELIVERY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "record_join.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define DELIVERY_MAX_RECORDS 16
+//The combined topic, every channel of every device, and every derived metric
+#define DELIVERY_MAX_TOKENS (1 + JOIN_MAX_DEVICES * MAX_DATAPOINTS + DERIVED_METRICS)
+//Room for every tracked token plus the alerts and metrics confirmed meanwhile
+#define DELIVERY_RING_SIZE 2048
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief A record handed to the client and the delivery tokens it still waits on
+ */
+struct Delivery_Record {
+    uint64_t sent_ms;
+    int num_tokens;
+    int tokens[DELIVERY_MAX_TOKENS];
+};
+
+/**
+ * @brief The records published but not yet confirmed by the broker, oldest first
+ *
+ * The client's delivery callback only pushes each confirmed token onto a
+ * single-producer ring, so it never waits on the main thread. The main thread
+ * drains the ring and matches the tokens to its records, which complete in the
+ * order they were sent so the backlog can be popped in order
+ */
+struct Delivery_Tracker {
+    _Atomic uint32_t confirmed_head;
+    _Atomic uint32_t confirmed_tail;
+    int confirmed[DELIVERY_RING_SIZE];
+
+    uint32_t head;
+    uint32_t count;
+    struct Delivery_Record records[DELIVERY_MAX_RECORDS];
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Initializes the tracker with nothing in flight
+ *
+ * @param tracker the tracker to be initialized
+ */
+void delivery_init(struct Delivery_Tracker* tracker);
+
+/**
+ * @brief Records that the broker confirmed the token, safe to call from the client's thread
+ *
+ * A confirmation that doesn't fit in the ring is dropped, its record then
+ * expires like one the broker never confirmed
+ *
+ * @param tracker the tracker
+ * @param token the confirmed delivery token
+ */
+void delivery_confirm(struct Delivery_Tracker* tracker, int token);
+
+/**
+ * @brief Starts waiting on the tokens of a record just handed to the client
+ *
+ * A record without tokens, such as one published at QoS 0, completes on the next
+ * collection once every record sent before it has
+ *
+ * @param tracker the tracker
+ * @param tokens the record's delivery tokens
+ * @param num_tokens the number of tokens, at most DELIVERY_MAX_TOKENS
+ * @param now_ms the current monotonic time in milliseconds
+ */
+void delivery_track(struct Delivery_Tracker* tracker, const int* tokens, int num_tokens, uint64_t now_ms);
+
+/**
+ * @brief Matches the confirmed tokens to the records in flight and removes the
+ *          oldest records that are fully confirmed
+ *
+ * @param tracker the tracker
+ * @return the number of records completed, in the order they were sent
+ */
+uint32_t delivery_collect(struct Delivery_Tracker* tracker);
+
+/**
+ * @brief Gets how long until the oldest record in flight has waited too long
+ *
+ * @param tracker the tracker
+ * @param now_ms the current monotonic time in milliseconds
+ * @param timeout_ms how long a record may wait on the broker
+ * @return the timeout in milliseconds or -1 if nothing is in flight, usable by epoll_wait()
+ */
+int delivery_timeout(const struct Delivery_Tracker* tracker, uint64_t now_ms, uint64_t timeout_ms);
+
+/**
+ * @brief Whether no more records can be tracked until some complete
+ *
+ * @param tracker the tracker
+ * @return whether DELIVERY_MAX_RECORDS are in flight
+ */
+bool delivery_full(const struct Delivery_Tracker* tracker);
+
+/**
+ * @brief Stops tracking the oldest record, when it was evicted before being confirmed
+ *
+ * @param tracker the tracker
+ */
+void delivery_forget_oldest(struct Delivery_Tracker* tracker);
+
+/**
+ * @brief Forgets every record in flight and every confirmation not yet collected
+ *
+ * Called when the connection is lost, since a new connection starts a clean
+ * session and the records are sent again
+ *
+ * @param tracker the tracker
+ */
+void delivery_reset(struct Delivery_Tracker* tracker);
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef DERIVED_H
+#define DERIVED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+//The 24 hour PM averages are kept in 5 minute buckets
+#define DERIVED_WINDOW_MS (24ULL * 60 * 60 * 1000)
+#define DERIVED_BUCKETS 288
+//EPA only reports a 24 hour average with at least 18 hours of data
+#define DERIVED_MIN_COVERAGE 0.75
+
+//The CO2 trend is taken over the last 15 minutes
+#define DERIVED_TREND_MS (15ULL * 60 * 1000)
+#define DERIVED_TREND_POINTS 256
+#define OUTDOOR_CO2 420
+
+enum Derived_Metric {
+    DERIVED_AQI,
+    DERIVED_PM2_5_24H,
+    DERIVED_PM10_24H,
+    DERIVED_DEW_POINT,
+    DERIVED_ABSOLUTE_HUMIDITY,
+    DERIVED_CO2_RATE,
+    DERIVED_AIR_CHANGES,
+    DERIVED_METRICS,
+};
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief The derived metrics of a record, NAN where the inputs aren't available
+ */
+struct Derived_Values {
+    float values[DERIVED_METRICS];
+};
+
+/**
+ * @brief The fresh readings of a record the metrics are derived from, NAN if missing
+ */
+struct Derived_Inputs {
+    float pm2_5;
+    float pm10;
+    float temperature;
+    float humidity;
+    float co2;
+};
+
+/**
+ * @brief A mean over a sliding time window, kept as per-bucket sums so each
+ *          reading is added in constant time
+ */
+struct Rolling_Mean {
+    uint64_t bucket_ms;
+    bool started;
+    uint64_t head;
+    uint32_t filled;
+    double sums[DERIVED_BUCKETS];
+    uint32_t counts[DERIVED_BUCKETS];
+    double total;
+    uint32_t total_count;
+};
+
+struct Trend_Point {
+    uint64_t time_ms;
+    float value;
+};
+
+/**
+ * @brief The readings within a trailing time window, oldest first
+ */
+struct Trend {
+    uint64_t window_ms;
+    uint32_t head;
+    uint32_t count;
+    struct Trend_Point points[DERIVED_TREND_POINTS];
+};
+
+struct Derived {
+    float outdoor_co2;
+    struct Rolling_Mean pm2_5;
+    struct Rolling_Mean pm10;
+    struct Trend co2;
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Initializes the windows with nothing in them
+ *
+ * @param derived the derived-metric state
+ * @param outdoor_co2 the outdoor CO2 concentration the air change rate decays toward
+ */
+void derived_init(struct Derived* derived, float outdoor_co2);
+
+/**
+ * @brief Adds a record's fresh readings to the windows and derives its metrics
+ *
+ * Records must be added in order, once each
+ *
+ * @param derived the derived-metric state
+ * @param time_ms the record's monotonic time in milliseconds
+ * @param inputs the record's fresh readings
+ * @param values the out parameter for the derived metrics
+ */
+void derived_update(struct Derived* derived, uint64_t time_ms, const struct Derived_Inputs* inputs,
+                    struct Derived_Values* values);
+
+/**
+ * @brief Gets the metric's name as used in the channel topics
+ *
+ * @param metric the metric
+ * @return the metric's name
+ */
+const char* derived_name(enum Derived_Metric metric);
+
+/**
+ * @brief Gets the metric's name as used in the JSON record
+ *
+ * @param metric the metric
+ * @return the metric's name
+ */
+const char* derived_label(enum Derived_Metric metric);
+
+/**
+ * @brief Converts a 24 hour PM2.5 average to the US EPA AQI, using the 2024 breakpoints
+ *
+ * @param concentration the average in ug/m3
+ * @return the AQI or NAN if the concentration is NAN or negative
+ */
+float aqi_pm2_5(float concentration);
+
+/**
+ * @brief Converts a 24 hour PM10 average to the US EPA AQI
+ *
+ * @param concentration the average in ug/m3
+ * @return the AQI or NAN if the concentration is NAN or negative
+ */
+float aqi_pm10(float concentration);
+
+/**
+ * @brief Gets the dew point with the Magnus formula
+ *
+ * @param temperature the temperature in degrees Celsius
+ * @param humidity the relative humidity in percent
+ * @return the dew point in degrees Celsius or NAN if the humidity isn't positive
+ */
+float dew_point(float temperature, float humidity);
+
+/**
+ * @brief Gets the mass of water vapour per volume of air
+ *
+ * @param temperature the temperature in degrees Celsius
+ * @param humidity the relative humidity in percent
+ * @return the absolute humidity in g/m3
+ */
+float absolute_humidity(float temperature, float humidity);
+
+#endif
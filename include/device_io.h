@@ -48,4 +48,12 @@ int8_t device_write(uint8_t* data, uint16_t count, uint8_t device_addr, int* fd)
  */
 int8_t device_read(uint8_t* data, uint16_t count, uint8_t device_addr, int* fd);
 
+/**
+ * @brief Gets the human readable name of the device
+ * 
+ * @param device_addr the device's hex address on the I2C bus
+ * @return the device's name or "Unknown" if the address isn't supported
+ */
+const char* device_name(uint8_t device_addr);
+
 #endif
\ No newline at end of file
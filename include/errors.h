@@ -19,5 +19,13 @@
 #define PNTR_ERR -7
 /*Returned when an invalid device address is inputted*/
 #define ADDR_ERR -8
+/*Returned when the configuration file couldn't be read or has an invalid line*/
+#define CONFIG_ERR -9
+/*Returned when a shared-memory handle was looked up before the table's layout changed*/
+#define STALE_ERR -10
+/*Returned when the I2C device didn't acknowledge a write or read, usually because it was still busy*/
+#define NACK_ERR -11
+/*Returned when the I2C bus reads back all ones or all zeros, usually because a line is held*/
+#define BUS_ERR -12
 
 #endif
\ No newline at end of file
@@ -0,0 +1,165 @@
+#ifndef FAULT_INJECT_H
+#define FAULT_INJECT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include "device_io.h"
+#include "bus_capture.h"
+#include "clock_source.h"
+#include "errors.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define FAULT_MAX_RULES 16
+//A device address that matches every device on the bus
+#define FAULT_ANY_DEVICE 0
+//The bytes a short read keeps when the rule doesn't say, one word and its CRC
+#define FAULT_SHORT_KEPT 3
+//Matches are counted per 7-bit address, the broker's under FAULT_ANY_DEVICE
+#define FAULT_ADDRESSES 128
+
+enum Fault_Site {
+    FAULT_DEVICE,
+    FAULT_BROKER,
+};
+
+enum Fault_Kind {
+    FAULT_CRC,
+    FAULT_NACK,
+    FAULT_SHORT,
+    FAULT_ERROR,
+    FAULT_LATENCY,
+    FAULT_DISCONNECT,
+    FAULT_KINDS,
+};
+
+enum Fault_Trigger {
+    FAULT_PROBABILITY,
+    FAULT_EVERY,
+    FAULT_AT,
+};
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief A fault injected into one device's transfers, every device's, or the
+ *          broker's publishes
+ *
+ * The trigger fires at random with the probability, on every Nth transfer or
+ * publish the rule matches, or only on the Nth one. A rule for the whole bus counts
+ * each device's transfers separately. The amount is the latency in microseconds,
+ * or the bytes a short read keeps
+ */
+struct Fault_Rule {
+    enum Fault_Site site;
+    uint8_t device_addr;
+    enum Fault_Kind kind;
+    enum Fault_Trigger trigger;
+    double probability;
+    uint32_t count;
+    uint32_t amount;
+};
+
+/**
+ * @brief Every configured rule and how often each has matched and fired
+ *
+ * Shared by every worker and the main thread, so the counts are atomic. Matches
+ * are counted per device, since each device's transfers come from its own worker
+ * in a fixed order while the workers interleave at random. The random draws only
+ * depend on the seed, the rule, the device, and how many times the rule has
+ * matched it, so a run with the same seed injects the same faults
+ */
+struct Fault_Injector {
+    int num_rules;
+    uint64_t seed;
+    struct Fault_Rule rules[FAULT_MAX_RULES];
+    _Atomic uint64_t matched[FAULT_MAX_RULES][FAULT_ADDRESSES];
+    _Atomic uint64_t injected[FAULT_MAX_RULES];
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Parses a "<SEN55|SCD40|address|bus|broker> <kind> <probability|every N|at N> [amount]"
+ *          fault
+ *
+ * The kinds are crc and short for the devices' reads, nack for their writes and
+ * reads, error and latency for either site, and disconnect for the broker. A
+ * latency needs its amount, and the probability must be in (0, 1]
+ *
+ * @param value the fault's text
+ * @param rule the out parameter for the rule
+ * @return CONFIG_ERR if the fault is invalid, NOERR otherwise
+ */
+int8_t fault_parse(const char* value, struct Fault_Rule* rule);
+
+/**
+ * @brief Gets the name the fault kind is configured with
+ *
+ * @param kind the fault kind
+ * @return the kind's name
+ */
+const char* fault_kind_name(enum Fault_Kind kind);
+
+/**
+ * @brief Sets up the injector with the rules and clears its counts
+ *
+ * @param injector the injector to be set up
+ * @param rules the rules, applied in the order given
+ * @param num_rules the number of rules, at most FAULT_MAX_RULES are kept
+ * @param seed the seed of the random draws
+ */
+void fault_inject_init(struct Fault_Injector* injector, const struct Fault_Rule* rules,
+                        int num_rules, uint64_t seed);
+
+/**
+ * @brief Applies the device rules to a transfer that has just completed
+ *
+ * A CRC fault flips a bit of the bytes read and a short read leaves the bytes past
+ * its amount as the pulled-up 0xFF, both only apply to reads that succeeded. A
+ * NACK fails a write or read that succeeded with NACK_ERR. An error fails the
+ * transfer and a latency delays it
+ *
+ * @param injector the injector
+ * @param device_addr the device's hex address on the I2C bus
+ * @param direction whether the bytes were written or read
+ * @param data the bytes written or read
+ * @param count the number of bytes in the transfer
+ * @param result the transfer's result
+ * @return the transfer's result once the faults are applied
+ */
+int8_t fault_inject_bus(struct Fault_Injector* injector, uint8_t device_addr,
+                        enum Bus_Direction direction, uint8_t* data, uint16_t count, int8_t result);
+
+/**
+ * @brief Applies the broker rules to a publish that is about to be sent
+ *
+ * A latency delays the publish, and an error or disconnect fails it
+ *
+ * @param injector the injector
+ * @param disconnect the out parameter for whether the client should be disconnected
+ * @return WRITE_ERR if the publish should fail, NOERR otherwise
+ */
+int8_t fault_inject_broker(struct Fault_Injector* injector, bool* disconnect);
+
+/**
+ * @brief Gets how many faults the rule has injected
+ *
+ * @param injector the injector
+ * @param rule the rule's index
+ * @return the number of faults injected
+ */
+uint64_t fault_injected(struct Fault_Injector* injector, int rule);
+
+#endif
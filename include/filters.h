@@ -0,0 +1,114 @@
+#ifndef FILTERS_H
+#define FILTERS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "sensor_data.h"
+#include "errors.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define FILTER_MAX 32
+#define FILTER_MAX_WINDOW 9
+//A rate limiter gives in after this many readings in a row, taking it as a real step
+#define FILTER_MAX_HELD 3
+
+enum Filter_Type {
+    FILTER_MEDIAN,
+    FILTER_EWMA,
+    FILTER_RATE,
+};
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief A filter on one channel, the parameter being the median's window, the
+ *          EWMA's smoothing factor, or the largest change per second allowed
+ */
+struct Filter_Config {
+    uint8_t device_addr;
+    uint8_t channel;
+    enum Filter_Type type;
+    float parameter;
+};
+
+struct Filter {
+    struct Filter_Config config;
+    uint32_t rejected;
+
+    uint8_t head;
+    uint8_t count;
+    float window[FILTER_MAX_WINDOW];
+
+    bool has_value;
+    float value;
+    uint64_t time_ms;
+    uint8_t held;
+};
+
+/**
+ * @brief Every configured filter, applied in the order configured
+ */
+struct Filter_Chain {
+    int num_filters;
+    struct Filter filters[FILTER_MAX];
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Parses a "DEVICE.channel <median N|ewma alpha|rate max_per_s>" filter
+ *
+ * The median's window must be odd and at most FILTER_MAX_WINDOW, the EWMA's factor
+ * in (0, 1], and the rate positive
+ *
+ * @param value the filter's text
+ * @param config the out parameter for the filter
+ * @return CONFIG_ERR if the filter is invalid, NOERR otherwise
+ */
+int8_t filter_parse(const char* value, struct Filter_Config* config);
+
+/**
+ * @brief Starts the filters with empty state and no rejections
+ *
+ * @param chain the chain
+ * @param configs the filters
+ * @param num_filters the number of filters, at most FILTER_MAX
+ */
+void filter_chain_init(struct Filter_Chain* chain, const struct Filter_Config* configs,
+                        int num_filters);
+
+/**
+ * @brief Passes the sample's readings through their channels' filters in place
+ *
+ * - median replaces the reading with the median of the last N valid readings once
+ *   there are N, and counts a rejection whenever that differs from the reading
+ * - ewma replaces the reading with its exponentially weighted moving average and
+ *   counts the NAN readings it held the average over
+ * - rate holds the last accepted reading when the change from it is faster than
+ *   allowed and counts each reading it held
+ *
+ * @param chain the chain
+ * @param sample the sample just read
+ */
+void filter_chain_apply(struct Filter_Chain* chain, struct Sensor_Data* sample);
+
+/**
+ * @brief Gets the filter type's name as written in the configuration
+ *
+ * @param type the filter's type
+ * @return the name
+ */
+const char* filter_name(enum Filter_Type type);
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "sen55_functions.h"
 #include "scd40_functions.h"
+#include "device_io.h"
 
 /*******************************************************************************
 *                           Function Definitions                               *
@@ -38,6 +39,19 @@ int8_t stop_measurement(uint8_t device_addr, int* fd);
  */
 int8_t read_data_flag(bool* is_ready, uint8_t device_addr, int* fd);
 
+/**
+ * @brief Checks whether the device is already in Measurement-Mode
+ * 
+ * Allows a restarted process to adopt a device that is still measuring instead of
+ * restarting its measurements
+ * 
+ * @param is_measuring the out parameter whether the device is measuring
+ * @param device_addr the device's hex address on the I2C bus
+ * @param fd the opened file descriptor for the I2C device
+ * @return an error if the device couldn't be written or read from, else NOERROR is returned
+ */
+int8_t read_measurement_state(bool* is_measuring, uint8_t device_addr, int* fd);
+
 /**
  * @brief Reads the data the device has ready into the inputted buffer
  * 
@@ -51,6 +65,54 @@ int8_t read_data_flag(bool* is_ready, uint8_t device_addr, int* fd);
  */
 int8_t read_into_buffer(float* data, size_t buffer_size, uint8_t device_addr, int* fd);
 
+/**
+ * @brief Gets the addresses of every device with a driver, in the order their
+ *          fields appear in the combined message
+ * 
+ * @param num_devices the out parameter for the number of devices
+ * @return the devices' hex addresses on the I2C bus
+ */
+const uint8_t* known_devices(int* num_devices);
+
+/**
+ * @brief Gets the number of datapoints read_into_buffer() fills in for the device
+ * 
+ * @param device_addr the device's hex address on the I2C bus
+ * @return the number of datapoints, 0 for an unknown device
+ */
+int channel_count(uint8_t device_addr);
+
+/**
+ * @brief Gets the descriptor of one of the device's datapoints from its driver's
+ *          channel table, in the order read_into_buffer() fills them in
+ * 
+ * @param device_addr the device's hex address on the I2C bus
+ * @param channel the index of the datapoint
+ * @return the channel's descriptor or NULL if the device has no such datapoint
+ */
+const struct Channel_Descriptor* channel_descriptor(uint8_t device_addr, int channel);
+
+/**
+ * @brief Gets the name of one of the device's datapoints, in the order 
+ *          read_into_buffer() fills them in
+ * 
+ * @param device_addr the device's hex address on the I2C bus
+ * @param channel the index of the datapoint
+ * @return the channel's name or NULL if the device has no such datapoint
+ */
+const char* channel_name(uint8_t device_addr, int channel);
+
+/**
+ * @brief Parses a "DEVICE.channel" reference, such as "SEN55.pm2_5"
+ * 
+ * @param reference the reference, which doesn't have to be null terminated
+ * @param length the length of the reference
+ * @param device_addr the out parameter for the device's hex address on the I2C bus
+ * @param channel the out parameter for the index of the datapoint
+ * @return whether the reference names a datapoint of a known device
+ */
+bool channel_parse(const char* reference, size_t length, uint8_t* device_addr, int* channel);
+
 /**
  * @brief Reads the name of the device
  * 
@@ -88,7 +150,8 @@ int8_t read_firmware(uint8_t* firmware_version, uint8_t device_addr, int* fd);
 /**
  * @brief Software resets the device
  * 
- * Software resets the device which puts it in the same state as after a power reset
+ * Software resets the device which puts it in the same state as after a power reset,
+ * the device is left idle afterwards
  * 
  * @param device_addr the device's hex address on the I2C bus
  * @param fd the opened file descriptor for the I2C device
@@ -96,4 +159,25 @@ int8_t read_firmware(uint8_t* firmware_version, uint8_t device_addr, int* fd);
  */
 int8_t reset(uint8_t device_addr, int* fd);
 
+/**
+ * @brief Tunes the delays between reading commands to how fast the device really responds
+ * 
+ * Should be called while the device is measuring, the delays stay at the datasheet's
+ * execution times if it fails
+ * 
+ * @param device_addr the device's hex address on the I2C bus
+ * @param fd the opened file descriptor for the I2C device
+ * @return an error if the device couldn't be written to or read from, else NOERROR is returned
+ */
+int8_t calibrate_delays(uint8_t device_addr, int* fd);
+
+/**
+ * @brief Gets the device's link counts, the delays a read currently waits on, how
+ *          often the device was read too early, and its CRC errors by class
+ * 
+ * @param stats the out parameter for the counts
+ * @param device_addr the device's hex address on the I2C bus
+ */
+void read_bus_stats(struct Sensirion_Stats* stats, uint8_t device_addr);
+
 #endif
\ No newline at end of file
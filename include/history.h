@@ -0,0 +1,174 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sensor_data.h"
+#include "scan.h"
+#include "errors.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define HISTORY_MAX_SERIES 8
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief A device's readings kept as a ring of columns
+ *
+ * Every channel's values are stored in their own array next to a single timestamp
+ * column, so a query over one channel only walks the memory it needs. Timestamps
+ * are wall-clock milliseconds kept non-decreasing so ranges can be binary searched
+ */
+struct History_Series {
+    uint8_t device_addr;
+    int num_channels;
+    uint32_t capacity;
+    uint32_t head;
+    uint32_t count;
+    uint64_t* timestamps;
+    float* values[MAX_DATAPOINTS];
+};
+
+struct History {
+    uint32_t capacity;
+    int num_series;
+    struct History_Series series[HISTORY_MAX_SERIES];
+};
+
+struct History_Point {
+    uint64_t timestamp_ms;
+    float value;
+};
+
+/**
+ * @brief The summary of the readings within one downsampling step
+ */
+struct History_Bucket {
+    uint64_t start_ms;
+    uint32_t count;
+    float min;
+    float max;
+    float mean;
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Allocates a series of the given length for every device
+ *
+ * @param history the history to be initialized
+ * @param device_addrs the addresses of the devices
+ * @param num_devices the number of devices, at most HISTORY_MAX_SERIES
+ * @param capacity the number of readings kept per device
+ * @return SIZE_ERR for too many devices or no capacity, INIT_ERR if the allocation
+ *          failed, NOERR otherwise
+ */
+int8_t history_init(struct History* history, const uint8_t* device_addrs,
+                    int num_devices, uint32_t capacity);
+
+/**
+ * @brief Changes which devices have a series, keeping the readings of every device
+ *          that still has one
+ *
+ * The series of devices no longer given are freed and new devices get an empty
+ * series of the history's capacity. A device whose series couldn't be allocated is
+ * left without one
+ *
+ * @param history the initialized history
+ * @param device_addrs the addresses of the devices
+ * @param num_devices the number of devices, at most HISTORY_MAX_SERIES
+ * @return SIZE_ERR for too many devices, INIT_ERR if an allocation failed, NOERR otherwise
+ */
+int8_t history_set_devices(struct History* history, const uint8_t* device_addrs, int num_devices);
+
+/**
+ * @brief Frees every series
+ *
+ * @param history the history
+ */
+void history_free(struct History* history);
+
+/**
+ * @brief Appends the sample to its device's series, overwriting the oldest once full
+ *
+ * @param history the history
+ * @param sample the sample just read
+ * @return ADDR_ERR if the device has no series, NOERR otherwise
+ */
+int8_t history_add(struct History* history, const struct Sensor_Data* sample);
+
+/**
+ * @brief Gets the device's series
+ *
+ * @param history the history
+ * @param device_addr the device's hex address on the I2C bus
+ * @return the series or NULL if the device has none
+ */
+const struct History_Series* history_find(const struct History* history, uint8_t device_addr);
+
+/**
+ * @brief Gets the channel's latest reading
+ *
+ * @param series the device's series
+ * @param channel the index of the channel
+ * @param point the out parameter for the reading
+ * @return whether the channel has any readings
+ */
+bool history_latest(const struct History_Series* series, int channel, struct History_Point* point);
+
+/**
+ * @brief Copies the channel's readings in [from_ms, to_ms], oldest first
+ *
+ * @param series the device's series
+ * @param channel the index of the channel
+ * @param from_ms the start of the range in wall-clock milliseconds
+ * @param to_ms the end of the range in wall-clock milliseconds
+ * @param points the out parameter for the readings
+ * @param max_points the size of points, later readings are left out
+ * @return the number of readings copied
+ */
+uint32_t history_range(const struct History_Series* series, int channel, uint64_t from_ms,
+                        uint64_t to_ms, struct History_Point* points, uint32_t max_points);
+
+/**
+ * @brief Aggregates the channel's readings in [from_ms, to_ms] with the scan kernels
+ *
+ * @param series the device's series
+ * @param channel the index of the channel
+ * @param from_ms the start of the range in wall-clock milliseconds
+ * @param to_ms the end of the range in wall-clock milliseconds
+ * @param threshold the exceedance threshold, NAN counts nothing as above
+ * @param result the out parameter for the aggregates
+ * @return whether the channel exists
+ */
+bool history_aggregate(const struct History_Series* series, int channel, uint64_t from_ms,
+                        uint64_t to_ms, float threshold, struct Scan_Result* result);
+
+/**
+ * @brief Summarizes the channel's readings in [from_ms, to_ms] into steps of step_ms
+ *
+ * Steps start at from_ms and steps without any readings are left out
+ *
+ * @param series the device's series
+ * @param channel the index of the channel
+ * @param from_ms the start of the range in wall-clock milliseconds
+ * @param to_ms the end of the range in wall-clock milliseconds
+ * @param step_ms the length of each step, must not be 0
+ * @param buckets the out parameter for the steps
+ * @param max_buckets the size of buckets, later steps are left out
+ * @return the number of steps summarized
+ */
+uint32_t history_downsample(const struct History_Series* series, int channel, uint64_t from_ms,
+                            uint64_t to_ms, uint32_t step_ms, struct History_Bucket* buckets,
+                            uint32_t max_buckets);
+
+#endif
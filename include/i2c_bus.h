@@ -0,0 +1,163 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "errors.h"
+#include "bus_capture.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define MAX_BUSES 8
+#define I2C_SYSFS_ADAPTER "/sys/bus/i2c/devices/i2c-%u"
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+struct Fault_Injector;
+
+/**
+ * @brief Serves the transfers in place of the adapters, such as simulated devices
+ *
+ * Each transfer gets its adapter's file descriptor, so devices at the same address
+ * on different adapters can be told apart
+ */
+struct I2C_Backend {
+    int8_t (*write)(void* context, int fd, uint8_t device_addr, const uint8_t* data, uint16_t count);
+    int8_t (*read)(void* context, int fd, uint8_t device_addr, uint8_t* data, uint16_t count);
+    void* context;
+};
+
+/*******************************************************************************
+*                            Function Definitions                              *
+*******************************************************************************/
+
+/**
+ * @brief Opens the given I2C adapter or shares its already opened file descriptor
+ *
+ * Each adapter is only opened once, every other device on the same adapter gets the
+ * same file descriptor and increments the adapter's reference count
+ *
+ * @param adapter_num the I2C adapter to open
+ * @param fd the out parameter file descriptor for the I2C adapter
+ * @return INIT_ERR if the adapter couldn't be opened, NOERR otherwise
+ */
+int i2c_bus_open(uint32_t adapter_num, int* fd);
+
+/**
+ * @brief Releases a reference to the I2C adapter
+ *
+ * The adapter is only closed once the last device using it has been released
+ *
+ * @param fd the file descriptor of the I2C adapter, set to -1 once released
+ */
+void i2c_bus_close(int* fd);
+
+/**
+ * @brief Resets the I2C adapter's controller by rebinding it to its driver through sysfs
+ *
+ * Probing the controller again resets it and the driver's state, which clears a
+ * controller wedged mid-transfer. i2c-dev has no way to clock SCL, so a device
+ * holding SDA low is only released if the driver recovers the bus itself. The
+ * adapter is then reopened onto the same file descriptor, so every device sharing
+ * it keeps a valid descriptor. The descriptor points at /dev/null while the
+ * controller is unbound, since an open adapter would keep the unbind waiting
+ * forever. The adapter may come back under a different number, which the bus then
+ * uses. Needs write access to the driver's bind and unbind files, usually root.
+ * Only the descriptor is reopened while replaying or simulating
+ *
+ * @param fd the file descriptor of the I2C adapter
+ * @return INIT_ERR if the adapter isn't open, couldn't be rebound or reopened, NOERR otherwise
+ */
+int8_t i2c_bus_reset_adapter(int* fd);
+
+/**
+ * @brief Writes the count number of bytes to the device at the given address
+ *
+ * The target is addressed per transaction using I2C_RDWR instead of I2C_SLAVE
+ *
+ * @param data the data to be written
+ * @param count the amount of data to be written
+ * @param device_addr the device's hex address on the I2C bus
+ * @param fd the file descriptor of the I2C adapter
+ * @return NACK_ERR if the device didn't acknowledge, WRITE_ERR if the transaction
+ *          failed otherwise, NOERR if it succeeded
+ */
+int8_t i2c_bus_write(uint8_t* data, uint16_t count, uint8_t device_addr, int* fd);
+
+/**
+ * @brief Reads the count number of bytes from the device at the given address
+ *
+ * @param data where the data will be written to
+ * @param count the amount of data to be read
+ * @param device_addr the device's hex address on the I2C bus
+ * @param fd the file descriptor of the I2C adapter
+ * @return NACK_ERR if the device didn't acknowledge, READ_ERR if the transaction
+ *          failed otherwise, NOERR if it succeeded
+ */
+int8_t i2c_bus_read(uint8_t* data, uint16_t count, uint8_t device_addr, int* fd);
+
+/**
+ * @brief Logs every transaction to the capture from now on
+ *
+ * Should be set before any worker starts
+ *
+ * @param bus_capture the capture being written, NULL to stop capturing
+ */
+void i2c_bus_capture(struct Bus_Capture* bus_capture);
+
+/**
+ * @brief Serves every transaction from a capture instead of the adapters
+ *
+ * Adapters are opened as /dev/null so the descriptors stay valid, and each device's
+ * transfers get its captured results in order. Should be set before any worker starts
+ *
+ * @param bus_capture the capture being replayed, NULL to go back to the adapters
+ */
+void i2c_bus_replay(struct Bus_Capture* bus_capture);
+
+/**
+ * @brief Serves every transaction from the backend instead of the adapters
+ *
+ * Adapters are opened as /dev/null so the descriptors stay valid. Should be set
+ * before any worker starts
+ *
+ * @param i2c_backend the backend, NULL to go back to the adapters
+ */
+void i2c_bus_simulate(const struct I2C_Backend* i2c_backend);
+
+/**
+ * @brief Whether the transactions are being replayed or simulated, commands don't
+ *          need to wait for such a device to execute them
+ *
+ * @return whether a capture is being replayed or a backend serves the transactions
+ */
+bool i2c_bus_replaying(void);
+
+/**
+ * @brief Applies the injector's device faults to every transaction from now on
+ *
+ * The faults are applied to the real or replayed result, before it is captured, so
+ * a capture of a faulty run replays the same faults. Should be set before any
+ * worker starts
+ *
+ * @param fault_injector the fault injector, NULL to stop injecting faults
+ */
+void i2c_bus_inject(struct Fault_Injector* fault_injector);
+
+#endif
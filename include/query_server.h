@@ -0,0 +1,149 @@
+#ifndef QUERY_SERVER_H
+#define QUERY_SERVER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include "history.h"
+#include "errors.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define QUERY_MAX_CLIENTS 8
+#define QUERY_MAX_POINTS 4096
+#define QUERY_PATH_SIZE 108
+
+//Epoll ids at or above QUERY_EVENT_ID belong to the query server
+#define QUERY_EVENT_ID 0x10000U
+
+enum Query_Type {
+    QUERY_LATEST = 1,
+    QUERY_RANGE = 2,
+    QUERY_DOWNSAMPLE = 3,
+    QUERY_AGGREGATE = 4,
+};
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief A request, sent as a single SOCK_SEQPACKET message in host byte order
+ *
+ * Times are wall-clock milliseconds, step_ms is only used by QUERY_DOWNSAMPLE and
+ * threshold only by QUERY_AGGREGATE
+ */
+struct Query_Request {
+    uint8_t type;
+    uint8_t device_addr;
+    uint8_t channel;
+    uint8_t reserved;
+    uint32_t step_ms;
+    uint64_t from_ms;
+    uint64_t to_ms;
+    float threshold;
+} __attribute__((packed));
+
+/**
+ * @brief The header of a response, followed by count Query_Points for QUERY_LATEST and
+ *          QUERY_RANGE, count Query_Buckets for QUERY_DOWNSAMPLE, or one
+ *          Query_Aggregate for QUERY_AGGREGATE
+ *
+ * A response holds at most QUERY_MAX_POINTS entries, longer ranges are paged by
+ * asking again from after the last timestamp received
+ */
+struct Query_Response {
+    int8_t status;
+    uint8_t type;
+    uint16_t reserved;
+    uint32_t count;
+} __attribute__((packed));
+
+struct Query_Point {
+    uint64_t timestamp_ms;
+    float value;
+} __attribute__((packed));
+
+struct Query_Bucket {
+    uint64_t start_ms;
+    uint32_t count;
+    float min;
+    float max;
+    float mean;
+} __attribute__((packed));
+
+/**
+ * @brief The whole range's aggregates, above counts the readings over the threshold
+ */
+struct Query_Aggregate {
+    uint32_t count;
+    uint32_t nan_count;
+    uint32_t above;
+    float min;
+    float max;
+    float mean;
+} __attribute__((packed));
+
+struct Query_Server {
+    int listen_fd;
+    int client_fds[QUERY_MAX_CLIENTS];
+    char path[QUERY_PATH_SIZE];
+};
+
+#define QUERY_RESPONSE_SIZE (sizeof(struct Query_Response) \
+                            + QUERY_MAX_POINTS * sizeof(struct Query_Bucket))
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Answers a request from the history
+ *
+ * @param history the history
+ * @param request the request
+ * @param response the out parameter for the response, MUST HOLD QUERY_RESPONSE_SIZE
+ * @return the size of the response in bytes
+ */
+size_t query_execute(const struct History* history, const struct Query_Request* request,
+                    uint8_t* response);
+
+/**
+ * @brief Listens on the Unix domain socket and adds it to the epoll
+ *
+ * @param server the server
+ * @param path the socket's path, a stale socket left at the path is replaced
+ * @param epoll_fd the epoll file descriptor the server's sockets are added to
+ * @return INIT_ERR if the socket couldn't be bound, NOERR otherwise
+ */
+int8_t query_server_open(struct Query_Server* server, const char* path, int epoll_fd);
+
+/**
+ * @brief Closes every connection and removes the socket
+ *
+ * @param server the server
+ * @param epoll_fd the epoll file descriptor the server's sockets were added to
+ */
+void query_server_close(struct Query_Server* server, int epoll_fd);
+
+/**
+ * @brief Accepts a connection or answers a request, never blocking on a client
+ *
+ * A client that can't take its response right away is disconnected
+ *
+ * @param server the server
+ * @param event_id the epoll event's id, at or above QUERY_EVENT_ID
+ * @param epoll_fd the epoll file descriptor the server's sockets were added to
+ * @param history the history queries are answered from
+ */
+void query_server_handle(struct Query_Server* server, uint32_t event_id, int epoll_fd,
+                        const struct History* history);
+
+#endif
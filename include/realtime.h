@@ -0,0 +1,86 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "errors.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define NO_CPU_PIN -1
+#define REALTIME_STACK_SIZE (256 * 1024)
+#define REALTIME_PREFAULT_SIZE (64 * 1024)
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief Where and how each kind of thread runs while in real-time mode
+ *
+ * CPUs set to NO_CPU_PIN are left to the scheduler. The acquisition threads are
+ * run under SCHED_FIFO with the given priority, everything else keeps the default
+ * scheduling policy
+ */
+struct Realtime_Config {
+    bool enabled;
+    int acquisition_cpu;
+    int processing_cpu;
+    int publish_cpu;
+    int acquisition_priority;
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Locks every current and future page of the process into memory
+ *
+ * @return errno if the memory couldn't be locked, NOERR otherwise
+ */
+int realtime_lock_memory(void);
+
+/**
+ * @brief Touches the given amount of the calling thread's stack so it is faulted in
+ *
+ * @param size the number of bytes of stack to fault in
+ */
+void realtime_prefault_stack(size_t size);
+
+/**
+ * @brief Touches every page of the buffer so it is faulted in
+ *
+ * @param buffer the buffer to fault in
+ * @param size the size of the buffer in bytes
+ */
+void realtime_prefault_buffer(void* buffer, size_t size);
+
+/**
+ * @brief Pins the calling thread to the given CPU
+ *
+ * @param cpu the CPU to run on or NO_CPU_PIN to leave the thread unpinned
+ * @return errno if the affinity couldn't be set, NOERR otherwise
+ */
+int realtime_pin_current(int cpu);
+
+/**
+ * @brief Initializes the thread attributes for a pinned, optionally SCHED_FIFO, thread
+ *
+ * The attributes also reserve REALTIME_STACK_SIZE of stack so it can be prefaulted
+ *
+ * @param attr the thread attributes to be initialized, destroyed by the caller
+ * @param cpu the CPU to run on or NO_CPU_PIN to leave the thread unpinned
+ * @param priority the SCHED_FIFO priority or 0 to keep the default policy
+ * @return errno if the attributes couldn't be set, NOERR otherwise
+ */
+int realtime_thread_attr(pthread_attr_t* attr, int cpu, int priority);
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef RECORD_JOIN_H
+#define RECORD_JOIN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "sensor_data.h"
+#include "derived.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define JOIN_MAX_DEVICES 8
+#define JOIN_MAX_PENDING 4
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief Whether a device's fields in a record came from the record's time bucket
+ */
+enum Field_State {
+    FIELD_MISSING,  //the device has never delivered a sample
+    FIELD_STALE,    //the fields are carried over from an earlier bucket
+    FIELD_FRESH,    //the fields were read during the record's bucket
+};
+
+/**
+ * @brief One record per time bucket holding a sample from every device
+ *
+ * The derived metrics aren't filled in by the join, the publisher derives them
+ * once as the record is queued
+ */
+struct Joined_Record {
+    uint64_t bucket;
+    uint64_t monotonic_ms;
+    int num_devices;
+    enum Field_State states[JOIN_MAX_DEVICES];
+    struct Sensor_Data samples[JOIN_MAX_DEVICES];
+    struct Derived_Values derived;
+};
+
+struct Join_Bucket {
+    bool in_use;
+    uint64_t index;
+    bool fresh[JOIN_MAX_DEVICES];
+    struct Sensor_Data samples[JOIN_MAX_DEVICES];
+};
+
+/**
+ * @brief Assembles the samples from every device into one record per time bucket
+ *
+ * Buckets are the length of the sampling period and are centered on the first
+ * sample received. A bucket is emitted exactly once, either as soon as every device
+ * has delivered a sample for it or moved past it, or once the lateness window after
+ * the end of the bucket has run out. Samples arriving after their bucket has been
+ * emitted are dropped and counted
+ */
+struct Record_Join {
+    uint32_t bucket_ms;
+    uint32_t lateness_ms;
+    int num_devices;
+    uint8_t device_addrs[JOIN_MAX_DEVICES];
+
+    bool has_origin;
+    uint64_t origin_ms;
+    uint64_t next_bucket;
+    struct Join_Bucket pending[JOIN_MAX_PENDING];
+
+    bool has_latest[JOIN_MAX_DEVICES];
+    uint64_t latest_bucket[JOIN_MAX_DEVICES];
+    bool has_emitted[JOIN_MAX_DEVICES];
+    struct Sensor_Data last_emitted[JOIN_MAX_DEVICES];
+
+    uint32_t late_samples;
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Initializes the join for the given devices
+ *
+ * @param join the join to be initialized
+ * @param device_addrs the addresses of the devices being joined, the record keeps this order
+ * @param num_devices the number of devices, at most JOIN_MAX_DEVICES
+ * @param bucket_ms the length of each time bucket in milliseconds
+ * @param lateness_ms how long after a bucket ends to wait for missing devices
+ * @return SIZE_ERR if there are too many devices or the bucket is empty, NOERR otherwise
+ */
+int8_t record_join_init(struct Record_Join* join, const uint8_t* device_addrs,
+                        int num_devices, uint32_t bucket_ms, uint32_t lateness_ms);
+
+/**
+ * @brief Adds a sample to its time bucket
+ *
+ * @param join the join
+ * @param sample the sample to be added
+ * @param records the out parameter for the emitted records, MUST HOLD JOIN_MAX_PENDING
+ * @return the number of records emitted or ADDR_ERR if the device isn't being joined
+ */
+int record_join_add(struct Record_Join* join, const struct Sensor_Data* sample,
+                    struct Joined_Record* records);
+
+/**
+ * @brief Emits every bucket whose lateness window has run out
+ *
+ * @param join the join
+ * @param now_ms the current monotonic time in milliseconds
+ * @param records the out parameter for the emitted records, MUST HOLD JOIN_MAX_PENDING
+ * @return the number of records emitted
+ */
+int record_join_poll(struct Record_Join* join, uint64_t now_ms, struct Joined_Record* records);
+
+/**
+ * @brief Emits every pending bucket regardless of its lateness window
+ *
+ * @param join the join
+ * @param records the out parameter for the emitted records, MUST HOLD JOIN_MAX_PENDING
+ * @return the number of records emitted
+ */
+int record_join_flush(struct Record_Join* join, struct Joined_Record* records);
+
+/**
+ * @brief Gets how long until the next pending bucket's lateness window runs out
+ *
+ * @param join the join
+ * @param now_ms the current monotonic time in milliseconds
+ * @return the timeout in milliseconds or -1 if nothing is pending, usable by epoll_wait()
+ */
+int record_join_timeout(const struct Record_Join* join, uint64_t now_ms);
+
+#endif
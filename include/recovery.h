@@ -0,0 +1,127 @@
+#ifndef RECOVERY_H
+#define RECOVERY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define RECOVERY_STEP_ATTEMPTS 3
+#define RECOVERY_MIN_BACKOFF_MS 100
+#define RECOVERY_MAX_BACKOFF_MS 60000
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief The increasingly drastic steps taken to bring a failing device back
+ */
+enum Recovery_Step {
+    RECOVERY_RETRY,     //retries the read as is
+    RECOVERY_REOPEN,    //releases and re-initializes the device's file descriptor
+    RECOVERY_RESET,     //soft resets the device
+    RECOVERY_ADAPTER,   //resets the I2C adapter's controller for every device on it
+    RECOVERY_STEPS,
+};
+
+/**
+ * @brief The device's fault and recovery counts, carried by every sample
+ *
+ * A fault is a run of failed reads that ends once the device delivers data again
+ */
+struct Recovery_Stats {
+    uint32_t faults;
+    uint32_t recoveries;
+    uint32_t attempts;
+    uint32_t last_recovery_ms;
+    uint32_t max_recovery_ms;
+};
+
+/**
+ * @brief A device's recovery state machine
+ *
+ * Every failure schedules the next step after an exponential backoff. Each step is
+ * tried RECOVERY_STEP_ATTEMPTS times before escalating to the next one, and after
+ * the adapter has been reset it starts over from retrying with the backoff capped
+ * at RECOVERY_MAX_BACKOFF_MS. A failure that says which step it needs skips the
+ * steps before it without lengthening the backoff
+ */
+struct Recovery {
+    bool recovering;
+    bool waiting;
+    uint32_t episode_attempts;
+    uint32_t skipped_attempts;
+    enum Recovery_Step step;
+    uint64_t fault_ms;
+    uint64_t retry_ms;
+    struct Recovery_Stats stats;
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Initializes the recovery state machine for a healthy device
+ *
+ * @param recovery the state machine to be initialized
+ */
+void recovery_init(struct Recovery* recovery);
+
+/**
+ * @brief Records a failed read or recovery step and schedules the next step
+ *
+ * @param recovery the device's state machine
+ * @param now_ms the current monotonic time in milliseconds
+ * @return the step to take once the backoff has run out
+ */
+enum Recovery_Step recovery_fail(struct Recovery* recovery, uint64_t now_ms);
+
+/**
+ * @brief Records a failed read whose cause needs at least the given step
+ *
+ * @param recovery the device's state machine
+ * @param step the least drastic step that can fix the failure
+ * @param now_ms the current monotonic time in milliseconds
+ * @return the step to take once the backoff has run out
+ */
+enum Recovery_Step recovery_fail_from(struct Recovery* recovery, enum Recovery_Step step, uint64_t now_ms);
+
+/**
+ * @brief Records that the device delivered data again, ending the fault
+ *
+ * @param recovery the device's state machine
+ * @param now_ms the current monotonic time in milliseconds
+ * @return whether a fault was ended
+ */
+bool recovery_succeed(struct Recovery* recovery, uint64_t now_ms);
+
+/**
+ * @brief Marks the scheduled step as taken, reads resume on the next sampling period
+ *
+ * @param recovery the device's state machine
+ */
+void recovery_step_taken(struct Recovery* recovery);
+
+/**
+ * @brief Gets how long until the scheduled step is due
+ *
+ * @param recovery the device's state machine
+ * @param now_ms the current monotonic time in milliseconds
+ * @return the timeout in milliseconds or -1 if no step is scheduled, usable by epoll_wait()
+ */
+int recovery_timeout(const struct Recovery* recovery, uint64_t now_ms);
+
+/**
+ * @brief Gets the name of the recovery step for logging
+ *
+ * @param step the recovery step
+ * @return the step's name
+ */
+const char* recovery_step_name(enum Recovery_Step step);
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+//Partial sums are kept in floats for at most this many values before being
+//added to the double total, which bounds their rounding error
+#define SCAN_BLOCK 1024
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief The aggregates of a scanned column
+ *
+ * NAN readings are counted in nan_count and left out of everything else, so min
+ * and max stay NAN until a valid reading is scanned. above counts the readings
+ * strictly greater than the threshold
+ */
+struct Scan_Result {
+    uint32_t count;
+    uint32_t nan_count;
+    uint32_t above;
+    float min;
+    float max;
+    double sum;
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Empties the result before the first scan
+ *
+ * @param result the result
+ */
+void scan_init(struct Scan_Result* result);
+
+/**
+ * @brief Adds a contiguous column of values to the result
+ *
+ * Uses SSE2 or NEON when the target has them and SCAN_SCALAR isn't defined,
+ * otherwise the same as scan_column_scalar()
+ *
+ * @param values the column
+ * @param num_values the number of values in the column
+ * @param threshold the exceedance threshold, NAN counts nothing as above
+ * @param result the result the column is added to
+ */
+void scan_column(const float* values, uint32_t num_values, float threshold,
+                struct Scan_Result* result);
+
+/**
+ * @brief Adds a contiguous column of values to the result one value at a time
+ *
+ * @param values the column
+ * @param num_values the number of values in the column
+ * @param threshold the exceedance threshold, NAN counts nothing as above
+ * @param result the result the column is added to
+ */
+void scan_column_scalar(const float* values, uint32_t num_values, float threshold,
+                        struct Scan_Result* result);
+
+/**
+ * @brief Gets the mean of the scanned values
+ *
+ * @param result the result
+ * @return the mean or NAN if no valid value was scanned
+ */
+float scan_mean(const struct Scan_Result* result);
+
+/**
+ * @brief Gets which kernel scan_column() uses
+ *
+ * @return "sse2", "neon", or "scalar"
+ */
+const char* scan_kernel(void);
+
+#endif
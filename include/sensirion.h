@@ -0,0 +1,221 @@
+#ifndef SENSIRION_H
+#define SENSIRION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include "i2c_bus.h"
+#include "clock_source.h"
+#include "errors.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define SENSIRION_WORD_SIZE 2
+#define SENSIRION_CRC_LENGTH 1
+#define SENSIRION_CRC_POLYNOMIAL 0x31
+#define SENSIRION_MAX_WORDS 16
+
+//Calibration polls for the response every step, the slowest of the rounds plus the
+//larger margin becomes the delay
+#define SENSIRION_PROBE_STEP_US 500
+#define SENSIRION_CALIBRATION_ROUNDS 5
+#define SENSIRION_MARGIN_PERCENT 25
+#define SENSIRION_MARGIN_MIN_US 1000
+
+//Clean responses in a row before a backed off delay steps back toward the calibrated one
+#define SENSIRION_TIGHTEN_AFTER 100
+
+/**
+ * Each driver lists its commands once as an X-macro table with every entry being
+ *   X(id, code, execution_us, response_words, attempts, rereads)
+ * where
+ *   id is appended to the driver's prefix for the command's index, e.g. SEN55_READ_VALUES
+ *   code is the 16 bit command written to the device
+ *   execution_us is the datasheet's execution time before the response can be read
+ *   response_words is the number of 16 bit words in the response, each followed by a CRC
+ *   attempts is how many times the command is sent while its response fails the CRC
+ *   rereads is how many times a response that failed the CRC is read again before the
+ *     command is sent again, 0 if the device drops its response once it has been read
+ */
+
+//Expands a table entry into its Sensirion_Command initializer
+#define SENSIRION_COMMAND(id, code, execution_us, response_words, attempts, rereads) \
+    {code, execution_us, response_words, attempts, rereads},
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief Describes how a command is sent to a Sensirion device and its response read
+ */
+struct Sensirion_Command {
+    uint16_t code;
+    uint32_t execution_us;
+    uint8_t response_words;
+    uint8_t attempts;
+    uint8_t rereads;
+};
+
+/**
+ * @brief What a response that failed the CRC says about the link
+ */
+enum Sensirion_Crc_Class {
+    SENSIRION_CRC_NOISE,        //a few bits flipped in transit, reading again fixes it
+    SENSIRION_CRC_SYSTEMATIC,   //reading again returns the same bad bytes, the device sent them
+    SENSIRION_CRC_BUS_STUCK,    //every byte read as 0xFF or 0x00, a line is held
+    SENSIRION_CRC_CLASSES,
+};
+
+/**
+ * @brief A command's delay on one device, tuned from how fast it really responds,
+ *          and the errors its responses have had
+ *
+ * Until the command is calibrated the delay is 0 and the datasheet's execution time
+ * is used. A NACK means the delay was too short, it is backed off toward the
+ * execution time and tightened again after SENSIRION_TIGHTEN_AFTER clean responses
+ */
+struct Sensirion_Tuning {
+    uint32_t delay_us;
+    uint32_t calibrated_us;
+    uint32_t responses;
+    uint32_t nacks;
+    uint32_t clean_responses;
+    uint32_t rereads;
+    uint32_t crc_errors[SENSIRION_CRC_CLASSES];
+};
+
+/**
+ * @brief A device's link counts summed over its commands
+ *
+ * The delay is what reading a sample currently waits on, the rest are totals since
+ * the publisher started
+ */
+struct Sensirion_Stats {
+    uint32_t delay_us;
+    uint32_t responses;
+    uint32_t nacks;
+    uint32_t rereads;
+    uint32_t crc_errors[SENSIRION_CRC_CLASSES];
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Waits for a device to execute a command on the clock source
+ *
+ * A virtual clock is always advanced by the wait. On the system's clock nothing is
+ * waited for while the devices are replayed or simulated
+ *
+ * @param delay_us the time to wait in microseconds
+ */
+void sensirion_wait(uint32_t delay_us);
+
+/**
+ * @brief Generates the CRC-8 Sensirion devices append to every word
+ *
+ * @param word the word's two bytes
+ * @return the checksum
+ */
+uint8_t sensirion_crc(const uint8_t* word);
+
+/**
+ * @brief Writes the command to the device without waiting for it to execute
+ *
+ * Lets a caller that can't block, or that starts commands on several devices at
+ * once, wait out the execution time itself before calling sensirion_receive()
+ *
+ * @param device_addr the device's hex address on the I2C bus
+ * @param command the command to be sent
+ * @param fd the opened file descriptor for the I2C device
+ * @return WRITE_ERR if the device couldn't be written to, NOERR otherwise
+ */
+int8_t sensirion_send(uint8_t device_addr, const struct Sensirion_Command* command, int* fd);
+
+/**
+ * @brief Reads the command's response and strips the CRC after each word
+ *
+ * @param device_addr the device's hex address on the I2C bus
+ * @param command the command that was sent
+ * @param response the out parameter for the words, MUST HOLD 2 * response_words BYTES
+ * @param fd the opened file descriptor for the I2C device
+ * @return READ_ERR if the device couldn't be read, CRC_ERR if a checksum mismatched,
+ *          NOERR otherwise
+ */
+int8_t sensirion_receive(uint8_t device_addr, const struct Sensirion_Command* command, 
+                         uint8_t* response, int* fd);
+
+/**
+ * @brief Classifies a response that failed the CRC
+ *
+ * @param raw the response as read, words and CRCs
+ * @param size the size of the response in bytes
+ * @param previous the response as read the time before without resending, NULL if none
+ * @return SENSIRION_CRC_BUS_STUCK if every byte is 0xFF or 0x00, SENSIRION_CRC_SYSTEMATIC
+ *          if it matches the previous read, SENSIRION_CRC_NOISE otherwise
+ */
+enum Sensirion_Crc_Class sensirion_classify(const uint8_t* raw, uint16_t size, const uint8_t* previous);
+
+/**
+ * @brief Sends the command, sleeps for its delay and reads its response
+ *
+ * A response that fails the CRC is first read again, up to the command's rereads,
+ * which costs a read but no execution time. The command is only sent again, up to
+ * its attempts, once the bad bytes repeat or the rereads run out. Commands without
+ * a response return once they have had time to execute. A tuned command that is
+ * NACKed backs off and is read again once its execution time is up
+ *
+ * @param device_addr the device's hex address on the I2C bus
+ * @param command the command to be executed
+ * @param tuning the command's tuned delay on the device, NULL for the datasheet's
+ * @param response the out parameter for the words, MUST HOLD 2 * response_words BYTES
+ * @param fd the opened file descriptor for the I2C device
+ * @return BUS_ERR if the bus is stuck, an error if the device couldn't be written to
+ *          or read from, NOERR otherwise
+ */
+int8_t sensirion_execute(uint8_t device_addr, const struct Sensirion_Command* command, 
+                         struct Sensirion_Tuning* tuning, uint8_t* response, int* fd);
+
+/**
+ * @brief Gets how long the command is waited on before its response is read
+ *
+ * @param command the command
+ * @param tuning the command's tuned delay on the device, can be NULL
+ * @return the delay in microseconds
+ */
+uint32_t sensirion_delay(const struct Sensirion_Command* command, const struct Sensirion_Tuning* tuning);
+
+/**
+ * @brief Adds a command's counts to the device's link counts
+ *
+ * @param stats the device's link counts
+ * @param tuning the command's tuned delay and errors on the device
+ */
+void sensirion_add_stats(struct Sensirion_Stats* stats, const struct Sensirion_Tuning* tuning);
+
+/**
+ * @brief Probes the device's real minimum delay for a command with a response
+ *
+ * The command is sent SENSIRION_CALIBRATION_ROUNDS times and its response polled
+ * every SENSIRION_PROBE_STEP_US until it is acknowledged. The slowest round plus
+ * the larger of SENSIRION_MARGIN_PERCENT and SENSIRION_MARGIN_MIN_US becomes the
+ * delay, never more than the execution time. A failed calibration leaves the
+ * tuning as it was
+ *
+ * @param device_addr the device's hex address on the I2C bus
+ * @param command the command to be calibrated
+ * @param tuning the out parameter for the command's tuned delay on the device
+ * @param fd the opened file descriptor for the I2C device
+ * @return SIZE_ERR if the command has no response, an error if the device didn't
+ *          respond within the execution time, NOERR otherwise
+ */
+int8_t sensirion_calibrate(uint8_t device_addr, const struct Sensirion_Command* command,
+                           struct Sensirion_Tuning* tuning, int* fd);
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef SENSOR_DATA_H
+#define SENSOR_DATA_H
+
+#include <stdint.h>
+#include <time.h>
+#include "functions.h"
+#include "recovery.h"
+#include "clock_source.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define MAX_DATAPOINTS ((int)SEN55_DATAPOINTS > (int)SCD40_DATAPOINTS \
+                        ? (int)SEN55_DATAPOINTS \
+                        : (int)SCD40_DATAPOINTS)
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief A single sample read from a device
+ *
+ * The sample is small enough to be passed through a pipe by value so the reader
+ * never points into the worker's stack. The scheduled time is when the sampling
+ * timer expired and overruns counts every timer period the device has missed so far,
+ * whether the worker overran it, skipped it during a recovery backoff, or its read failed.
+ * The recovery counts cover every read fault the device has recovered from, and the
+ * bus counts how long the device's reads wait and every NACK and CRC error they had
+ */
+struct Sensor_Data {
+    uint8_t device_addr;
+    uint32_t sequence;
+    uint32_t overruns;
+    struct Recovery_Stats recovery;
+    struct Sensirion_Stats bus;
+    struct timespec scheduled;
+    struct timespec monotonic;
+    struct timespec realtime;
+    int num_data;
+    float data[MAX_DATAPOINTS];
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Gives the sample the sequence number of the latest period the timer started
+ *
+ * Every scheduled period takes a sequence number whether or not its sample is read,
+ * so periods that were skipped or whose read failed show up as gaps
+ *
+ * @param sample the sample to be read in the period
+ * @param sequence the device's sequence counter, advanced past every period
+ * @param periods the number of periods started since the last call
+ */
+void sensor_data_schedule(struct Sensor_Data* sample, uint32_t* sequence, uint64_t periods);
+
+/**
+ * @brief Tags the sample with the acquisition times
+ *
+ * Should be called as soon as the read completes so the timestamps reflect the
+ * acquisition rather than when the sample is published
+ *
+ * @param sample the sample to be tagged
+ */
+void sensor_data_stamp(struct Sensor_Data* sample);
+
+/**
+ * @brief Gets the number of samples missed between two consecutive sequence numbers
+ *
+ * @param previous the sequence number of the last sample received from the device
+ * @param current the sequence number of the sample just received
+ * @return the number of samples skipped, 0 if none were missed
+ */
+uint32_t sensor_data_gap(uint32_t previous, uint32_t current);
+
+/**
+ * @brief Converts a timespec to milliseconds
+ *
+ * @param time the time to be converted
+ * @return the time in milliseconds
+ */
+uint64_t timespec_to_ms(const struct timespec* time);
+
+/**
+ * @brief Gets the current CLOCK_MONOTONIC time in milliseconds
+ *
+ * @return the current monotonic time in milliseconds
+ */
+uint64_t monotonic_now_ms(void);
+
+#endif
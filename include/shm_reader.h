@@ -0,0 +1,80 @@
+#ifndef SHM_READER_H
+#define SHM_READER_H
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "shm_table.h"
+#include "errors.h"
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+struct Shm_Reader {
+    const struct Shm_Table* table;
+};
+
+/**
+ * @brief A channel looked up in the table's current layout
+ */
+struct Shm_Handle {
+    uint32_t layout;
+    int device;
+    int channel;
+};
+
+struct Shm_Value {
+    float value;
+    uint32_t sample_sequence;
+    uint64_t monotonic_ms;
+    uint64_t realtime_ms;
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Maps the publisher's latest-value table read-only
+ *
+ * @param name the POSIX shared-memory object's name, SHM_TABLE_NAME by default
+ * @param reader the out parameter for the reader
+ * @return INIT_ERR if the table doesn't exist or has another version, NOERR otherwise
+ */
+int8_t shm_reader_open(const char* name, struct Shm_Reader* reader);
+
+/**
+ * @brief Unmaps the table
+ *
+ * @param reader the reader
+ */
+void shm_reader_close(struct Shm_Reader* reader);
+
+/**
+ * @brief Looks up the channel's slot, done once so reads don't compare names
+ *
+ * @param reader the reader
+ * @param device the device's name, e.g. "SCD40"
+ * @param channel the channel's name, e.g. "co2"
+ * @param handle the out parameter for the channel's handle
+ * @return ADDR_ERR if the device has no such channel, NOERR otherwise
+ */
+int8_t shm_reader_lookup(const struct Shm_Reader* reader, const char* device,
+                        const char* channel, struct Shm_Handle* handle);
+
+/**
+ * @brief Reads the channel's latest value without blocking the publisher
+ *
+ * @param reader the reader
+ * @param handle the channel's handle
+ * @param value the out parameter for the value
+ * @return STALE_ERR if the layout changed since the lookup, READ_ERR if the channel
+ *          has no value yet, NOERR otherwise
+ */
+int8_t shm_reader_read(const struct Shm_Reader* reader, const struct Shm_Handle* handle,
+                        struct Shm_Value* value);
+
+#endif
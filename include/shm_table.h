@@ -0,0 +1,59 @@
+#ifndef SHM_TABLE_H
+#define SHM_TABLE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define SHM_TABLE_NAME "/air_quality_sensors"
+#define SHM_TABLE_MAGIC 0x534E5341U
+#define SHM_TABLE_VERSION 1
+#define SHM_MAX_DEVICES 8
+#define SHM_MAX_CHANNELS 8
+#define SHM_NAME_SIZE 16
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief The latest value of a single channel, protected by a seqlock
+ *
+ * The sequence is odd while the publisher is writing the slot and 0 until the
+ * channel's first value. Each slot has its own cache line so writing one channel
+ * never stalls readers of another
+ */
+struct Shm_Slot {
+    _Atomic uint32_t sequence;
+    float value;
+    uint32_t sample_sequence;
+    uint64_t monotonic_ms;
+    uint64_t realtime_ms;
+} __attribute__((aligned(64)));
+
+struct Shm_Device {
+    uint8_t address;
+    uint32_t num_channels;
+    char name[SHM_NAME_SIZE];
+    char channels[SHM_MAX_CHANNELS][SHM_NAME_SIZE];
+    struct Shm_Slot slots[SHM_MAX_CHANNELS];
+};
+
+/**
+ * @brief The shared-memory segment's layout
+ *
+ * The layout counter is a seqlock over the device and channel names, bumped
+ * whenever the configured devices change
+ */
+struct Shm_Table {
+    uint32_t magic;
+    uint32_t version;
+    _Atomic uint32_t layout;
+    uint32_t num_devices;
+    struct Shm_Device devices[SHM_MAX_DEVICES];
+};
+
+#endif
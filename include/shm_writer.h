@@ -0,0 +1,63 @@
+#ifndef SHM_WRITER_H
+#define SHM_WRITER_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "shm_table.h"
+#include "sensor_data.h"
+#include "device_io.h"
+#include "functions.h"
+#include "errors.h"
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Creates and maps the shared-memory latest-value table
+ *
+ * @param name the POSIX shared-memory object's name, starting with '/'
+ * A table left by an earlier run is reused, and a seqlock it crashed in the
+ * middle of writing is closed
+ *
+ * @param table the out parameter for the mapped table
+ * @return INIT_ERR if the segment couldn't be created or mapped, NOERR otherwise
+ */
+int8_t shm_table_create(const char* name, struct Shm_Table** table);
+
+/**
+ * @brief Unmaps and removes the shared-memory table
+ *
+ * @param name the POSIX shared-memory object's name
+ * @param table the mapped table, set to NULL once unmapped
+ */
+void shm_table_destroy(const char* name, struct Shm_Table** table);
+
+/**
+ * @brief Lays out a slot for every channel of the given devices
+ *
+ * Readers holding handles from the previous layout get STALE_ERR and have to look
+ * their channels up again. The slots of a device that moved or was replaced are
+ * cleared, so they have no value until the device's next sample
+ *
+ * @param table the mapped table
+ * @param device_addrs the addresses of the devices
+ * @param num_devices the number of devices, at most SHM_MAX_DEVICES
+ */
+void shm_table_layout(struct Shm_Table* table, const uint8_t* device_addrs, int num_devices);
+
+/**
+ * @brief Writes the sample's readings into its device's slots
+ *
+ * Only one thread may write to the table
+ *
+ * @param table the mapped table
+ * @param sample the sample just read
+ */
+void shm_table_update(struct Shm_Table* table, const struct Sensor_Data* sample);
+
+#endif
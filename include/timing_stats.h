@@ -0,0 +1,65 @@
+#ifndef TIMING_STATS_H
+#define TIMING_STATS_H
+
+#include <stdint.h>
+#include <string.h>
+#include "sensor_data.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define TIMING_BUCKETS 32
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief Per-device sampling-timing statistics
+ *
+ * Lateness is how long after the timer's scheduled expiration the read completed.
+ * It is kept in a histogram of power-of-two microsecond buckets so percentiles can be
+ * estimated in constant memory
+ */
+struct Timing_Stats {
+    uint64_t samples;
+    uint32_t overruns;
+    uint64_t last_lateness_us;
+    uint64_t max_lateness_us;
+    uint32_t histogram[TIMING_BUCKETS];
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Gets how long after its scheduled time the sample was read
+ *
+ * @param sample the sample holding both the scheduled and the acquisition time
+ * @return the lateness in microseconds, 0 if the sample was read early
+ */
+uint64_t timing_lateness_us(const struct Sensor_Data* sample);
+
+/**
+ * @brief Adds the sample's lateness and overrun count to the statistics
+ *
+ * @param stats the device's statistics
+ * @param sample the sample just received from the device
+ */
+void timing_stats_add(struct Timing_Stats* stats, const struct Sensor_Data* sample);
+
+/**
+ * @brief Estimates the lateness percentile from the histogram
+ *
+ * The estimate is the upper bound of the bucket holding the percentile, capped at
+ * the largest lateness seen
+ *
+ * @param stats the device's statistics
+ * @param percentile the percentile between 0 and 100
+ * @return the estimated lateness in microseconds, 0 if no samples were added
+ */
+uint64_t timing_stats_percentile(const struct Timing_Stats* stats, double percentile);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef TOPICS_H
+#define TOPICS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "errors.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define TOPIC_SIZE 128
+#define TOPIC_ALIAS_MAX_TOPICS 128
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief The MQTT v5 topic aliases assigned on the current connection
+ *
+ * Aliases are handed out in the order topics are first published, up to the
+ * maximum the broker allowed in its CONNACK. The first publish on an alias carries
+ * the full topic to establish it, every later one only carries the alias
+ */
+struct Topic_Aliases {
+    uint16_t maximum;
+    int num_topics;
+    bool established[TOPIC_ALIAS_MAX_TOPICS];
+    char topics[TOPIC_ALIAS_MAX_TOPICS][TOPIC_SIZE];
+};
+
+/*******************************************************************************
+*                           Function Definitions                               *
+*******************************************************************************/
+
+/**
+ * @brief Expands a topic template
+ *
+ * The template can hold the {gateway}, {device}, and {channel} placeholders
+ *
+ * @param topic the out parameter for the expanded topic
+ * @param size the size of the topic buffer
+ * @param template the topic template
+ * @param gateway the gateway's name
+ * @param device the device's name
+ * @param channel the channel's name
+ * @return CONFIG_ERR for an unknown placeholder, SIZE_ERR if the topic doesn't fit, NOERR otherwise
+ */
+int8_t topic_format(char* topic, size_t size, const char* template, const char* gateway,
+                    const char* device, const char* channel);
+
+/**
+ * @brief Forgets every alias, called on every new connection
+ *
+ * @param aliases the topic aliases
+ * @param maximum the broker's topic alias maximum, 0 disables aliases
+ */
+void topic_aliases_reset(struct Topic_Aliases* aliases, uint16_t maximum);
+
+/**
+ * @brief Gets the topic's alias, assigning one if there is room
+ *
+ * @param aliases the topic aliases
+ * @param topic the full topic
+ * @param established the out parameter whether the broker already knows the alias
+ * @return the alias or 0 if the topic has to be published without one
+ */
+uint16_t topic_alias_lookup(struct Topic_Aliases* aliases, const char* topic, bool* established);
+
+/**
+ * @brief Marks the alias as known to the broker once it has been published with its topic
+ *
+ * @param aliases the topic aliases
+ * @param alias the alias returned by topic_alias_lookup()
+ */
+void topic_alias_established(struct Topic_Aliases* aliases, uint16_t alias);
+
+#endif
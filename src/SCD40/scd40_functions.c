@@ -1,104 +1,116 @@
 #include "../../include/SCD40/scd40_functions.h"
 
 /*******************************************************************************
-*                           Function Implementations                           *
+*                                Global Variables                              *
 *******************************************************************************/
 
-int8_t scd40_start_measurement(int* fd) {
-    int8_t error;
-    uint8_t buffer[2];
-    uint32_t offset = 0;
+const struct Channel_Descriptor scd40_channels[SCD40_DATAPOINTS] = {
+    SCD40_CHANNELS(CHANNEL_DESCRIPTOR)
+};
 
-    offset = scd40_add_command_to_buffer(buffer, offset, SCD40_START_MEASUREMENT);
-    if ((error = scd40_device_write(buffer, 2, fd)) != NOERR) {
-        return error;
-    }
+const struct Sensirion_Command scd40_commands[SCD40_NUM_COMMANDS] = {
+    SCD40_COMMANDS(SENSIRION_COMMAND)
+};
 
-    usleep(2);
+//Tuned delays for the commands, the datasheet's until calibrated
+static struct Sensirion_Tuning tunings[SCD40_NUM_COMMANDS];
 
-    return NOERR;
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Executes one of the SCD40's commands with its tuned delay
+ *
+ * @param command the command to be executed
+ * @param response the out parameter for the command's response, NULL if it has none
+ * @param fd the opened file descriptor for the I2C device
+ * @return the error from sensirion_execute()
+ */
+static int8_t execute(enum Scd40_Command command, uint8_t* response, int* fd) {
+    return sensirion_execute(SCD40_ADDRESS, &scd40_commands[command], &tunings[command], response, fd);
+}
+
+int8_t scd40_start_measurement(int* fd) {
+    return execute(SCD40_START_MEASUREMENT, NULL, fd);
 }
 
 int8_t scd40_stop_measurement(int* fd) {
+    return execute(SCD40_STOP_MEASUREMENT, NULL, fd);
+}
+
+int8_t scd40_read_data_flag(bool* is_ready, int* fd) {
+    uint8_t response[SENSIRION_WORD_SIZE];
     int8_t error;
-    uint8_t buffer[2];
-    uint32_t offset = 0;
 
-    offset = scd40_add_command_to_buffer(buffer, offset, SCD40_STOP_MEASUREMENT);
-    if ((error = scd40_device_write(buffer, 2, fd)) != NOERR) {
+    if ((error = execute(SCD40_READ_DATA_FLAG, response, fd)) != NOERR) {
         return error;
     }
 
-    usleep(1000);
-
+    *is_ready = response[1];
     return NOERR;
 }
 
-int8_t scd40_read_data_flag(bool* is_ready, int* fd) {
+int8_t scd40_read_measurement_state(bool* is_measuring, int* fd) {
+    const struct Sensirion_Command* serial_number = &scd40_commands[SCD40_READ_SERIAL_NUMBER];
+    uint8_t response[SENSIRION_WORD_SIZE * SENSIRION_MAX_WORDS];
     int8_t error;
-    uint8_t buffer[3];
-    uint32_t offset = 0;
+    bool is_ready;
 
-    offset = scd40_add_command_to_buffer(buffer, offset, SCD40_READ_DATA_FLAG);
-    if ((error = scd40_device_write(buffer, 2, fd)) != NOERR) {
-        return error;
+    //The device only answers the serial number command while it is idle
+    if (sensirion_send(SCD40_ADDRESS, serial_number, fd) == NOERR) {
+        sensirion_wait(serial_number->execution_us);
+        *is_measuring = false;
+        return sensirion_receive(SCD40_ADDRESS, serial_number, response, fd);
     }
 
-    usleep(2);
-
-    if ((error = scd40_read_without_crc(buffer, 2, fd)) != NOERR) {
+    if ((error = scd40_read_data_flag(&is_ready, fd)) != NOERR) {
         return error;
     }
 
-    *is_ready = buffer[1];
+    *is_measuring = true;
     return NOERR;
 }
 
 int8_t scd40_read_into_buffer(float* data, size_t buffer_size, int* fd) {
-    uint8_t retries = 0;
-    uint8_t buffer[9];
+    uint8_t buffer[SENSIRION_WORD_SIZE * SCD40_DATAPOINTS];
     int8_t error;
-    uint32_t offset;
 
     if (buffer_size != SCD40_DATAPOINTS) {
         return SIZE_ERR;
     }
 
-    while (retries < SCD40_MAX_RETRIES) {
-        offset = 0;
-
-        offset = scd40_add_command_to_buffer(buffer, offset, SCD40_READ_VALUES);
-        if ((error = scd40_device_write(buffer, 2, fd)) != NOERR) {
-            return error;
-        }
-
-        usleep(2);
-
-        if ((error = scd40_read_without_crc(buffer, 6, fd)) == CRC_ERR) {
-            ++retries;
-            continue;
-        }
-
-        break;
-    }
-
-    if (error != NOERR) {
+    if ((error = execute(SCD40_READ_VALUES, buffer, fd)) != NOERR) {
         return error;
     }
 
-    uint16_t co2_concentration = scd40_read_bytes_as_uint16(&buffer[0]);
-    int16_t temp_C = scd40_read_bytes_as_int16(&buffer[2]);
-    uint16_t humidity = scd40_read_bytes_as_int16(&buffer[4]);
+#define SCD40_DECODE(id, key, label, word, signedness, scale, offset, invalid, unit) \
+    data[SCD40_##id] = channel_decode(&buffer[2 * (word)], signedness, scale, offset, invalid);
+    SCD40_CHANNELS(SCD40_DECODE)
+#undef SCD40_DECODE
 
-    float temp_CF = -14 + (175 * (temp_C) / (pow(2, 16) - 1));
-    float temp_FH = (temp_CF * 1.8) + 32;
+    return NOERR;
+}
 
-    float humidity_F = 100 * ((humidity) / pow(2, 16) - 1);
+int8_t scd40_reinit(int* fd) {
+    //The stop command is ignored if the device is already idle
+    (void)scd40_stop_measurement(fd);
 
-    data[0] = (float)co2_concentration;
-    data[1] = temp_FH;
-    data[2] = humidity_F;
+    return execute(SCD40_REINIT, NULL, fd);
+}
 
-    return NOERR;
+int8_t scd40_calibrate_delays(int* fd) {
+    //Reading the values before a sample is ready is NACKed too, so only the flag is probed
+    return sensirion_calibrate(SCD40_ADDRESS, &scd40_commands[SCD40_READ_DATA_FLAG], 
+                               &tunings[SCD40_READ_DATA_FLAG], fd);
 }
 
+void scd40_read_bus_stats(struct Sensirion_Stats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (int command = 0; command < SCD40_NUM_COMMANDS; ++command) {
+        sensirion_add_stats(stats, &tunings[command]);
+    }
+
+    stats->delay_us = sensirion_delay(&scd40_commands[SCD40_READ_DATA_FLAG], &tunings[SCD40_READ_DATA_FLAG])
+                    + sensirion_delay(&scd40_commands[SCD40_READ_VALUES], &tunings[SCD40_READ_VALUES]);
+}
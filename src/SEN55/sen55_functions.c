@@ -1,223 +1,161 @@
 #include "../../include/SEN55/sen55_functions.h"
 
 /*******************************************************************************
-*                           Function Implementations                           *
+*                                Global Variables                              *
 *******************************************************************************/
 
-int8_t sen55_start_measurement(int* fd) {
-    int8_t error;
-    uint8_t buffer[2];
-    int offset = 0;
+const struct Channel_Descriptor sen55_channels[SEN55_DATAPOINTS] = {
+    SEN55_CHANNELS(CHANNEL_DESCRIPTOR)
+};
 
-    offset = sen55_add_command_to_buffer(buffer, offset, START_MEASUREMENT);
-    error = sen55_device_write(buffer, 2, fd);
+const struct Sensirion_Command sen55_commands[SEN55_NUM_COMMANDS] = {
+    SEN55_COMMANDS(SENSIRION_COMMAND)
+};
 
-    if (error != 0) {
-        return error;
-    }
+//Tuned delays for the commands, the datasheet's until calibrated
+static struct Sensirion_Tuning tunings[SEN55_NUM_COMMANDS];
 
-    usleep(100000);
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
 
-    return NOERR;
+/**
+ * @brief Executes one of the SEN55's commands with its tuned delay
+ *
+ * @param command the command to be executed
+ * @param response the out parameter for the command's response, NULL if it has none
+ * @param fd the opened file descriptor for the I2C device
+ * @return the error from sensirion_execute()
+ */
+static int8_t execute(enum Sen55_Command command, uint8_t* response, int* fd) {
+    return sensirion_execute(SEN55_ADDRESS, &sen55_commands[command], &tunings[command], response, fd);
+}
+
+int8_t sen55_start_measurement(int* fd) {
+    return execute(SEN55_START_MEASUREMENT, NULL, fd);
 }
 
 int8_t sen55_stop_measurement(int* fd) {
-    int8_t error;
-    uint8_t buffer[2];
-    int offset = 0;
+    return execute(SEN55_STOP_MEASUREMENT, NULL, fd);
+}
 
-    offset = sen55_add_command_to_buffer(buffer, offset, STOP_MEASUREMENT);
-    error = sen55_device_write(buffer, 2, fd);
+int8_t sen55_read_data_flag(bool* is_ready, int* fd) {
+    uint8_t response[SENSIRION_WORD_SIZE];
+    int8_t error;
 
-    if (error != 0) {
+    if ((error = execute(SEN55_DATA_READY_FLAG, response, fd)) != NOERR) {
         return error;
     }
 
-    usleep(1000000);
-
+    *is_ready = response[1];
     return NOERR;
 }
 
-int8_t sen55_read_data_flag(bool* is_ready, int* fd) {
-    int error;
-    uint8_t buffer[3];
-    int offset = 0;
-
-    offset = sen55_add_command_to_buffer(buffer, offset, DATA_READY_FLAG);
-    error = sen55_device_write(buffer, 2, fd);
-
-    if (error != 0) {
-        return error;
-    }
+int8_t sen55_read_measurement_state(bool* is_measuring, int* fd) {
+    int8_t error;
+    bool is_ready = false;
 
-    (void)usleep(100000);
+    for (int attempt = 0; attempt < SEN55_PROBE_ATTEMPTS && !is_ready; ++attempt) {
+        if (attempt > 0) {
+            sensirion_wait(SEN55_PROBE_INTERVAL_US - sen55_commands[SEN55_DATA_READY_FLAG].execution_us);
+        }
 
-    error = sen55_read_without_crc(buffer, 2, fd);
-    if (error != 0) {
-        return error;
+        if ((error = sen55_read_data_flag(&is_ready, fd)) != NOERR) {
+            return error;
+        }
     }
 
-    *is_ready = buffer[1];
+    *is_measuring = is_ready;
     return NOERR;
 }
 
 int8_t sen55_read_into_buffer(float* data, size_t buffer_size, int* fd) {
-    const uint16_t INVALID_UINT = 0xFFFF;
-    const int16_t INVALID_INT = 0x7FFF;
-    uint8_t retries = 0;
-    uint8_t buffer[24];
+    uint8_t buffer[SENSIRION_WORD_SIZE * SEN55_DATAPOINTS];
     int8_t error;
-    int offset;
     
     if (buffer_size != SEN55_DATAPOINTS) {
         return SIZE_ERR;
     }
 
-    while (retries < MAX_RETRIES) {
-        offset = 0;
-
-        offset = sen55_add_command_to_buffer(buffer, offset, READ_VALUES);
-        error = sen55_device_write(buffer, 2, fd);
-
-        if (error != 0) {
-            return error;
-        }
-
-        (void)usleep(20000);
-
-        if ((error = sen55_read_without_crc(buffer, 16, fd)) == CRC_ERR) {
-            ++retries;
-            continue;
-        }
-        
-        break;
-    }
-
-    if (error != 0) {
+    if ((error = execute(SEN55_READ_VALUES, buffer, fd)) != NOERR) {
         return error;
     }
 
-    uint16_t mass_concentration_1_uint16 = sen55_read_bytes_as_uint16(&buffer[0]);
-    uint16_t mass_concentration_2_5_uint16 = sen55_read_bytes_as_uint16(&buffer[2]);
-    uint16_t mass_concentration_4_uint16 = sen55_read_bytes_as_uint16(&buffer[4]);
-    uint16_t mass_concentration_10_uint16 = sen55_read_bytes_as_uint16(&buffer[6]);
-    int16_t humidity_uint16 = sen55_read_bytes_as_int16(&buffer[8]);
-    int16_t temperature_int16 = sen55_read_bytes_as_int16(&buffer[10]);
-    int16_t VOC_uint16 = sen55_read_bytes_as_int16(&buffer[12]);
-    int16_t NOx_uint16 = sen55_read_bytes_as_int16(&buffer[14]);
-
-    data[0] = mass_concentration_1_uint16 == INVALID_UINT 
-                                        ? NAN 
-                                        : mass_concentration_1_uint16 / 10.0F;
-    data[1] = mass_concentration_2_5_uint16 == INVALID_UINT 
-                                        ? NAN 
-                                        : mass_concentration_2_5_uint16 / 10.0F;
-    data[2] = mass_concentration_4_uint16 == INVALID_UINT 
-                                        ? NAN 
-                                        : mass_concentration_4_uint16 / 10.0F;
-    data[3] = mass_concentration_10_uint16 == INVALID_UINT  
-                                        ? NAN 
-                                        : mass_concentration_10_uint16 / 10.0F;
-    data[4] = humidity_uint16 == INVALID_INT 
-                            ? NAN 
-                            : humidity_uint16 / 100.0F;
-    data[5] = temperature_int16 == INVALID_INT 
-                            ? NAN 
-                            : ((temperature_int16 / 200.0F) * 1.8F) + 32;
-    data[6] = VOC_uint16 == INVALID_INT 
-                        ? NAN 
-                        : VOC_uint16 / 10.0F;
-    data[7] = NOx_uint16 == INVALID_INT 
-                        ? NAN 
-                        : NOx_uint16 / 10.0F;
+    //Unrolled from the channel table so every scale and marker is a constant
+#define SEN55_DECODE(id, key, label, word, signedness, scale, offset, invalid, unit) \
+    data[SEN55_##id] = channel_decode(&buffer[2 * (word)], signedness, scale, offset, invalid);
+    SEN55_CHANNELS(SEN55_DECODE)
+#undef SEN55_DECODE
 
     return NOERR;
 }
 
-int8_t sen55_read_product_name(char* name, size_t name_length, int* fd) {
+/**
+ * @brief Reads a command's response as a string
+ * 
+ * @param command the command to be executed
+ * @param string the out parameter for the string
+ * @param length the size of the string, MUST BE 32 CHARACTERS
+ * @return an error if the device couldn't be written to or read from, else NOERROR is returned
+ */
+static int8_t read_string(enum Sen55_Command command, char* string, size_t length, int* fd) {
+    uint8_t buffer[MAX_NAME_CHARS];
     int8_t error;
-    uint8_t buffer[48];
-    int offset = 0;
 
-    if (name_length != MAX_NAME_CHARS) {
+    if (length != MAX_NAME_CHARS) {
         return SIZE_ERR;
     }
 
-    offset = sen55_add_command_to_buffer(buffer, offset, READ_NAME);
-    error = sen55_device_write(buffer, 2, fd);
-
-    if (error != 0) {
+    if ((error = execute(command, buffer, fd)) != NOERR) {
         return error;
     }
 
-    (void)usleep(20000);
+    strncpy(string, (char*)buffer, length);
+    return NOERR;
+}
 
-    error = sen55_read_bytes_as_string(buffer, 32, name, fd);
-    
-    return error != 0 ? error : NOERR;
+int8_t sen55_read_product_name(char* name, size_t name_length, int* fd) {
+    return read_string(SEN55_READ_NAME, name, name_length, fd);
 }
 
 int8_t sen55_read_serial_number(char* serial_number, size_t number_length, int* fd) {
-    int8_t error;
-    uint8_t buffer[48];
-    int offset = 0;
-
-    if (number_length != MAX_NAME_CHARS) {
-        return SIZE_ERR;
-    }
-
-    offset = sen55_add_command_to_buffer(buffer, offset, READ_SERIAL_NUMBER);
-    error = sen55_device_write(buffer, 2, fd);
-
-    if (error != 0) {
-        return error;
-    }
-
-    (void)usleep(20000);
-
-    error = sen55_read_bytes_as_string(buffer, 32, serial_number, fd);
-
-    return error != 0 ? error : NOERR;
+    return read_string(SEN55_READ_SERIAL_NUMBER, serial_number, number_length, fd);
 }
 
 int8_t sen55_read_firmware(uint8_t* firmware_version, int* fd) {
+    uint8_t response[SENSIRION_WORD_SIZE];
     int8_t error;
-    uint8_t buffer[3];
-    int offset = 0;
-
-    offset = sen55_add_command_to_buffer(buffer, offset, READ_FIRMWARE);
-    error = sen55_device_write(buffer, 2, fd);
 
-    if (error != 0) {
+    if ((error = execute(SEN55_READ_FIRMWARE, response, fd)) != NOERR) {
         return error;
     }
 
-    (void)usleep(20000);
-
-    error = sen55_read_without_crc(buffer, 2, fd);
-
-    if (error != 0) {
-        return error;
-    }
-
-    *firmware_version = buffer[0];
-
+    *firmware_version = response[0];
     return NOERR;
 }
 
 int8_t sen55_reset(int* fd) {
-    int8_t error;
-    uint8_t buffer[2];
-    int offset = 0;
+    return execute(SEN55_RESET, NULL, fd);
+}
 
-    offset = sen55_add_command_to_buffer(buffer, offset, RESET);
-    error = sen55_device_write(buffer, 2, fd);
+int8_t sen55_calibrate_delays(int* fd) {
+    int8_t error;
 
-    if (error != 0) {
+    if ((error = sensirion_calibrate(SEN55_ADDRESS, &sen55_commands[SEN55_DATA_READY_FLAG], 
+                                     &tunings[SEN55_DATA_READY_FLAG], fd)) != NOERR) {
         return error;
     }
 
-    (void)usleep(200000);
+    return sensirion_calibrate(SEN55_ADDRESS, &sen55_commands[SEN55_READ_VALUES], 
+                               &tunings[SEN55_READ_VALUES], fd);
+}
+
+void sen55_read_bus_stats(struct Sensirion_Stats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (int command = 0; command < SEN55_NUM_COMMANDS; ++command) {
+        sensirion_add_stats(stats, &tunings[command]);
+    }
 
-    return NOERR;
-}
\ No newline at end of file
+    stats->delay_us = sensirion_delay(&sen55_commands[SEN55_DATA_READY_FLAG], &tunings[SEN55_DATA_READY_FLAG])
+                    + sensirion_delay(&sen55_commands[SEN55_READ_VALUES], &tunings[SEN55_READ_VALUES]);
+}
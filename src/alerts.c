@@ -0,0 +1,356 @@
+#include "../include/alerts.h"
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief The state of the recursive-descent compiler
+ */
+struct Compiler {
+    const char* next;
+    struct Alert_Rule* rule;
+    int depth;
+    int max_depth;
+    bool failed;
+};
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+static void skip_space(struct Compiler* compiler) {
+    while (isspace((unsigned char)*compiler->next)) {
+        ++compiler->next;
+    }
+}
+
+/**
+ * @brief Consumes the token if it is next
+ *
+ * @param compiler the compiler
+ * @param token the token
+ * @return whether the token was consumed
+ */
+static bool accept(struct Compiler* compiler, const char* token) {
+    skip_space(compiler);
+
+    if (strncmp(compiler->next, token, strlen(token)) != 0) {
+        return false;
+    }
+
+    compiler->next += strlen(token);
+    return true;
+}
+
+/**
+ * @brief Appends an instruction, tracking how deep the stack gets
+ *
+ * @param compiler the compiler
+ * @param instruction the instruction
+ * @param pushed the instruction's change to the stack depth
+ */
+static void emit(struct Compiler* compiler, struct Alert_Instruction instruction, int pushed) {
+    if (compiler->rule->num_code == ALERT_MAX_CODE) {
+        compiler->failed = true;
+        return;
+    }
+
+    compiler->rule->code[compiler->rule->num_code++] = instruction;
+    compiler->depth += pushed;
+    if (compiler->depth > compiler->max_depth) {
+        compiler->max_depth = compiler->depth;
+    }
+}
+
+static void emit_op(struct Compiler* compiler, enum Alert_Op op, int pushed) {
+    emit(compiler, (struct Alert_Instruction){.op = op}, pushed);
+}
+
+/**
+ * @brief Compiles a DEVICE.channel reference
+ *
+ * @param compiler the compiler
+ * @param op ALERT_LOAD or ALERT_DELTA
+ */
+static void reference(struct Compiler* compiler, enum Alert_Op op) {
+    size_t length = 0;
+    uint8_t device_addr;
+    int channel;
+
+    skip_space(compiler);
+    while (isalnum((unsigned char)compiler->next[length]) || compiler->next[length] == '_'
+           || compiler->next[length] == '.') {
+        ++length;
+    }
+
+    if (!channel_parse(compiler->next, length, &device_addr, &channel)) {
+        compiler->failed = true;
+        return;
+    }
+
+    compiler->next += length;
+    emit(compiler, (struct Alert_Instruction){op, device_addr, (uint8_t)channel, 0}, 1);
+}
+
+static void expression(struct Compiler* compiler);
+
+static void primary(struct Compiler* compiler) {
+    char* end;
+    float number;
+
+    skip_space(compiler);
+
+    if (accept(compiler, "(")) {
+        expression(compiler);
+        compiler->failed |= !accept(compiler, ")");
+    } else if (accept(compiler, "delta(")) {
+        reference(compiler, ALERT_DELTA);
+        compiler->failed |= !accept(compiler, ")");
+    } else if (isdigit((unsigned char)*compiler->next) || *compiler->next == '.') {
+        number = strtof(compiler->next, &end);
+        compiler->next = end;
+        emit(compiler, (struct Alert_Instruction){.op = ALERT_CONST, .value = number}, 1);
+    } else {
+        reference(compiler, ALERT_LOAD);
+    }
+}
+
+static void unary(struct Compiler* compiler) {
+    if (accept(compiler, "-")) {
+        unary(compiler);
+        emit_op(compiler, ALERT_NEG, 0);
+    } else if (accept(compiler, "!")) {
+        unary(compiler);
+        emit_op(compiler, ALERT_NOT, 0);
+    } else {
+        primary(compiler);
+    }
+}
+
+static void term(struct Compiler* compiler) {
+    unary(compiler);
+
+    while (!compiler->failed) {
+        if (accept(compiler, "*")) {
+            unary(compiler);
+            emit_op(compiler, ALERT_MUL, -1);
+        } else if (accept(compiler, "/")) {
+            unary(compiler);
+            emit_op(compiler, ALERT_DIV, -1);
+        } else {
+            return;
+        }
+    }
+}
+
+static void sum(struct Compiler* compiler) {
+    term(compiler);
+
+    while (!compiler->failed) {
+        if (accept(compiler, "+")) {
+            term(compiler);
+            emit_op(compiler, ALERT_ADD, -1);
+        } else if (accept(compiler, "-")) {
+            term(compiler);
+            emit_op(compiler, ALERT_SUB, -1);
+        } else {
+            return;
+        }
+    }
+}
+
+static void comparison(struct Compiler* compiler) {
+    //Two character operators are tried first so "<=" isn't read as "<"
+    static const struct {
+        const char* token;
+        enum Alert_Op op;
+    } OPERATORS[] = {
+        {"<=", ALERT_LE}, {">=", ALERT_GE}, {"==", ALERT_EQ}, {"!=", ALERT_NE},
+        {"<", ALERT_LT}, {">", ALERT_GT},
+    };
+
+    sum(compiler);
+
+    for (size_t i = 0; i < sizeof(OPERATORS) / sizeof(OPERATORS[0]); ++i) {
+        if (accept(compiler, OPERATORS[i].token)) {
+            sum(compiler);
+            emit_op(compiler, OPERATORS[i].op, -1);
+            return;
+        }
+    }
+}
+
+static void conjunction(struct Compiler* compiler) {
+    comparison(compiler);
+
+    while (!compiler->failed && accept(compiler, "&&")) {
+        comparison(compiler);
+        emit_op(compiler, ALERT_AND, -1);
+    }
+}
+
+static void expression(struct Compiler* compiler) {
+    conjunction(compiler);
+
+    while (!compiler->failed && accept(compiler, "||")) {
+        conjunction(compiler);
+        emit_op(compiler, ALERT_OR, -1);
+    }
+}
+
+int8_t alert_compile(const char* source, struct Alert_Rule* rule) {
+    struct Compiler compiler = {.rule = rule};
+    const char* colon = strchr(source, ':');
+    size_t length;
+
+    memset(rule, 0, sizeof(*rule));
+
+    if (colon == NULL) {
+        return CONFIG_ERR;
+    }
+
+    //The name ends up in the alert's JSON, so it is kept to a plain identifier
+    length = (size_t)(colon - source);
+    while (length > 0 && isspace((unsigned char)source[length - 1])) {
+        --length;
+    }
+
+    if (length == 0 || length >= ALERT_NAME_SIZE) {
+        return CONFIG_ERR;
+    }
+
+    for (size_t i = 0; i < length; ++i) {
+        if (!isalnum((unsigned char)source[i]) && source[i] != '_') {
+            return CONFIG_ERR;
+        }
+    }
+    memcpy(rule->name, source, length);
+
+    compiler.next = colon + 1;
+    expression(&compiler);
+    skip_space(&compiler);
+
+    if (compiler.failed || *compiler.next != '\0' || compiler.max_depth > ALERT_MAX_STACK) {
+        return CONFIG_ERR;
+    }
+
+    return NOERR;
+}
+
+/**
+ * @brief Finds the device's slot in the engine
+ *
+ * @param engine the engine
+ * @param device_addr the device's hex address on the I2C bus
+ * @return the slot or -1 if the device hasn't delivered a sample
+ */
+static int find_device(const struct Alert_Engine* engine, uint8_t device_addr) {
+    for (int i = 0; i < engine->num_devices; ++i) {
+        if (engine->device_addrs[i] == device_addr) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static bool truthy(float value) {
+    return value != 0 && !isnan(value);
+}
+
+float alert_evaluate(const struct Alert_Engine* engine, const struct Alert_Rule* rule) {
+    float stack[ALERT_MAX_STACK];
+    int top = -1;
+
+    for (int i = 0; i < rule->num_code; ++i) {
+        const struct Alert_Instruction* instruction = &rule->code[i];
+        float right = top >= 0 ? stack[top] : NAN;
+        int device;
+
+        switch (instruction->op) {
+            case ALERT_CONST:
+                stack[++top] = instruction->value;
+                continue;
+            case ALERT_LOAD:
+            case ALERT_DELTA:
+                device = find_device(engine, instruction->device_addr);
+                stack[++top] = device < 0 ? NAN : engine->latest[device][instruction->channel];
+
+                if (instruction->op == ALERT_DELTA) {
+                    stack[top] = device < 0 || !engine->has_previous[device] ? NAN
+                        : stack[top] - engine->previous[device][instruction->channel];
+                }
+                continue;
+            case ALERT_NEG:
+                stack[top] = -right;
+                continue;
+            case ALERT_NOT:
+                stack[top] = !truthy(right);
+                continue;
+            default:
+                break;
+        }
+
+        //Every other operator pops two operands and pushes the result
+        float left = stack[--top];
+        switch (instruction->op) {
+            case ALERT_ADD: stack[top] = left + right; break;
+            case ALERT_SUB: stack[top] = left - right; break;
+            case ALERT_MUL: stack[top] = left * right; break;
+            case ALERT_DIV: stack[top] = left / right; break;
+            case ALERT_LT: stack[top] = left < right; break;
+            case ALERT_LE: stack[top] = left <= right; break;
+            case ALERT_GT: stack[top] = left > right; break;
+            case ALERT_GE: stack[top] = left >= right; break;
+            case ALERT_EQ: stack[top] = left == right; break;
+            case ALERT_NE: stack[top] = left != right && !isnan(left) && !isnan(right); break;
+            case ALERT_AND: stack[top] = truthy(left) && truthy(right); break;
+            case ALERT_OR: stack[top] = truthy(left) || truthy(right); break;
+            default: stack[top] = NAN; break;
+        }
+    }
+
+    return top == 0 ? stack[0] : NAN;
+}
+
+void alert_engine_init(struct Alert_Engine* engine, const struct Alert_Rule* rules, int num_rules) {
+    memset(engine, 0, sizeof(*engine));
+    engine->rules = rules;
+    engine->num_rules = num_rules < ALERT_MAX_RULES ? num_rules : ALERT_MAX_RULES;
+}
+
+int alert_engine_update(struct Alert_Engine* engine, const struct Sensor_Data* sample,
+                        struct Alert_Event* events) {
+    int device = find_device(engine, sample->device_addr);
+    int num_events = 0;
+
+    if (device < 0) {
+        if (engine->num_devices == ALERT_MAX_DEVICES) {
+            return 0;
+        }
+
+        device = engine->num_devices++;
+        engine->device_addrs[device] = sample->device_addr;
+    } else {
+        memcpy(engine->previous[device], engine->latest[device], sizeof(engine->latest[device]));
+        engine->has_previous[device] = true;
+    }
+
+    for (int j = 0; j < MAX_DATAPOINTS; ++j) {
+        engine->latest[device][j] = j < sample->num_data ? sample->data[j] : NAN;
+    }
+
+    //Only a change of state is reported, so a rule that stays true fires once
+    for (int i = 0; i < engine->num_rules; ++i) {
+        float value = alert_evaluate(engine, &engine->rules[i]);
+        bool active = truthy(value);
+
+        if (active != engine->active[i]) {
+            engine->active[i] = active;
+            events[num_events++] = (struct Alert_Event){&engine->rules[i], active, value};
+        }
+    }
+
+    return num_events;
+}
@@ -0,0 +1,42 @@
+#include "../include/alloc_count.h"
+
+/*******************************************************************************
+*                                Global Variables                              *
+*******************************************************************************/
+
+static atomic_uint_fast64_t allocations = 0;
+static atomic_uint_fast64_t frees = 0;
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+void* __wrap_malloc(size_t size) {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    atomic_fetch_add_explicit(&allocations, 1, memory_order_relaxed);
+    return __real_realloc(pointer, size);
+}
+
+void __wrap_free(void* pointer) {
+    if (pointer != NULL) {
+        atomic_fetch_add_explicit(&frees, 1, memory_order_relaxed);
+    }
+    __real_free(pointer);
+}
+
+uint64_t alloc_count_total(void) {
+    return atomic_load_explicit(&allocations, memory_order_relaxed);
+}
+
+uint64_t alloc_count_frees(void) {
+    return atomic_load_explicit(&frees, memory_order_relaxed);
+}
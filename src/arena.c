@@ -0,0 +1,49 @@
+#include "../include/arena.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+int8_t arena_init(struct Arena* arena, size_t size) {
+    arena->used = 0;
+    arena->high_water = 0;
+    arena->exhausted = 0;
+    arena->overflowed = false;
+
+    if ((arena->base = malloc(size)) == NULL) {
+        arena->size = 0;
+        return SIZE_ERR;
+    }
+
+    arena->size = size;
+    return NOERR;
+}
+
+void* arena_alloc(struct Arena* arena, size_t size) {
+    size_t start = (arena->used + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    if (start > arena->size || size > arena->size - start) {
+        ++arena->exhausted;
+        arena->overflowed = true;
+        return NULL;
+    }
+
+    arena->used = start + size;
+    if (arena->used > arena->high_water) {
+        arena->high_water = arena->used;
+    }
+
+    return arena->base + start;
+}
+
+void arena_reset(struct Arena* arena) {
+    arena->used = 0;
+    arena->overflowed = false;
+}
+
+void arena_free(struct Arena* arena) {
+    free(arena->base);
+    arena->base = NULL;
+    arena->size = 0;
+    arena->used = 0;
+}
@@ -0,0 +1,57 @@
+#include "../include/backlog.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+void backlog_init(struct Backlog* backlog) {
+    backlog->head = 0;
+    backlog->count = 0;
+    backlog->sent = 0;
+    backlog->dropped = 0;
+}
+
+bool backlog_push(struct Backlog* backlog, const struct Joined_Record* record) {
+    bool evicted = backlog->count == BACKLOG_SIZE;
+
+    if (evicted) {
+        backlog_pop(backlog);
+        ++backlog->dropped;
+    }
+
+    backlog->records[(backlog->head + backlog->count) % BACKLOG_SIZE] = *record;
+    ++backlog->count;
+
+    return evicted;
+}
+
+const struct Joined_Record* backlog_peek(const struct Backlog* backlog) {
+    return backlog->count > 0 ? &backlog->records[backlog->head] : NULL;
+}
+
+void backlog_pop(struct Backlog* backlog) {
+    if (backlog->count == 0) {
+        return;
+    }
+
+    backlog->head = (backlog->head + 1) % BACKLOG_SIZE;
+    --backlog->count;
+    if (backlog->sent > 0) {
+        --backlog->sent;
+    }
+}
+
+const struct Joined_Record* backlog_next(const struct Backlog* backlog) {
+    return backlog->sent < backlog->count
+        ? &backlog->records[(backlog->head + backlog->sent) % BACKLOG_SIZE] : NULL;
+}
+
+void backlog_sent(struct Backlog* backlog) {
+    if (backlog->sent < backlog->count) {
+        ++backlog->sent;
+    }
+}
+
+void backlog_resend(struct Backlog* backlog) {
+    backlog->sent = 0;
+}
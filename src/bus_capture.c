@@ -0,0 +1,180 @@
+#include "../include/bus_capture.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Gets the size of a capture file with the given capacity
+ *
+ * @param capacity the number of records
+ * @return the size in bytes
+ */
+static size_t capture_size(uint32_t capacity) {
+    return sizeof(struct Bus_Capture_Header) + (size_t)capacity * sizeof(struct Bus_Capture_Record);
+}
+
+/**
+ * @brief Points the capture at the mapped file and starts the replay from its oldest record
+ *
+ * @param capture the capture
+ * @param map the mapped file
+ * @param size the size of the mapping
+ */
+static void capture_attach(struct Bus_Capture* capture, void* map, size_t size) {
+    uint64_t claimed;
+
+    capture->header = map;
+    capture->records = (struct Bus_Capture_Record*)((uint8_t*)map + sizeof(struct Bus_Capture_Header));
+    capture->size = size;
+
+    claimed = atomic_load_explicit(&capture->header->claimed, memory_order_acquire);
+    capture->end = claimed;
+    capture->first = claimed > capture->header->capacity ? claimed - capture->header->capacity : 0;
+    bus_capture_rewind(capture);
+}
+
+int8_t bus_capture_create(struct Bus_Capture* capture, const char* path, uint32_t capacity) {
+    size_t size = capture_size(capacity);
+    void* map;
+    int fd;
+
+    memset(capture, 0, sizeof(*capture));
+    if (capacity == 0) {
+        return SIZE_ERR;
+    }
+
+    if ((fd = open(path, O_CREAT | O_RDWR | O_TRUNC, 0644)) < 0) {
+        return INIT_ERR;
+    }
+
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return INIT_ERR;
+    }
+
+    map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        return INIT_ERR;
+    }
+
+    //The truncated file is zeroed, so only the header has to be filled in
+    struct Bus_Capture_Header* header = map;
+    header->magic = BUS_CAPTURE_MAGIC;
+    header->version = BUS_CAPTURE_VERSION;
+    header->record_size = sizeof(struct Bus_Capture_Record);
+    header->capacity = capacity;
+
+    capture_attach(capture, map, size);
+    return NOERR;
+}
+
+int8_t bus_capture_open(struct Bus_Capture* capture, const char* path) {
+    struct Bus_Capture_Header header;
+    struct stat status;
+    void* map;
+    int fd;
+
+    memset(capture, 0, sizeof(*capture));
+    if ((fd = open(path, O_RDONLY)) < 0) {
+        return INIT_ERR;
+    }
+
+    if (fstat(fd, &status) != 0 || read(fd, &header, sizeof(header)) != sizeof(header)) {
+        close(fd);
+        return INIT_ERR;
+    }
+
+    if (header.magic != BUS_CAPTURE_MAGIC || header.version != BUS_CAPTURE_VERSION
+        || header.record_size != sizeof(struct Bus_Capture_Record) || header.capacity == 0
+        || (size_t)status.st_size < capture_size(header.capacity)) {
+        close(fd);
+        return SIZE_ERR;
+    }
+
+    //Private so the replay never writes back to the capture
+    map = mmap(NULL, capture_size(header.capacity), PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        return INIT_ERR;
+    }
+
+    capture_attach(capture, map, capture_size(header.capacity));
+    return NOERR;
+}
+
+void bus_capture_close(struct Bus_Capture* capture) {
+    if (capture->header == NULL) {
+        return;
+    }
+
+    munmap(capture->header, capture->size);
+    memset(capture, 0, sizeof(*capture));
+}
+
+void bus_capture_add(struct Bus_Capture* capture, uint8_t address, enum Bus_Direction direction,
+                     const uint8_t* data, uint16_t count, int8_t result) {
+    uint64_t position = atomic_fetch_add_explicit(&capture->header->claimed, 1, memory_order_relaxed);
+    struct Bus_Capture_Record* record = &capture->records[position % capture->header->capacity];
+    uint16_t kept = direction == BUS_READ && result != NOERR ? 0 : count;
+
+    if (kept > BUS_CAPTURE_MAX_BYTES) {
+        kept = BUS_CAPTURE_MAX_BYTES;
+    }
+
+    //Marks the slot as being written before its old contents change
+    atomic_store_explicit(&record->sequence, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    record->monotonic_us = clock_source_now_us();
+    record->address = address;
+    record->direction = (uint8_t)direction;
+    record->result = result;
+    record->count = (uint8_t)(count < UINT8_MAX ? count : UINT8_MAX);
+    memcpy(record->data, data, kept);
+
+    atomic_store_explicit(&record->sequence, (uint32_t)(position + 1), memory_order_release);
+}
+
+const struct Bus_Capture_Record* bus_capture_next(struct Bus_Capture* capture, uint8_t address,
+                                                  enum Bus_Direction direction) {
+    uint64_t* cursor = &capture->cursors[address % BUS_CAPTURE_ADDRESSES];
+
+    for (; *cursor < capture->end; ++*cursor) {
+        const struct Bus_Capture_Record* record = &capture->records[*cursor % capture->header->capacity];
+
+        //Skips records that were still being written when the capture stopped
+        if (record->address != address
+            || atomic_load_explicit(&record->sequence, memory_order_acquire) != (uint32_t)(*cursor + 1)) {
+            continue;
+        }
+
+        ++*cursor;
+        return record->direction == direction ? record : NULL;
+    }
+
+    return NULL;
+}
+
+bool bus_capture_done(struct Bus_Capture* capture, uint8_t address) {
+    uint64_t* cursor = &capture->cursors[address % BUS_CAPTURE_ADDRESSES];
+
+    while (*cursor < capture->end && capture->records[*cursor % capture->header->capacity].address != address) {
+        ++*cursor;
+    }
+
+    return *cursor >= capture->end;
+}
+
+void bus_capture_rewind(struct Bus_Capture* capture) {
+    for (int i = 0; i < BUS_CAPTURE_ADDRESSES; ++i) {
+        capture->cursors[i] = capture->first;
+    }
+}
+
+uint64_t bus_capture_count(const struct Bus_Capture* capture) {
+    return capture->end - capture->first;
+}
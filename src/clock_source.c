@@ -0,0 +1,115 @@
+#include "../include/clock_source.h"
+
+/*******************************************************************************
+*                                Global Variables                              *
+*******************************************************************************/
+
+static _Atomic bool virtual_clock = false;
+static _Atomic uint64_t virtual_ns = CLOCK_SOURCE_VIRTUAL_START_NS;
+static uint64_t virtual_epoch_ns = 0;
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+void clock_source_use_virtual(uint64_t realtime_ns) {
+    virtual_epoch_ns = realtime_ns - CLOCK_SOURCE_VIRTUAL_START_NS;
+    atomic_store(&virtual_ns, CLOCK_SOURCE_VIRTUAL_START_NS);
+    atomic_store(&virtual_clock, true);
+}
+
+void clock_source_use_real(void) {
+    atomic_store(&virtual_clock, false);
+}
+
+bool clock_source_is_virtual(void) {
+    return atomic_load_explicit(&virtual_clock, memory_order_relaxed);
+}
+
+void clock_source_now(clockid_t clock, struct timespec* now) {
+    uint64_t time_ns;
+
+    if (!clock_source_is_virtual()) {
+        clock_gettime(clock, now);
+        return;
+    }
+
+    time_ns = atomic_load_explicit(&virtual_ns, memory_order_relaxed);
+    if (clock == CLOCK_REALTIME) {
+        time_ns += virtual_epoch_ns;
+    }
+
+    now->tv_sec = (time_t)(time_ns / 1000000000);
+    now->tv_nsec = (long)(time_ns % 1000000000);
+}
+
+uint64_t clock_source_now_us(void) {
+    struct timespec now;
+
+    clock_source_now(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+}
+
+void clock_source_sleep_us(uint64_t delay_us) {
+    if (clock_source_is_virtual()) {
+        atomic_fetch_add_explicit(&virtual_ns, delay_us * 1000, memory_order_relaxed);
+        return;
+    }
+
+    (void)usleep((useconds_t)delay_us);
+}
+
+void clock_source_advance_to(uint64_t monotonic_ns) {
+    uint64_t current = atomic_load_explicit(&virtual_ns, memory_order_relaxed);
+
+    if (!clock_source_is_virtual()) {
+        return;
+    }
+
+    //Another thread may advance it first, the clock never goes back
+    while (current < monotonic_ns
+           && !atomic_compare_exchange_weak_explicit(&virtual_ns, &current, monotonic_ns,
+                                                     memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Gets the current monotonic time in nanoseconds
+ *
+ * @return the current monotonic time in nanoseconds
+ */
+static uint64_t now_ns(void) {
+    struct timespec now;
+
+    clock_source_now(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+void clock_timer_start(struct Clock_Timer* timer, uint64_t period_us) {
+    timer->period_ns = period_us * 1000;
+    timer->next_ns = now_ns() + timer->period_ns;
+}
+
+uint64_t clock_timer_wait(struct Clock_Timer* timer) {
+    uint64_t now = now_ns();
+    uint64_t expirations;
+
+    if (now < timer->next_ns) {
+        if (clock_source_is_virtual()) {
+            clock_source_advance_to(timer->next_ns);
+        } else {
+            struct timespec next = {
+                .tv_sec = (time_t)(timer->next_ns / 1000000000),
+                .tv_nsec = (long)(timer->next_ns % 1000000000),
+            };
+
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) {
+            }
+        }
+        now = timer->next_ns;
+    }
+
+    expirations = (now - timer->next_ns) / timer->period_ns + 1;
+    timer->next_ns += expirations * timer->period_ns;
+    return expirations;
+}
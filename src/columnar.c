@@ -0,0 +1,648 @@
+#include "../include/columnar.h"
+
+/*******************************************************************************
+*                              Defined Constants                               *
+*******************************************************************************/
+
+#define MAX_VARINT 10
+#define MAX_CHUNK (COLUMNAR_ROW_GROUP * MAX_VARINT)
+#define CHUNK_HEADER 5
+#define MAX_GROUP (4 + (1 + MAX_DATAPOINTS) * (CHUNK_HEADER + MAX_CHUNK))
+#define MAX_FOOTER (2 + MAX_DATAPOINTS * COLUMNAR_NAME_SIZE + 4 \
+                    + COLUMNAR_MAX_GROUPS * (28 + MAX_DATAPOINTS * 12))
+#define MAX_SUFFIX 100
+
+/*******************************************************************************
+*                                Global Variables                              *
+*******************************************************************************/
+
+//The writers are only used from the main loop so they share one encoding buffer
+//instead of allocating one per row group
+static uint8_t write_buffer[MAX_GROUP > MAX_FOOTER + 8 ? MAX_GROUP : MAX_FOOTER + 8];
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+static uint8_t* put_u32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        *out++ = (uint8_t)(value >> (8 * i));
+    }
+    return out;
+}
+
+static uint8_t* put_u64(uint8_t* out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        *out++ = (uint8_t)(value >> (8 * i));
+    }
+    return out;
+}
+
+static uint8_t* put_float(uint8_t* out, float value) {
+    uint32_t bits;
+
+    memcpy(&bits, &value, sizeof(bits));
+    return put_u32(out, bits);
+}
+
+static uint32_t get_u32(const uint8_t* in) {
+    uint32_t value = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        value |= (uint32_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+static uint64_t get_u64(const uint8_t* in) {
+    uint64_t value = 0;
+
+    for (int i = 0; i < 8; ++i) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+static float get_float(const uint8_t* in) {
+    uint32_t bits = get_u32(in);
+    float value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Writes the value as a LEB128 varint, 7 bits per byte
+ *
+ * @param out where the varint is written, MUST HOLD MAX_VARINT
+ * @param value the value to be written
+ * @return the byte after the varint
+ */
+static uint8_t* put_varint(uint8_t* out, uint64_t value) {
+    while (value >= 0x80) {
+        *out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = (uint8_t)value;
+
+    return out;
+}
+
+/**
+ * @brief Reads a LEB128 varint
+ *
+ * @param in the varint's first byte, moved past the varint
+ * @param end the end of the buffer
+ * @param value the out parameter for the value
+ * @return whether a whole varint was read
+ */
+static bool get_varint(const uint8_t** in, const uint8_t* end, uint64_t* value) {
+    *value = 0;
+
+    for (int shift = 0; *in < end && shift < 64; shift += 7) {
+        uint8_t byte = *(*in)++;
+
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//Maps small negative numbers to small positive ones so they stay short as varints
+static uint64_t zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/**
+ * @brief Encodes the timestamps as the first timestamp, the first delta and then
+ *          the change in each delta, which is 0 for a steady sampling period
+ *
+ * @param out where the column's values are written, MUST HOLD MAX_CHUNK
+ * @param timestamps the timestamps in wall-clock milliseconds
+ * @param num_rows the number of timestamps
+ * @return the byte after the column
+ */
+static uint8_t* encode_timestamps(uint8_t* out, const uint64_t* timestamps, uint32_t num_rows) {
+    int64_t delta = 0;
+
+    for (uint32_t i = 0; i < num_rows; ++i) {
+        if (i == 0) {
+            out = put_varint(out, timestamps[0]);
+        } else {
+            int64_t next = (int64_t)(timestamps[i] - timestamps[i - 1]);
+
+            out = put_varint(out, zigzag(next - delta));
+            delta = next;
+        }
+    }
+
+    return out;
+}
+
+static bool decode_timestamps(const uint8_t* in, const uint8_t* end, uint64_t* timestamps,
+                              uint32_t num_rows) {
+    int64_t delta = 0;
+    uint64_t value;
+
+    for (uint32_t i = 0; i < num_rows; ++i) {
+        if (!get_varint(&in, end, &value)) {
+            return false;
+        }
+
+        if (i == 0) {
+            timestamps[0] = value;
+        } else {
+            delta += unzigzag(value);
+            timestamps[i] = timestamps[i - 1] + (uint64_t)delta;
+        }
+    }
+
+    return in == end;
+}
+
+/**
+ * @brief Encodes each float's bits XORed with the previous float's bits
+ *
+ * Slowly changing readings share their sign, exponent and upper mantissa, so the
+ * XOR is a small number and a repeated reading is a single zero byte
+ *
+ * @param out where the column's values are written, MUST HOLD MAX_CHUNK
+ * @param values the channel's values
+ * @param num_rows the number of values
+ * @return the byte after the column
+ */
+static uint8_t* encode_floats(uint8_t* out, const float* values, uint32_t num_rows) {
+    uint32_t previous = 0;
+
+    for (uint32_t i = 0; i < num_rows; ++i) {
+        uint32_t bits;
+
+        memcpy(&bits, &values[i], sizeof(bits));
+        out = put_varint(out, bits ^ previous);
+        previous = bits;
+    }
+
+    return out;
+}
+
+static bool decode_floats(const uint8_t* in, const uint8_t* end, float* values, uint32_t num_rows) {
+    uint32_t previous = 0;
+    uint64_t value;
+
+    for (uint32_t i = 0; i < num_rows; ++i) {
+        if (!get_varint(&in, end, &value) || value > UINT32_MAX) {
+            return false;
+        }
+
+        previous ^= (uint32_t)value;
+        memcpy(&values[i], &previous, sizeof(previous));
+    }
+
+    return in == end;
+}
+
+/**
+ * @brief Writes a column's header in front of its already encoded values
+ *
+ * @param chunk the start of the column, CHUNK_HEADER bytes before its values
+ * @param end the byte after the column's values
+ * @param encoding how the values are encoded
+ * @return the byte after the column
+ */
+static uint8_t* finish_chunk(uint8_t* chunk, uint8_t* end, enum Column_Encoding encoding) {
+    chunk[0] = (uint8_t)encoding;
+    put_u32(chunk + 1, (uint32_t)(end - chunk - CHUNK_HEADER));
+
+    return end;
+}
+
+/**
+ * @brief Encodes the buffered rows as a row group, appends it to the file and adds
+ *          its statistics to the footer
+ *
+ * @param writer the device's writer
+ * @return WRITE_ERR if the row group couldn't be written, NOERR otherwise
+ */
+static int8_t write_group(struct Column_Writer* writer) {
+    struct Column_Footer* footer = &writer->footer;
+    struct Row_Group_Info* info = &footer->groups[footer->num_groups];
+    uint8_t* buffer = write_buffer;
+    uint8_t* out;
+    long offset;
+    int8_t result = NOERR;
+
+    if (writer->num_rows == 0) {
+        return NOERR;
+    }
+
+    if ((offset = ftell(writer->file)) < 0) {
+        writer->num_rows = 0;
+        return WRITE_ERR;
+    }
+
+    info->offset = (uint64_t)offset;
+    info->num_rows = writer->num_rows;
+    info->timestamp_min = UINT64_MAX;
+    info->timestamp_max = 0;
+
+    out = put_u32(buffer, writer->num_rows);
+    out = finish_chunk(out, encode_timestamps(out + CHUNK_HEADER, writer->timestamps, writer->num_rows),
+                       ENCODING_DELTA_OF_DELTA);
+
+    for (uint32_t i = 0; i < writer->num_rows; ++i) {
+        if (writer->timestamps[i] < info->timestamp_min) {
+            info->timestamp_min = writer->timestamps[i];
+        }
+        if (writer->timestamps[i] > info->timestamp_max) {
+            info->timestamp_max = writer->timestamps[i];
+        }
+    }
+
+    for (int j = 0; j < footer->num_channels; ++j) {
+        info->min[j] = NAN;
+        info->max[j] = NAN;
+        info->nan_count[j] = 0;
+
+        for (uint32_t i = 0; i < writer->num_rows; ++i) {
+            float value = writer->values[j][i];
+
+            if (isnan(value)) {
+                ++info->nan_count[j];
+            } else {
+                if (isnan(info->min[j]) || value < info->min[j]) {
+                    info->min[j] = value;
+                }
+                if (isnan(info->max[j]) || value > info->max[j]) {
+                    info->max[j] = value;
+                }
+            }
+        }
+
+        out = finish_chunk(out, encode_floats(out + CHUNK_HEADER, writer->values[j], writer->num_rows),
+                           ENCODING_XOR);
+    }
+
+    //Flushed so a crash loses at most the row group being buffered
+    if (fwrite(buffer, 1, (size_t)(out - buffer), writer->file) != (size_t)(out - buffer)
+        || fflush(writer->file) != 0) {
+        result = WRITE_ERR;
+    } else {
+        ++footer->num_groups;
+    }
+
+    writer->num_rows = 0;
+    return result;
+}
+
+/**
+ * @brief Writes the footer with every row group's statistics
+ *
+ * @param writer the device's writer
+ * @return WRITE_ERR if the footer couldn't be written, NOERR otherwise
+ */
+static int8_t write_footer(struct Column_Writer* writer) {
+    const struct Column_Footer* footer = &writer->footer;
+    uint8_t* buffer = write_buffer;
+    uint8_t* out = buffer;
+    int8_t result = NOERR;
+
+    *out++ = footer->device_addr;
+    *out++ = footer->num_channels;
+    for (int j = 0; j < footer->num_channels; ++j) {
+        size_t length = strlen(footer->channels[j]);
+
+        *out++ = (uint8_t)length;
+        memcpy(out, footer->channels[j], length);
+        out += length;
+    }
+
+    out = put_u32(out, footer->num_groups);
+    for (uint32_t i = 0; i < footer->num_groups; ++i) {
+        const struct Row_Group_Info* info = &footer->groups[i];
+
+        out = put_u64(out, info->offset);
+        out = put_u32(out, info->num_rows);
+        out = put_u64(out, info->timestamp_min);
+        out = put_u64(out, info->timestamp_max);
+        for (int j = 0; j < footer->num_channels; ++j) {
+            out = put_float(out, info->min[j]);
+            out = put_float(out, info->max[j]);
+            out = put_u32(out, info->nan_count[j]);
+        }
+    }
+
+    out = put_u32(out, (uint32_t)(out - buffer));
+    memcpy(out, COLUMNAR_MAGIC, 4);
+    out += 4;
+
+    if (fwrite(buffer, 1, (size_t)(out - buffer), writer->file) != (size_t)(out - buffer)) {
+        result = WRITE_ERR;
+    }
+
+    return result;
+}
+
+/**
+ * @brief Opens a new file named after the device and the start of its period
+ *
+ * A file left over from an earlier run in the same period is never overwritten,
+ * the new file gets a numbered suffix instead
+ *
+ * @param writer the device's writer
+ * @param period_ms the start of the file's period in wall-clock milliseconds
+ * @return WRITE_ERR if no file could be created, NOERR otherwise
+ */
+static int8_t open_file(struct Column_Writer* writer, uint64_t period_ms) {
+    char path[COLUMNAR_PATH_SIZE + 64];
+    char stamp[32];
+    time_t period_s = (time_t)(period_ms / 1000);
+    struct tm period_tm;
+
+    gmtime_r(&period_s, &period_tm);
+    strftime(stamp, sizeof(stamp), "%Y%m%dT%H%M%SZ", &period_tm);
+
+    for (int suffix = 0; suffix < MAX_SUFFIX; ++suffix) {
+        if (suffix == 0) {
+            snprintf(path, sizeof(path), "%s/%s-%s.aqc", writer->directory,
+                     device_name(writer->footer.device_addr), stamp);
+        } else {
+            snprintf(path, sizeof(path), "%s/%s-%s-%d.aqc", writer->directory,
+                     device_name(writer->footer.device_addr), stamp, suffix);
+        }
+
+        if ((writer->file = fopen(path, "wbx")) != NULL) {
+            break;
+        } else if (errno != EEXIST) {
+            return WRITE_ERR;
+        }
+    }
+
+    if (writer->file == NULL) {
+        return WRITE_ERR;
+    }
+
+    if (fwrite(COLUMNAR_MAGIC, 1, 4, writer->file) != 4) {
+        fclose(writer->file);
+        writer->file = NULL;
+        return WRITE_ERR;
+    }
+
+    writer->opened_ms = period_ms;
+    writer->footer.num_groups = 0;
+    return NOERR;
+}
+
+int8_t columnar_writer_init(struct Column_Writer* writer, const char* directory,
+                            uint32_t rotate_s, uint8_t device_addr, int num_channels) {
+    memset(writer, 0, sizeof(*writer));
+
+    if (strlen(directory) >= COLUMNAR_PATH_SIZE || num_channels > MAX_DATAPOINTS || rotate_s == 0) {
+        return SIZE_ERR;
+    }
+
+    strcpy(writer->directory, directory);
+    writer->rotate_s = rotate_s;
+    writer->footer.device_addr = device_addr;
+    writer->footer.num_channels = (uint8_t)num_channels;
+    for (int j = 0; j < num_channels; ++j) {
+        snprintf(writer->footer.channels[j], COLUMNAR_NAME_SIZE, "%s", channel_name(device_addr, j));
+    }
+
+    return NOERR;
+}
+
+int8_t columnar_writer_add(struct Column_Writer* writer, const struct Sensor_Data* sample) {
+    uint64_t timestamp = timespec_to_ms(&sample->realtime);
+    uint64_t period_ms = (uint64_t)writer->rotate_s * 1000;
+    int8_t result = NOERR;
+
+    //Files are aligned to the period so a daily file starts at midnight UTC
+    if (writer->file != NULL
+        && (timestamp < writer->opened_ms || timestamp >= writer->opened_ms + period_ms)) {
+        result = columnar_writer_close(writer);
+    }
+
+    if (writer->file == NULL && open_file(writer, timestamp - timestamp % period_ms) != NOERR) {
+        return WRITE_ERR;
+    }
+
+    writer->timestamps[writer->num_rows] = timestamp;
+    for (int j = 0; j < writer->footer.num_channels; ++j) {
+        writer->values[j][writer->num_rows] = j < sample->num_data ? sample->data[j] : NAN;
+    }
+
+    if (++writer->num_rows == COLUMNAR_ROW_GROUP && write_group(writer) != NOERR) {
+        result = WRITE_ERR;
+    }
+
+    //A full footer ends the file early, the next row opens a suffixed one
+    if (writer->footer.num_groups == COLUMNAR_MAX_GROUPS) {
+        result = columnar_writer_close(writer) == NOERR ? result : WRITE_ERR;
+    }
+
+    return result;
+}
+
+int8_t columnar_writer_close(struct Column_Writer* writer) {
+    int8_t result;
+
+    if (writer->file == NULL) {
+        return NOERR;
+    }
+
+    result = write_group(writer);
+    if (write_footer(writer) != NOERR) {
+        result = WRITE_ERR;
+    }
+    if (fclose(writer->file) != 0) {
+        result = WRITE_ERR;
+    }
+
+    writer->file = NULL;
+    return result;
+}
+
+/**
+ * @brief Parses the footer
+ *
+ * @param in the footer's first byte
+ * @param end the byte after the footer
+ * @param footer the out parameter for the footer
+ * @return whether the footer was complete and within the limits
+ */
+static bool parse_footer(const uint8_t* in, const uint8_t* end, struct Column_Footer* footer) {
+    memset(footer, 0, sizeof(*footer));
+
+    if (end - in < 2) {
+        return false;
+    }
+
+    footer->device_addr = *in++;
+    footer->num_channels = *in++;
+    if (footer->num_channels > MAX_DATAPOINTS) {
+        return false;
+    }
+
+    for (int j = 0; j < footer->num_channels; ++j) {
+        uint8_t length;
+
+        if (in == end || (length = *in++) >= COLUMNAR_NAME_SIZE || end - in < length) {
+            return false;
+        }
+        memcpy(footer->channels[j], in, length);
+        in += length;
+    }
+
+    if (end - in < 4 || (footer->num_groups = get_u32(in)) > COLUMNAR_MAX_GROUPS) {
+        return false;
+    }
+    in += 4;
+
+    if (end - in != (long)footer->num_groups * (28 + footer->num_channels * 12)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < footer->num_groups; ++i) {
+        struct Row_Group_Info* info = &footer->groups[i];
+
+        info->offset = get_u64(in);
+        info->num_rows = get_u32(in + 8);
+        info->timestamp_min = get_u64(in + 12);
+        info->timestamp_max = get_u64(in + 20);
+        in += 28;
+
+        for (int j = 0; j < footer->num_channels; ++j) {
+            info->min[j] = get_float(in);
+            info->max[j] = get_float(in + 4);
+            info->nan_count[j] = get_u32(in + 8);
+            in += 12;
+        }
+
+        if (info->num_rows == 0 || info->num_rows > COLUMNAR_ROW_GROUP) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int8_t columnar_reader_open(const char* path, struct Column_Reader* reader) {
+    uint8_t tail[8];
+    uint8_t* buffer;
+    uint32_t size;
+    bool valid;
+
+    if ((reader->file = fopen(path, "rb")) == NULL) {
+        return INIT_ERR;
+    }
+
+    if (fread(tail, 1, 4, reader->file) != 4 || memcmp(tail, COLUMNAR_MAGIC, 4) != 0
+        || fseek(reader->file, -8, SEEK_END) != 0 || fread(tail, 1, 8, reader->file) != 8
+        || memcmp(tail + 4, COLUMNAR_MAGIC, 4) != 0 || (size = get_u32(tail)) > MAX_FOOTER
+        || fseek(reader->file, -8 - (long)size, SEEK_END) != 0) {
+        columnar_reader_close(reader);
+        return READ_ERR;
+    }
+
+    if ((buffer = malloc(size)) == NULL) {
+        columnar_reader_close(reader);
+        return READ_ERR;
+    }
+
+    valid = fread(buffer, 1, size, reader->file) == size
+        && parse_footer(buffer, buffer + size, &reader->footer);
+    free(buffer);
+
+    if (!valid) {
+        columnar_reader_close(reader);
+        return READ_ERR;
+    }
+
+    return NOERR;
+}
+
+bool columnar_group_matches(const struct Row_Group_Info* group, int channel, float min,
+                            float max, uint64_t from_ms, uint64_t to_ms) {
+    if (group->timestamp_max < from_ms || group->timestamp_min > to_ms) {
+        return false;
+    }
+
+    if (channel < 0) {
+        return true;
+    }
+
+    //A group of only NAN readings has no min or max and matches no value
+    return group->nan_count[channel] < group->num_rows
+        && group->max[channel] >= min && group->min[channel] <= max;
+}
+
+/**
+ * @brief Reads the header and values of the next column in the row group
+ *
+ * @param file the file, positioned at the column
+ * @param buffer the out parameter for the column's values, MUST HOLD MAX_CHUNK
+ * @param encoding the column's expected encoding
+ * @return the size of the column's values or -1 if it couldn't be read
+ */
+static long read_chunk(FILE* file, uint8_t* buffer, enum Column_Encoding encoding) {
+    uint8_t header[CHUNK_HEADER];
+    uint32_t size;
+
+    if (fread(header, 1, CHUNK_HEADER, file) != CHUNK_HEADER || header[0] != encoding
+        || (size = get_u32(header + 1)) > MAX_CHUNK || fread(buffer, 1, size, file) != size) {
+        return -1;
+    }
+
+    return (long)size;
+}
+
+int8_t columnar_reader_group(struct Column_Reader* reader, uint32_t group, uint64_t* timestamps,
+                            float values[MAX_DATAPOINTS][COLUMNAR_ROW_GROUP]) {
+    const struct Row_Group_Info* info;
+    uint8_t rows[4];
+    uint8_t* buffer;
+    long size;
+    int8_t result = READ_ERR;
+
+    if (group >= reader->footer.num_groups) {
+        return READ_ERR;
+    }
+
+    info = &reader->footer.groups[group];
+    if (fseek(reader->file, (long)info->offset, SEEK_SET) != 0 || fread(rows, 1, 4, reader->file) != 4
+        || get_u32(rows) != info->num_rows || (buffer = malloc(MAX_CHUNK)) == NULL) {
+        return READ_ERR;
+    }
+
+    if ((size = read_chunk(reader->file, buffer, ENCODING_DELTA_OF_DELTA)) < 0
+        || !decode_timestamps(buffer, buffer + size, timestamps, info->num_rows)) {
+        goto done;
+    }
+
+    for (int j = 0; j < reader->footer.num_channels; ++j) {
+        if ((size = read_chunk(reader->file, buffer, ENCODING_XOR)) < 0
+            || !decode_floats(buffer, buffer + size, values[j], info->num_rows)) {
+            goto done;
+        }
+    }
+
+    result = NOERR;
+
+done:
+    free(buffer);
+    return result;
+}
+
+void columnar_reader_close(struct Column_Reader* reader) {
+    if (reader->file != NULL) {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+}
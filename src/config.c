@@ -0,0 +1,423 @@
+#include "../include/config.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Removes the leading and trailing whitespace from the string in place
+ *
+ * @param str the string to be trimmed
+ * @return the start of the trimmed string
+ */
+static char* trim(char* str) {
+    char* end;
+
+    while (isspace((unsigned char)*str)) {
+        ++str;
+    }
+
+    end = str + strlen(str);
+    while (end > str && isspace((unsigned char)end[-1])) {
+        *--end = '\0';
+    }
+
+    return str;
+}
+
+/**
+ * @brief Parses an unsigned number, accepting hex with a leading 0x
+ *
+ * @param str the string to be parsed
+ * @param value the out parameter for the number
+ * @return whether the whole string was a number
+ */
+static bool parse_uint(const char* str, uint32_t* value) {
+    char* end;
+    unsigned long number = strtoul(str, &end, 0);
+
+    if (*str == '\0' || *end != '\0' || number > UINT32_MAX) {
+        return false;
+    }
+
+    *value = (uint32_t)number;
+    return true;
+}
+
+/**
+ * @brief Parses a boolean written as true/false, yes/no, or 1/0
+ *
+ * @param str the string to be parsed
+ * @param value the out parameter for the boolean
+ * @return whether the string was a boolean
+ */
+static bool parse_bool(const char* str, bool* value) {
+    if (strcmp(str, "true") == 0 || strcmp(str, "yes") == 0 || strcmp(str, "1") == 0) {
+        *value = true;
+    } else if (strcmp(str, "false") == 0 || strcmp(str, "no") == 0 || strcmp(str, "0") == 0) {
+        *value = false;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Parses the CPU a kind of thread is pinned to, "none" leaves it unpinned
+ *
+ * @param str the string to be parsed
+ * @param cpu the out parameter for the CPU or NO_CPU_PIN
+ * @return whether the string was a CPU the system has, or "none"
+ */
+static bool parse_cpu(const char* str, int* cpu) {
+    uint32_t number;
+    long cpus = sysconf(_SC_NPROCESSORS_CONF);
+
+    if (strcmp(str, "none") == 0) {
+        *cpu = NO_CPU_PIN;
+        return true;
+    }
+
+    if (!parse_uint(str, &number) || (cpus > 0 && number >= (uint32_t)cpus)) {
+        return false;
+    }
+
+    *cpu = (int)number;
+    return true;
+}
+
+/**
+ * @brief Copies the string into a fixed size configuration field
+ *
+ * @param field the configuration field
+ * @param value the string to be copied
+ * @return whether the string fit in the field
+ */
+static bool parse_string(char* field, const char* value) {
+    if (strlen(value) >= CONFIG_STRING_SIZE) {
+        return false;
+    }
+
+    strcpy(field, value);
+    return true;
+}
+
+/**
+ * @brief Checks that the topic template only uses known placeholders
+ *
+ * @param template the topic template
+ * @return whether the template can be expanded
+ */
+static bool valid_template(const char* template) {
+    char topic[TOPIC_SIZE];
+
+    return topic_format(topic, sizeof(topic), template, "", "", "") == NOERR;
+}
+
+/**
+ * @brief Parses a "<SEN55|SCD40|address> [adapter] [period]" device entry
+ *
+ * @param value the device entry
+ * @param device the out parameter for the device
+ * @return whether the entry names a supported device
+ */
+static bool parse_device(char* value, struct Device_Config* device) {
+    char* save;
+    char* name = strtok_r(value, " \t", &save);
+    char* adapter = strtok_r(NULL, " \t", &save);
+    char* period = strtok_r(NULL, " \t", &save);
+    uint32_t address;
+
+    if (name == NULL || strtok_r(NULL, " \t", &save) != NULL) {
+        return false;
+    }
+
+    if (strcmp(name, device_name(SEN55_ADDRESS)) == 0) {
+        address = SEN55_ADDRESS;
+    } else if (strcmp(name, device_name(SCD40_ADDRESS)) == 0) {
+        address = SCD40_ADDRESS;
+    } else if (!parse_uint(name, &address) || address > 0x7F) {
+        return false;
+    }
+
+    if (strcmp(device_name(address), "Unknown") == 0) {
+        return false;
+    }
+
+    device->address = (uint8_t)address;
+    device->adapter_num = ADAPTER_NUM;
+    device->period = 0;
+
+    return (adapter == NULL || parse_uint(adapter, &device->adapter_num))
+        && (period == NULL || parse_uint(period, &device->period));
+}
+
+/**
+ * @brief Applies a single "key = value" pair to the configuration
+ *
+ * @param config the configuration
+ * @param key the trimmed key
+ * @param value the trimmed value
+ * @return whether the key is known and its value valid
+ */
+static bool apply_setting(struct Config* config, const char* key, char* value) {
+    uint32_t number;
+
+    if (strcmp(key, "address") == 0) {
+        return parse_string(config->address, value);
+    } else if (strcmp(key, "client_id") == 0) {
+        return parse_string(config->client_id, value);
+    } else if (strcmp(key, "topic") == 0) {
+        return parse_string(config->topic, value);
+    } else if (strcmp(key, "metrics_topic") == 0) {
+        return parse_string(config->metrics_topic, value);
+    } else if (strcmp(key, "gateway") == 0) {
+        return parse_string(config->gateway, value) && strpbrk(value, "/+#") == NULL;
+    } else if (strcmp(key, "channel_topic") == 0) {
+        return parse_string(config->channel_topic, value) && valid_template(value);
+    } else if (strcmp(key, "shm_name") == 0) {
+        return parse_string(config->shm_name, value) 
+            && (*value == '\0' || (*value == '/' && strchr(value + 1, '/') == NULL));
+    } else if (strcmp(key, "history_length") == 0) {
+        return parse_uint(value, &config->history_length) && config->history_length > 0;
+    } else if (strcmp(key, "query_socket") == 0) {
+        if (strlen(value) >= QUERY_PATH_SIZE) {
+            return false;
+        }
+
+        strcpy(config->query_socket, value);
+        return true;
+    } else if (strcmp(key, "export_dir") == 0) {
+        return parse_string(config->export_dir, value);
+    } else if (strcmp(key, "export_rotate_s") == 0) {
+        return parse_uint(value, &config->export_rotate_s) && config->export_rotate_s > 0;
+    } else if (strcmp(key, "derived_metrics") == 0) {
+        return parse_bool(value, &config->derived_metrics);
+    } else if (strcmp(key, "outdoor_co2") == 0) {
+        return parse_uint(value, &config->outdoor_co2);
+    } else if (strcmp(key, "retain_channels") == 0) {
+        return parse_bool(value, &config->retain_channels);
+    } else if (strcmp(key, "alert_topic") == 0) {
+        return parse_string(config->alert_topic, value);
+    } else if (strcmp(key, "alert_qos") == 0) {
+        if (!parse_uint(value, &number) || number > 2) {
+            return false;
+        }
+
+        config->alert_qos = (int)number;
+        return true;
+    } else if (strcmp(key, "alert") == 0) {
+        if (config->num_alerts == ALERT_MAX_RULES
+            || alert_compile(value, &config->alerts[config->num_alerts]) != NOERR) {
+            return false;
+        }
+
+        ++config->num_alerts;
+        return true;
+    } else if (strcmp(key, "filter") == 0) {
+        if (config->num_filters == FILTER_MAX
+            || filter_parse(value, &config->filters[config->num_filters]) != NOERR) {
+            return false;
+        }
+
+        ++config->num_filters;
+        return true;
+    } else if (strcmp(key, "qos") == 0) {
+        if (!parse_uint(value, &number) || number > 2) {
+            return false;
+        }
+
+        config->qos = (int)number;
+        return true;
+    } else if (strcmp(key, "wait_time") == 0) {
+        return parse_uint(value, &config->wait_time) && config->wait_time > 0;
+    } else if (strcmp(key, "join_lateness_ms") == 0) {
+        return parse_uint(value, &config->join_lateness_ms);
+    } else if (strcmp(key, "metrics_interval") == 0) {
+        return parse_uint(value, &config->metrics_interval);
+    } else if (strcmp(key, "timing_metadata") == 0) {
+        return parse_bool(value, &config->timing_metadata);
+    } else if (strcmp(key, "calibrate_delays") == 0) {
+        return parse_bool(value, &config->calibrate_delays);
+    } else if (strcmp(key, "capture_file") == 0) {
+        return parse_string(config->capture_file, value);
+    } else if (strcmp(key, "capture_records") == 0) {
+        return parse_uint(value, &config->capture_records) && config->capture_records > 0;
+    } else if (strcmp(key, "replay_file") == 0) {
+        return parse_string(config->replay_file, value);
+    } else if (strcmp(key, "fault_seed") == 0) {
+        return parse_uint(value, &config->fault_seed);
+    } else if (strcmp(key, "realtime") == 0) {
+        return parse_bool(value, &config->realtime.enabled);
+    } else if (strcmp(key, "acquisition_cpu") == 0) {
+        return parse_cpu(value, &config->realtime.acquisition_cpu);
+    } else if (strcmp(key, "processing_cpu") == 0) {
+        return parse_cpu(value, &config->realtime.processing_cpu);
+    } else if (strcmp(key, "publish_cpu") == 0) {
+        return parse_cpu(value, &config->realtime.publish_cpu);
+    } else if (strcmp(key, "acquisition_priority") == 0) {
+        //SCHED_FIFO's priorities on Linux
+        if (!parse_uint(value, &number) || number < 1 || number > 99) {
+            return false;
+        }
+
+        config->realtime.acquisition_priority = (int)number;
+        return true;
+    } else if (strcmp(key, "fault") == 0) {
+        if (config->num_faults == FAULT_MAX_RULES
+            || fault_parse(value, &config->faults[config->num_faults]) != NOERR) {
+            return false;
+        }
+
+        ++config->num_faults;
+        return true;
+    } else if (strcmp(key, "device") == 0) {
+        if (config->num_devices == CONFIG_MAX_DEVICES) {
+            return false;
+        }
+
+        struct Device_Config* device = &config->devices[config->num_devices];
+        if (!parse_device(value, device) || config_find_device(config, device->address) != NULL) {
+            return false;
+        }
+
+        ++config->num_devices;
+        return true;
+    }
+
+    return false;
+}
+
+void config_defaults(struct Config* config) {
+    memset(config, 0, sizeof(*config));
+    strcpy(config->address, ADDRESS);
+    strcpy(config->client_id, CLIENTID);
+    strcpy(config->topic, TOPIC);
+    strcpy(config->metrics_topic, METRICS_TOPIC);
+    strcpy(config->channel_topic, CHANNEL_TOPIC);
+    config->retain_channels = RETAIN_CHANNELS;
+    strcpy(config->shm_name, SHM_NAME);
+    config->history_length = HISTORY_LENGTH;
+    strcpy(config->query_socket, QUERY_SOCKET);
+    strcpy(config->export_dir, EXPORT_DIR);
+    config->export_rotate_s = EXPORT_ROTATE_S;
+    config->derived_metrics = DERIVED_METRICS_ENABLED;
+    config->outdoor_co2 = OUTDOOR_CO2;
+    strcpy(config->alert_topic, ALERT_TOPIC);
+    config->alert_qos = ALERT_QOS;
+    if (gethostname(config->gateway, CONFIG_STRING_SIZE) != 0 || config->gateway[0] == '\0'
+        || config->gateway[CONFIG_STRING_SIZE - 1] != '\0') {
+        strcpy(config->gateway, GATEWAY);
+    }
+    config->qos = QOS;
+    config->wait_time = WAIT_TIME;
+    config->join_lateness_ms = JOIN_LATENESS_MS;
+    config->metrics_interval = METRICS_INTERVAL;
+    config->timing_metadata = TIMING_METADATA;
+    config->calibrate_delays = CALIBRATE_DELAYS;
+    strcpy(config->capture_file, CAPTURE_FILE);
+    config->capture_records = CAPTURE_RECORDS;
+    strcpy(config->replay_file, REPLAY_FILE);
+    config->fault_seed = FAULT_SEED;
+    config->realtime = (struct Realtime_Config){
+        .enabled = REALTIME_MODE,
+        .acquisition_cpu = ACQUISITION_CPU,
+        .processing_cpu = PROCESSING_CPU,
+        .publish_cpu = PUBLISH_CPU,
+        .acquisition_priority = ACQUISITION_PRIORITY,
+    };
+}
+
+int8_t config_load(const char* path, struct Config* config, int* error_line) {
+    struct Config loaded;
+    char line[2 * CONFIG_STRING_SIZE];
+    char topic[TOPIC_SIZE];
+    FILE* file;
+
+    *error_line = 0;
+    config_defaults(&loaded);
+
+    if ((file = fopen(path, "r")) != NULL) {
+        while (fgets(line, sizeof(line), file) != NULL) {
+            char* comment = strchr(line, '#');
+            char* separator;
+
+            ++*error_line;
+            if (comment != NULL) {
+                *comment = '\0';
+            }
+
+            char* setting = trim(line);
+            if (*setting == '\0') {
+                continue;
+            }
+
+            if ((separator = strchr(setting, '=')) == NULL) {
+                fclose(file);
+                return CONFIG_ERR;
+            }
+            *separator = '\0';
+
+            if (!apply_setting(&loaded, trim(setting), trim(separator + 1))) {
+                fclose(file);
+                return CONFIG_ERR;
+            }
+        }
+
+        fclose(file);
+        *error_line = 0;
+    }
+
+    //The gateway's name has to leave room for the longest device and channel names
+    if (*loaded.channel_topic != '\0'
+        && topic_format(topic, sizeof(topic), loaded.channel_topic, loaded.gateway, 
+                        "SEN55", "temperature") != NOERR) {
+        return CONFIG_ERR;
+    }
+
+    if (loaded.num_devices == 0) {
+        loaded.devices[0] = (struct Device_Config){SCD40_ADDRESS, ADAPTER_NUM, 0};
+        loaded.devices[1] = (struct Device_Config){SEN55_ADDRESS, ADAPTER_NUM, 0};
+        loaded.num_devices = 2;
+    }
+
+    for (int i = 0; i < loaded.num_devices; ++i) {
+        if (loaded.devices[i].period == 0) {
+            loaded.devices[i].period = loaded.wait_time;
+        }
+    }
+
+    *config = loaded;
+    return NOERR;
+}
+
+bool config_broker_changed(const struct Config* old_config, const struct Config* new_config) {
+    return strcmp(old_config->address, new_config->address) != 0
+        || strcmp(old_config->client_id, new_config->client_id) != 0;
+}
+
+bool config_devices_changed(const struct Config* old_config, const struct Config* new_config) {
+    if (old_config->num_devices != new_config->num_devices) {
+        return true;
+    }
+
+    //Addresses are unique, so every new address having an old device is enough
+    for (int i = 0; i < new_config->num_devices; ++i) {
+        if (config_find_device(old_config, new_config->devices[i].address) == NULL) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const struct Device_Config* config_find_device(const struct Config* config, uint8_t address) {
+    for (int i = 0; i < config->num_devices; ++i) {
+        if (config->devices[i].address == address) {
+            return &config->devices[i];
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,107 @@
+#include "../include/delivery.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+void delivery_init(struct Delivery_Tracker* tracker) {
+    memset(tracker, 0, sizeof(*tracker));
+}
+
+void delivery_confirm(struct Delivery_Tracker* tracker, int token) {
+    uint32_t tail = atomic_load_explicit(&tracker->confirmed_tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&tracker->confirmed_head, memory_order_acquire);
+
+    if (tail - head == DELIVERY_RING_SIZE) {
+        return;
+    }
+
+    tracker->confirmed[tail % DELIVERY_RING_SIZE] = token;
+    atomic_store_explicit(&tracker->confirmed_tail, tail + 1, memory_order_release);
+}
+
+void delivery_track(struct Delivery_Tracker* tracker, const int* tokens, int num_tokens, uint64_t now_ms) {
+    struct Delivery_Record* record;
+
+    if (delivery_full(tracker)) {
+        return;
+    }
+
+    record = &tracker->records[(tracker->head + tracker->count) % DELIVERY_MAX_RECORDS];
+    record->sent_ms = now_ms;
+    record->num_tokens = num_tokens < DELIVERY_MAX_TOKENS ? num_tokens : DELIVERY_MAX_TOKENS;
+    memcpy(record->tokens, tokens, sizeof(record->tokens[0]) * (size_t)record->num_tokens);
+    ++tracker->count;
+}
+
+/**
+ * @brief Marks the token as delivered in the oldest record still waiting on it
+ *
+ * The client reuses a token once its message is delivered, so the oldest match is
+ * the one that was confirmed. Tokens of the alerts and metrics match nothing
+ *
+ * @param tracker the tracker
+ * @param token the confirmed delivery token
+ */
+static void delivery_match(struct Delivery_Tracker* tracker, int token) {
+    for (uint32_t i = 0; i < tracker->count; ++i) {
+        struct Delivery_Record* record = &tracker->records[(tracker->head + i) % DELIVERY_MAX_RECORDS];
+
+        for (int j = 0; j < record->num_tokens; ++j) {
+            if (record->tokens[j] == token) {
+                record->tokens[j] = record->tokens[--record->num_tokens];
+                return;
+            }
+        }
+    }
+}
+
+uint32_t delivery_collect(struct Delivery_Tracker* tracker) {
+    uint32_t head = atomic_load_explicit(&tracker->confirmed_head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&tracker->confirmed_tail, memory_order_acquire);
+    uint32_t completed = 0;
+
+    for (; head != tail; ++head) {
+        delivery_match(tracker, tracker->confirmed[head % DELIVERY_RING_SIZE]);
+    }
+    atomic_store_explicit(&tracker->confirmed_head, head, memory_order_release);
+
+    while (tracker->count > 0 && tracker->records[tracker->head].num_tokens == 0) {
+        delivery_forget_oldest(tracker);
+        ++completed;
+    }
+
+    return completed;
+}
+
+int delivery_timeout(const struct Delivery_Tracker* tracker, uint64_t now_ms, uint64_t timeout_ms) {
+    uint64_t expires_ms;
+
+    if (tracker->count == 0) {
+        return -1;
+    }
+
+    expires_ms = tracker->records[tracker->head].sent_ms + timeout_ms;
+    return expires_ms > now_ms ? (int)(expires_ms - now_ms) : 0;
+}
+
+bool delivery_full(const struct Delivery_Tracker* tracker) {
+    return tracker->count == DELIVERY_MAX_RECORDS;
+}
+
+void delivery_forget_oldest(struct Delivery_Tracker* tracker) {
+    if (tracker->count == 0) {
+        return;
+    }
+
+    tracker->head = (tracker->head + 1) % DELIVERY_MAX_RECORDS;
+    --tracker->count;
+}
+
+void delivery_reset(struct Delivery_Tracker* tracker) {
+    tracker->head = 0;
+    tracker->count = 0;
+    atomic_store_explicit(&tracker->confirmed_head,
+                        atomic_load_explicit(&tracker->confirmed_tail, memory_order_acquire),
+                        memory_order_release);
+}
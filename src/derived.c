@@ -0,0 +1,263 @@
+#include "../include/derived.h"
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+struct Breakpoint {
+    float low;
+    float high;
+    float index_low;
+    float index_high;
+};
+
+/*******************************************************************************
+*                                Global Variables                              *
+*******************************************************************************/
+
+static const struct Breakpoint PM2_5_BREAKPOINTS[] = {
+    {0.0f, 9.0f, 0, 50},
+    {9.1f, 35.4f, 51, 100},
+    {35.5f, 55.4f, 101, 150},
+    {55.5f, 125.4f, 151, 200},
+    {125.5f, 225.4f, 201, 300},
+    {225.5f, 325.4f, 301, 500},
+};
+
+static const struct Breakpoint PM10_BREAKPOINTS[] = {
+    {0, 54, 0, 50},
+    {55, 154, 51, 100},
+    {155, 254, 101, 150},
+    {255, 354, 151, 200},
+    {355, 424, 201, 300},
+    {425, 604, 301, 500},
+};
+
+static const char* NAMES[DERIVED_METRICS] = {
+    [DERIVED_AQI] = "aqi",
+    [DERIVED_PM2_5_24H] = "pm2_5_24h",
+    [DERIVED_PM10_24H] = "pm10_24h",
+    [DERIVED_DEW_POINT] = "dew_point",
+    [DERIVED_ABSOLUTE_HUMIDITY] = "absolute_humidity",
+    [DERIVED_CO2_RATE] = "co2_rate",
+    [DERIVED_AIR_CHANGES] = "air_changes",
+};
+
+static const char* LABELS[DERIVED_METRICS] = {
+    [DERIVED_AQI] = "AQI",
+    [DERIVED_PM2_5_24H] = "Mass Concentration PM2.5 24h",
+    [DERIVED_PM10_24H] = "Mass Concentration PM10 24h",
+    [DERIVED_DEW_POINT] = "Dew Point",
+    [DERIVED_ABSOLUTE_HUMIDITY] = "Absolute Humidity",
+    [DERIVED_CO2_RATE] = "CO2 Rate",
+    [DERIVED_AIR_CHANGES] = "Air Changes",
+};
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Linearly interpolates the AQI within the concentration's breakpoint
+ *
+ * @param breakpoints the pollutant's breakpoints, lowest first
+ * @param num_breakpoints the number of breakpoints
+ * @param concentration the truncated concentration
+ * @return the AQI, 500 above the last breakpoint
+ */
+static float interpolate(const struct Breakpoint* breakpoints, int num_breakpoints,
+                         float concentration) {
+    if (isnan(concentration) || concentration < 0) {
+        return NAN;
+    }
+
+    for (int i = 0; i < num_breakpoints; ++i) {
+        const struct Breakpoint* breakpoint = &breakpoints[i];
+
+        if (concentration <= breakpoint->high) {
+            float low = concentration < breakpoint->low ? breakpoint->low : concentration;
+
+            return roundf((breakpoint->index_high - breakpoint->index_low) 
+                        / (breakpoint->high - breakpoint->low) * (low - breakpoint->low) 
+                        + breakpoint->index_low);
+        }
+    }
+
+    return breakpoints[num_breakpoints - 1].index_high;
+}
+
+float aqi_pm2_5(float concentration) {
+    //EPA truncates PM2.5 to one decimal place before looking up the breakpoint
+    return interpolate(PM2_5_BREAKPOINTS, sizeof(PM2_5_BREAKPOINTS) / sizeof(PM2_5_BREAKPOINTS[0]),
+                       floorf(concentration * 10) / 10);
+}
+
+float aqi_pm10(float concentration) {
+    return interpolate(PM10_BREAKPOINTS, sizeof(PM10_BREAKPOINTS) / sizeof(PM10_BREAKPOINTS[0]),
+                       floorf(concentration));
+}
+
+float dew_point(float temperature, float humidity) {
+    const float b = 17.62f;
+    const float c = 243.12f;
+    float gamma;
+
+    if (!(humidity > 0)) {
+        return NAN;
+    }
+
+    gamma = logf(humidity / 100) + b * temperature / (c + temperature);
+    return c * gamma / (b - gamma);
+}
+
+float absolute_humidity(float temperature, float humidity) {
+    //Saturation vapour pressure in hPa times the water vapour gas constant
+    float pressure = 6.112f * expf(17.67f * temperature / (temperature + 243.5f));
+
+    return pressure * humidity * 2.1674f / (273.15f + temperature);
+}
+
+/**
+ * @brief Empties the window
+ *
+ * @param mean the window
+ */
+static void rolling_init(struct Rolling_Mean* mean) {
+    memset(mean, 0, sizeof(*mean));
+    mean->bucket_ms = DERIVED_WINDOW_MS / DERIVED_BUCKETS;
+}
+
+/**
+ * @brief Moves the window forward to the time's bucket, dropping the buckets it passes
+ *
+ * @param mean the window
+ * @param time_ms the monotonic time in milliseconds
+ */
+static void rolling_advance(struct Rolling_Mean* mean, uint64_t time_ms) {
+    uint64_t bucket = time_ms / mean->bucket_ms;
+
+    if (!mean->started) {
+        mean->started = true;
+        mean->head = bucket;
+        return;
+    }
+
+    for (uint32_t i = 0; mean->head < bucket && i < DERIVED_BUCKETS; ++i) {
+        uint32_t index = (uint32_t)(++mean->head % DERIVED_BUCKETS);
+
+        mean->total -= mean->sums[index];
+        mean->total_count -= mean->counts[index];
+        mean->filled -= mean->counts[index] > 0;
+        mean->sums[index] = 0;
+        mean->counts[index] = 0;
+    }
+    mean->head = bucket > mean->head ? bucket : mean->head;
+}
+
+/**
+ * @brief Adds the reading to the window and gets the window's mean
+ *
+ * @param mean the window
+ * @param time_ms the monotonic time in milliseconds
+ * @param value the reading, NAN only moves the window
+ * @return the mean or NAN if less than DERIVED_MIN_COVERAGE of the window has readings
+ */
+static float rolling_add(struct Rolling_Mean* mean, uint64_t time_ms, float value) {
+    uint32_t index;
+
+    rolling_advance(mean, time_ms);
+    index = (uint32_t)(mean->head % DERIVED_BUCKETS);
+
+    if (!isnan(value)) {
+        mean->filled += mean->counts[index] == 0;
+        mean->sums[index] += value;
+        ++mean->counts[index];
+        mean->total += value;
+        ++mean->total_count;
+    }
+
+    if (mean->filled < DERIVED_BUCKETS * DERIVED_MIN_COVERAGE) {
+        return NAN;
+    }
+
+    return (float)(mean->total / mean->total_count);
+}
+
+/**
+ * @brief Adds the reading to the trend and drops the readings that left the window,
+ *          at short periods only the last DERIVED_TREND_POINTS readings are kept
+ *
+ * @param trend the trend
+ * @param time_ms the monotonic time in milliseconds
+ * @param value the reading
+ * @return the oldest reading still in the window
+ */
+static const struct Trend_Point* trend_add(struct Trend* trend, uint64_t time_ms, float value) {
+    const struct Trend_Point* oldest;
+
+    trend->points[trend->head] = (struct Trend_Point){time_ms, value};
+    trend->head = (trend->head + 1) % DERIVED_TREND_POINTS;
+    trend->count += trend->count < DERIVED_TREND_POINTS;
+
+    while (true) {
+        oldest = &trend->points[(trend->head + DERIVED_TREND_POINTS - trend->count) 
+                                % DERIVED_TREND_POINTS];
+
+        if (trend->count == 1 || time_ms - oldest->time_ms <= trend->window_ms) {
+            return oldest;
+        }
+        --trend->count;
+    }
+}
+
+void derived_init(struct Derived* derived, float outdoor_co2) {
+    derived->outdoor_co2 = outdoor_co2;
+    rolling_init(&derived->pm2_5);
+    rolling_init(&derived->pm10);
+    memset(&derived->co2, 0, sizeof(derived->co2));
+    derived->co2.window_ms = DERIVED_TREND_MS;
+}
+
+void derived_update(struct Derived* derived, uint64_t time_ms, const struct Derived_Inputs* inputs,
+                    struct Derived_Values* values) {
+    float* out = values->values;
+    float aqi_fine;
+    float aqi_coarse;
+
+    out[DERIVED_PM2_5_24H] = rolling_add(&derived->pm2_5, time_ms, inputs->pm2_5);
+    out[DERIVED_PM10_24H] = rolling_add(&derived->pm10, time_ms, inputs->pm10);
+
+    //The AQI is the worse of the two pollutants' indices
+    aqi_fine = aqi_pm2_5(out[DERIVED_PM2_5_24H]);
+    aqi_coarse = aqi_pm10(out[DERIVED_PM10_24H]);
+    out[DERIVED_AQI] = isnan(aqi_fine) || aqi_coarse > aqi_fine ? aqi_coarse : aqi_fine;
+
+    out[DERIVED_DEW_POINT] = dew_point(inputs->temperature, inputs->humidity);
+    out[DERIVED_ABSOLUTE_HUMIDITY] = absolute_humidity(inputs->temperature, inputs->humidity);
+
+    out[DERIVED_CO2_RATE] = NAN;
+    out[DERIVED_AIR_CHANGES] = NAN;
+    if (!isnan(inputs->co2)) {
+        const struct Trend_Point* oldest = trend_add(&derived->co2, time_ms, inputs->co2);
+        float hours = (float)(time_ms - oldest->time_ms) / 3600000.0f;
+        float excess_then = oldest->value - derived->outdoor_co2;
+        float excess_now = inputs->co2 - derived->outdoor_co2;
+
+        if (hours > 0) {
+            out[DERIVED_CO2_RATE] = (inputs->co2 - oldest->value) / hours;
+
+            //While nobody is adding CO2, the excess over outdoors decays at the air change rate
+            if (excess_now > 0 && excess_then > excess_now) {
+                out[DERIVED_AIR_CHANGES] = logf(excess_then / excess_now) / hours;
+            }
+        }
+    }
+}
+
+const char* derived_name(enum Derived_Metric metric) {
+    return NAMES[metric];
+}
+
+const char* derived_label(enum Derived_Metric metric) {
+    return LABELS[metric];
+}
@@ -51,3 +51,14 @@ int8_t device_read(uint8_t* data, uint16_t count, uint8_t device_addr, int* fd)
             return ADDR_ERR;
     }
 }
+
+const char* device_name(uint8_t device_addr) {
+    switch (device_addr) {
+        case SEN55_ADDRESS:
+            return "SEN55";
+        case SCD40_ADDRESS:
+            return "SCD40";
+        default:
+            return "Unknown";
+    }
+}
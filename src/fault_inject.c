@@ -0,0 +1,293 @@
+#include "../include/fault_inject.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Parses the device, bus or broker a fault is injected into
+ *
+ * @param target the target's text
+ * @param rule the rule whose site and address are set
+ * @return whether the target is the broker, the bus, or a supported device
+ */
+static bool parse_target(const char* target, struct Fault_Rule* rule) {
+    char* end;
+    unsigned long address;
+
+    rule->site = FAULT_DEVICE;
+    rule->device_addr = FAULT_ANY_DEVICE;
+
+    if (strcmp(target, "broker") == 0) {
+        rule->site = FAULT_BROKER;
+        return true;
+    } else if (strcmp(target, "bus") == 0) {
+        return true;
+    } else if (strcmp(target, device_name(SEN55_ADDRESS)) == 0) {
+        rule->device_addr = SEN55_ADDRESS;
+        return true;
+    } else if (strcmp(target, device_name(SCD40_ADDRESS)) == 0) {
+        rule->device_addr = SCD40_ADDRESS;
+        return true;
+    }
+
+    address = strtoul(target, &end, 0);
+    if (*end != '\0' || address > 0x7F || strcmp(device_name((uint8_t)address), "Unknown") == 0) {
+        return false;
+    }
+
+    rule->device_addr = (uint8_t)address;
+    return true;
+}
+
+/**
+ * @brief Whether the fault kind can be injected at the rule's site
+ *
+ * @param rule the rule
+ * @return whether the kind applies to the site
+ */
+static bool valid_kind(const struct Fault_Rule* rule) {
+    switch (rule->kind) {
+        case FAULT_CRC:
+        case FAULT_NACK:
+        case FAULT_SHORT:
+            return rule->site == FAULT_DEVICE;
+        case FAULT_DISCONNECT:
+            return rule->site == FAULT_BROKER;
+        case FAULT_ERROR:
+        case FAULT_LATENCY:
+            return true;
+        case FAULT_KINDS:
+            break;
+    }
+
+    return false;
+}
+
+int8_t fault_parse(const char* value, struct Fault_Rule* rule) {
+    char text[128];
+    char* save;
+    char* target;
+    char* kind;
+    char* trigger;
+    char* amount;
+    char* end;
+
+    if (strlen(value) >= sizeof(text)) {
+        return CONFIG_ERR;
+    }
+    strcpy(text, value);
+    memset(rule, 0, sizeof(*rule));
+
+    target = strtok_r(text, " \t", &save);
+    kind = strtok_r(NULL, " \t", &save);
+    trigger = strtok_r(NULL, " \t", &save);
+    if (target == NULL || kind == NULL || trigger == NULL || !parse_target(target, rule)) {
+        return CONFIG_ERR;
+    }
+
+    for (rule->kind = 0; rule->kind < FAULT_KINDS; ++rule->kind) {
+        if (strcmp(kind, fault_kind_name(rule->kind)) == 0) {
+            break;
+        }
+    }
+
+    if (!valid_kind(rule)) {
+        return CONFIG_ERR;
+    }
+
+    if (strcmp(trigger, "every") == 0 || strcmp(trigger, "at") == 0) {
+        char* count = strtok_r(NULL, " \t", &save);
+        unsigned long number;
+
+        rule->trigger = strcmp(trigger, "every") == 0 ? FAULT_EVERY : FAULT_AT;
+        if (count == NULL || (number = strtoul(count, &end, 0)) == 0 || *end != '\0'
+            || number > UINT32_MAX) {
+            return CONFIG_ERR;
+        }
+        rule->count = (uint32_t)number;
+    } else {
+        rule->trigger = FAULT_PROBABILITY;
+        rule->probability = strtod(trigger, &end);
+        if (*end != '\0' || !(rule->probability > 0 && rule->probability <= 1)) {
+            return CONFIG_ERR;
+        }
+    }
+
+    rule->amount = rule->kind == FAULT_SHORT ? FAULT_SHORT_KEPT : 0;
+    if ((amount = strtok_r(NULL, " \t", &save)) != NULL) {
+        unsigned long number = strtoul(amount, &end, 0);
+
+        if ((rule->kind != FAULT_LATENCY && rule->kind != FAULT_SHORT) || *end != '\0'
+            || number > UINT32_MAX || strtok_r(NULL, " \t", &save) != NULL) {
+            return CONFIG_ERR;
+        }
+        rule->amount = (uint32_t)number;
+    }
+
+    return rule->kind == FAULT_LATENCY && rule->amount == 0 ? CONFIG_ERR : NOERR;
+}
+
+const char* fault_kind_name(enum Fault_Kind kind) {
+    switch (kind) {
+        case FAULT_CRC:
+            return "crc";
+        case FAULT_NACK:
+            return "nack";
+        case FAULT_SHORT:
+            return "short";
+        case FAULT_ERROR:
+            return "error";
+        case FAULT_LATENCY:
+            return "latency";
+        case FAULT_DISCONNECT:
+            return "disconnect";
+        case FAULT_KINDS:
+            break;
+    }
+
+    return "unknown";
+}
+
+void fault_inject_init(struct Fault_Injector* injector, const struct Fault_Rule* rules,
+                        int num_rules, uint64_t seed) {
+    memset(injector, 0, sizeof(*injector));
+    injector->num_rules = num_rules < FAULT_MAX_RULES ? num_rules : FAULT_MAX_RULES;
+    injector->seed = seed;
+
+    for (int i = 0; i < injector->num_rules; ++i) {
+        injector->rules[i] = rules[i];
+    }
+}
+
+/**
+ * @brief Mixes the value into a well distributed 64 bit number, SplitMix64's finalizer
+ *
+ * @param value the value to be mixed
+ * @return the mixed value
+ */
+static uint64_t mix(uint64_t value) {
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+/**
+ * @brief Counts a match of the rule for the device and decides whether it fires
+ *
+ * @param injector the injector
+ * @param rule the rule's index
+ * @param device_addr the device's hex address, FAULT_ANY_DEVICE for the broker
+ * @param random the out parameter for the match's random draw
+ * @return whether the fault is injected
+ */
+static bool fault_fires(struct Fault_Injector* injector, int rule, uint8_t device_addr,
+                        uint64_t* random) {
+    const struct Fault_Rule* config = &injector->rules[rule];
+    uint8_t slot = device_addr % FAULT_ADDRESSES;
+    uint64_t matched = atomic_fetch_add_explicit(&injector->matched[rule][slot], 1,
+                                                memory_order_relaxed) + 1;
+    bool fires = false;
+
+    *random = mix(injector->seed ^ ((uint64_t)rule << 56) ^ ((uint64_t)slot << 48) ^ matched);
+
+    switch (config->trigger) {
+        case FAULT_PROBABILITY:
+            //The top 53 bits give a uniform double in [0, 1)
+            fires = (double)(*random >> 11) * 0x1.0p-53 < config->probability;
+            break;
+        case FAULT_EVERY:
+            fires = matched % config->count == 0;
+            break;
+        case FAULT_AT:
+            fires = matched == config->count;
+            break;
+    }
+
+    if (fires) {
+        atomic_fetch_add_explicit(&injector->injected[rule], 1, memory_order_relaxed);
+    }
+    return fires;
+}
+
+int8_t fault_inject_bus(struct Fault_Injector* injector, uint8_t device_addr,
+                        enum Bus_Direction direction, uint8_t* data, uint16_t count, int8_t result) {
+    for (int i = 0; i < injector->num_rules; ++i) {
+        const struct Fault_Rule* rule = &injector->rules[i];
+        bool corrupts = rule->kind == FAULT_CRC || rule->kind == FAULT_SHORT;
+        uint64_t random;
+
+        if (rule->site != FAULT_DEVICE
+            || (rule->device_addr != FAULT_ANY_DEVICE && rule->device_addr != device_addr)) {
+            continue;
+        }
+
+        //Only reads that succeeded have bytes to corrupt, and only a transfer that
+        //succeeded can be refused
+        if ((corrupts && (direction != BUS_READ || count == 0))
+            || ((corrupts || rule->kind == FAULT_NACK) && result != NOERR)) {
+            continue;
+        }
+
+        if (!fault_fires(injector, i, device_addr, &random)) {
+            continue;
+        }
+
+        switch (rule->kind) {
+            case FAULT_CRC:
+                //A single flipped bit is always caught by the CRC
+                random %= (uint64_t)count * 8;
+                data[random / 8] ^= (uint8_t)(1U << (random % 8));
+                break;
+            case FAULT_NACK:
+                result = NACK_ERR;
+                break;
+            case FAULT_SHORT:
+                if (rule->amount < count) {
+                    memset(data + rule->amount, 0xFF, count - rule->amount);
+                }
+                break;
+            case FAULT_ERROR:
+                result = direction == BUS_READ ? READ_ERR : WRITE_ERR;
+                break;
+            case FAULT_LATENCY:
+                clock_source_sleep_us(rule->amount);
+                break;
+            case FAULT_DISCONNECT:
+            case FAULT_KINDS:
+                break;
+        }
+    }
+
+    return result;
+}
+
+int8_t fault_inject_broker(struct Fault_Injector* injector, bool* disconnect) {
+    int8_t result = NOERR;
+
+    *disconnect = false;
+    for (int i = 0; i < injector->num_rules; ++i) {
+        const struct Fault_Rule* rule = &injector->rules[i];
+        uint64_t random;
+
+        if (rule->site != FAULT_BROKER || !fault_fires(injector, i, FAULT_ANY_DEVICE, &random)) {
+            continue;
+        }
+
+        if (rule->kind == FAULT_LATENCY) {
+            clock_source_sleep_us(rule->amount);
+        } else if (rule->kind == FAULT_DISCONNECT) {
+            *disconnect = true;
+            result = WRITE_ERR;
+        } else {
+            result = WRITE_ERR;
+        }
+    }
+
+    return result;
+}
+
+uint64_t fault_injected(struct Fault_Injector* injector, int rule) {
+    return atomic_load_explicit(&injector->injected[rule], memory_order_relaxed);
+}
@@ -0,0 +1,161 @@
+#include "../include/filters.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+int8_t filter_parse(const char* value, struct Filter_Config* config) {
+    char reference[64];
+    char type[16];
+    char extra;
+    int channel;
+
+    if (sscanf(value, "%63s %15s %f %c", reference, type, &config->parameter, &extra) != 3
+        || !channel_parse(reference, strlen(reference), &config->device_addr, &channel)) {
+        return CONFIG_ERR;
+    }
+    config->channel = (uint8_t)channel;
+
+    if (strcmp(type, filter_name(FILTER_MEDIAN)) == 0) {
+        config->type = FILTER_MEDIAN;
+        return config->parameter >= 1 && config->parameter <= FILTER_MAX_WINDOW 
+            && (int)config->parameter == config->parameter && (int)config->parameter % 2 == 1
+            ? NOERR : CONFIG_ERR;
+    } else if (strcmp(type, filter_name(FILTER_EWMA)) == 0) {
+        config->type = FILTER_EWMA;
+        return config->parameter > 0 && config->parameter <= 1 ? NOERR : CONFIG_ERR;
+    } else if (strcmp(type, filter_name(FILTER_RATE)) == 0) {
+        config->type = FILTER_RATE;
+        return config->parameter > 0 ? NOERR : CONFIG_ERR;
+    }
+
+    return CONFIG_ERR;
+}
+
+void filter_chain_init(struct Filter_Chain* chain, const struct Filter_Config* configs,
+                        int num_filters) {
+    memset(chain, 0, sizeof(*chain));
+    chain->num_filters = num_filters < FILTER_MAX ? num_filters : FILTER_MAX;
+
+    for (int i = 0; i < chain->num_filters; ++i) {
+        chain->filters[i].config = configs[i];
+    }
+}
+
+/**
+ * @brief Adds the reading to the window and gets the window's median
+ *
+ * The window is at most FILTER_MAX_WINDOW long, so sorting a copy of it keeps
+ * each reading constant time
+ *
+ * @param filter the median filter
+ * @param value the reading
+ * @return the median, or the reading itself until the window is full
+ */
+static float median(struct Filter* filter, float value) {
+    uint8_t size = (uint8_t)filter->config.parameter;
+    float sorted[FILTER_MAX_WINDOW];
+
+    //Invalid readings are left out of the window so they can't become the median
+    if (!isnan(value)) {
+        filter->window[filter->head] = value;
+        filter->head = (uint8_t)((filter->head + 1) % size);
+        filter->count += filter->count < size;
+    }
+
+    //Until the window is full there isn't enough history to call a reading an outlier
+    if (filter->count < size) {
+        return value;
+    }
+
+    for (uint8_t i = 0; i < filter->count; ++i) {
+        float next = filter->window[i];
+        uint8_t j = i;
+
+        for (; j > 0 && sorted[j - 1] > next; --j) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = next;
+    }
+
+    return sorted[size / 2];
+}
+
+/**
+ * @brief Runs the reading through a single filter
+ *
+ * @param filter the filter
+ * @param value the reading
+ * @param time_ms the reading's monotonic time in milliseconds
+ * @return the filtered reading
+ */
+static float apply(struct Filter* filter, float value, uint64_t time_ms) {
+    float output;
+    float elapsed_s;
+
+    switch (filter->config.type) {
+        case FILTER_MEDIAN:
+            output = median(filter, value);
+            filter->rejected += !isnan(value) && output != value;
+            return output;
+        case FILTER_EWMA:
+            if (isnan(value)) {
+                filter->rejected += filter->has_value;
+            } else if (!filter->has_value) {
+                filter->value = value;
+                filter->has_value = true;
+            } else {
+                filter->value += filter->config.parameter * (value - filter->value);
+            }
+            return filter->has_value ? filter->value : NAN;
+        case FILTER_RATE:
+            if (isnan(value)) {
+                return value;
+            }
+
+            elapsed_s = (float)(time_ms - filter->time_ms) / 1000.0f;
+            if (filter->has_value && filter->held < FILTER_MAX_HELD
+                && fabsf(value - filter->value) > filter->config.parameter * elapsed_s) {
+                ++filter->held;
+                ++filter->rejected;
+                return filter->value;
+            }
+
+            filter->value = value;
+            filter->time_ms = time_ms;
+            filter->has_value = true;
+            filter->held = 0;
+            return value;
+    }
+
+    return value;
+}
+
+void filter_chain_apply(struct Filter_Chain* chain, struct Sensor_Data* sample) {
+    uint64_t time_ms = timespec_to_ms(&sample->monotonic);
+
+    for (int i = 0; i < chain->num_filters; ++i) {
+        struct Filter* filter = &chain->filters[i];
+
+        if (filter->config.device_addr != sample->device_addr 
+            || filter->config.channel >= sample->num_data) {
+            continue;
+        }
+
+        sample->data[filter->config.channel] = apply(filter, sample->data[filter->config.channel], 
+                                                     time_ms);
+    }
+}
+
+const char* filter_name(enum Filter_Type type) {
+    switch (type) {
+        case FILTER_MEDIAN:
+            return "median";
+        case FILTER_EWMA:
+            return "ewma";
+        case FILTER_RATE:
+            return "rate";
+    }
+
+    return "unknown";
+}
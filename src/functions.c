@@ -38,6 +38,17 @@ int8_t read_data_flag(bool* is_ready, uint8_t device_addr, int* fd) {
     }
 }
 
+int8_t read_measurement_state(bool* is_measuring, uint8_t device_addr, int* fd) {
+    switch (device_addr) {
+        case SEN55_ADDRESS:
+            return sen55_read_measurement_state(is_measuring, fd);
+        case SCD40_ADDRESS:
+            return scd40_read_measurement_state(is_measuring, fd);
+        default:
+            return ADDR_ERR;
+    }
+}
+
 int8_t read_into_buffer(float* data, size_t buffer_size, uint8_t device_addr, int* fd) {
     switch (device_addr) {
         case SEN55_ADDRESS:
@@ -49,6 +60,76 @@ int8_t read_into_buffer(float* data, size_t buffer_size, uint8_t device_addr, in
     }
 }
 
+const uint8_t* known_devices(int* num_devices) {
+    static const uint8_t ADDRESSES[] = {SEN55_ADDRESS, SCD40_ADDRESS};
+
+    *num_devices = sizeof(ADDRESSES) / sizeof(ADDRESSES[0]);
+    return ADDRESSES;
+}
+
+int channel_count(uint8_t device_addr) {
+    switch (device_addr) {
+        case SEN55_ADDRESS:
+            return SEN55_DATAPOINTS;
+        case SCD40_ADDRESS:
+            return SCD40_DATAPOINTS;
+        default:
+            return 0;
+    }
+}
+
+const struct Channel_Descriptor* channel_descriptor(uint8_t device_addr, int channel) {
+    if (channel < 0 || channel >= channel_count(device_addr)) {
+        return NULL;
+    }
+
+    switch (device_addr) {
+        case SEN55_ADDRESS:
+            return &sen55_channels[channel];
+        case SCD40_ADDRESS:
+            return &scd40_channels[channel];
+        default:
+            return NULL;
+    }
+}
+
+const char* channel_name(uint8_t device_addr, int channel) {
+    const struct Channel_Descriptor* descriptor = channel_descriptor(device_addr, channel);
+
+    return descriptor != NULL ? descriptor->key : NULL;
+}
+
+bool channel_parse(const char* reference, size_t length, uint8_t* device_addr, int* channel) {
+    int num_devices;
+    const uint8_t* addresses = known_devices(&num_devices);
+    const char* dot = memchr(reference, '.', length);
+
+    if (dot == NULL) {
+        return false;
+    }
+
+    for (int i = 0; i < num_devices; ++i) {
+        const char* device = device_name(addresses[i]);
+        size_t device_length = (size_t)(dot - reference);
+
+        if (strlen(device) != device_length || strncmp(reference, device, device_length) != 0) {
+            continue;
+        }
+
+        for (int j = 0; j < channel_count(addresses[i]); ++j) {
+            const char* name = channel_name(addresses[i], j);
+
+            if (strlen(name) == length - device_length - 1 && strncmp(dot + 1, name, strlen(name)) == 0) {
+                *device_addr = addresses[i];
+                *channel = j;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
 int8_t read_product_name(char* name, size_t name_length, uint8_t device_addr, int* fd) {
     switch (device_addr) {
         case SEN55_ADDRESS:
@@ -80,7 +161,33 @@ int8_t reset(uint8_t device_addr, int* fd) {
     switch (device_addr) {
         case SEN55_ADDRESS:
             return sen55_reset(fd);
+        case SCD40_ADDRESS:
+            return scd40_reinit(fd);
+        default:
+            return ADDR_ERR;
+    }
+}
+
+int8_t calibrate_delays(uint8_t device_addr, int* fd) {
+    switch (device_addr) {
+        case SEN55_ADDRESS:
+            return sen55_calibrate_delays(fd);
+        case SCD40_ADDRESS:
+            return scd40_calibrate_delays(fd);
         default:
             return ADDR_ERR;
     }
-}
\ No newline at end of file
+}
+
+void read_bus_stats(struct Sensirion_Stats* stats, uint8_t device_addr) {
+    switch (device_addr) {
+        case SEN55_ADDRESS:
+            sen55_read_bus_stats(stats);
+            break;
+        case SCD40_ADDRESS:
+            scd40_read_bus_stats(stats);
+            break;
+        default:
+            memset(stats, 0, sizeof(*stats));
+    }
+}
@@ -0,0 +1,308 @@
+#include "../include/history.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Gets the ring index of the reading at the given age
+ *
+ * @param series the device's series
+ * @param position the reading's position, 0 being the oldest
+ * @return the index into the series' columns
+ */
+static uint32_t ring_index(const struct History_Series* series, uint32_t position) {
+    return (series->head + series->capacity - series->count + position) % series->capacity;
+}
+
+/**
+ * @brief Finds the position of the oldest reading at or after the given time
+ *
+ * @param series the device's series
+ * @param time_ms the time in wall-clock milliseconds
+ * @return the reading's position, count if every reading is older
+ */
+static uint32_t lower_bound(const struct History_Series* series, uint64_t time_ms) {
+    uint32_t low = 0;
+    uint32_t high = series->count;
+
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+
+        if (series->timestamps[ring_index(series, middle)] < time_ms) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
+/**
+ * @brief Finds the position just past the newest reading at or before the given time
+ *
+ * @param series the device's series
+ * @param time_ms the time in wall-clock milliseconds
+ * @return the reading's position plus one, 0 if every reading is newer
+ */
+static uint32_t upper_bound(const struct History_Series* series, uint64_t time_ms) {
+    return time_ms == UINT64_MAX ? series->count : lower_bound(series, time_ms + 1);
+}
+
+/**
+ * @brief Scans the channel's readings between two positions, split where the ring
+ *          wraps so each scan covers contiguous memory
+ *
+ * @param series the device's series
+ * @param channel the index of the channel
+ * @param first the position of the first reading
+ * @param last the position just past the last reading
+ * @param threshold the exceedance threshold
+ * @param result the result the readings are added to
+ */
+static void scan_positions(const struct History_Series* series, int channel, uint32_t first,
+                           uint32_t last, float threshold, struct Scan_Result* result) {
+    while (first < last) {
+        uint32_t index = ring_index(series, first);
+        uint32_t length = last - first;
+
+        if (length > series->capacity - index) {
+            length = series->capacity - index;
+        }
+
+        scan_column(series->values[channel] + index, length, threshold, result);
+        first += length;
+    }
+}
+
+/**
+ * @brief Frees the series' columns
+ *
+ * @param series the series
+ */
+static void series_free(struct History_Series* series) {
+    free(series->timestamps);
+    for (int j = 0; j < series->num_channels; ++j) {
+        free(series->values[j]);
+    }
+
+    memset(series, 0, sizeof(*series));
+}
+
+/**
+ * @brief Allocates an empty series for the device
+ *
+ * @param series the series to be allocated
+ * @param device_addr the device's hex address on the I2C bus
+ * @param capacity the number of readings kept
+ * @return whether every column could be allocated, nothing is left allocated otherwise
+ */
+static bool series_alloc(struct History_Series* series, uint8_t device_addr, uint32_t capacity) {
+    memset(series, 0, sizeof(*series));
+    series->device_addr = device_addr;
+    series->num_channels = channel_count(device_addr);
+    series->capacity = capacity;
+
+    if ((series->timestamps = malloc(sizeof(uint64_t) * capacity)) == NULL) {
+        series_free(series);
+        return false;
+    }
+
+    for (int j = 0; j < series->num_channels; ++j) {
+        if ((series->values[j] = malloc(sizeof(float) * capacity)) == NULL) {
+            series_free(series);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int8_t history_init(struct History* history, const uint8_t* device_addrs,
+                    int num_devices, uint32_t capacity) {
+    memset(history, 0, sizeof(*history));
+
+    if (num_devices > HISTORY_MAX_SERIES || capacity == 0) {
+        return SIZE_ERR;
+    }
+
+    history->capacity = capacity;
+    for (int i = 0; i < num_devices; ++i) {
+        if (!series_alloc(&history->series[i], device_addrs[i], capacity)) {
+            history_free(history);
+            return INIT_ERR;
+        }
+        ++history->num_series;
+    }
+
+    return NOERR;
+}
+
+int8_t history_set_devices(struct History* history, const uint8_t* device_addrs, int num_devices) {
+    struct History updated = {.capacity = history->capacity};
+    int8_t result = NOERR;
+
+    if (num_devices > HISTORY_MAX_SERIES) {
+        return SIZE_ERR;
+    }
+
+    for (int i = 0; i < num_devices; ++i) {
+        struct History_Series* series = &updated.series[updated.num_series];
+        bool kept = false;
+
+        //A kept series moves over and is cleared from the old history so it isn't freed
+        for (int j = 0; j < history->num_series && !kept; ++j) {
+            if (history->series[j].timestamps != NULL
+                && history->series[j].device_addr == device_addrs[i]) {
+                *series = history->series[j];
+                memset(&history->series[j], 0, sizeof(history->series[j]));
+                kept = true;
+            }
+        }
+
+        if (kept || series_alloc(series, device_addrs[i], updated.capacity)) {
+            ++updated.num_series;
+        } else {
+            result = INIT_ERR;
+        }
+    }
+
+    history_free(history);
+    *history = updated;
+    return result;
+}
+
+void history_free(struct History* history) {
+    for (int i = 0; i < history->num_series; ++i) {
+        series_free(&history->series[i]);
+    }
+
+    memset(history, 0, sizeof(*history));
+}
+
+const struct History_Series* history_find(const struct History* history, uint8_t device_addr) {
+    for (int i = 0; i < history->num_series; ++i) {
+        if (history->series[i].device_addr == device_addr) {
+            return &history->series[i];
+        }
+    }
+
+    return NULL;
+}
+
+int8_t history_add(struct History* history, const struct Sensor_Data* sample) {
+    struct History_Series* series = (struct History_Series*)history_find(history, sample->device_addr);
+    uint64_t timestamp;
+
+    if (series == NULL) {
+        return ADDR_ERR;
+    }
+
+    //A wall clock stepped backwards must not break the ordering the searches rely on
+    timestamp = timespec_to_ms(&sample->realtime);
+    if (series->count > 0 && timestamp < series->timestamps[ring_index(series, series->count - 1)]) {
+        timestamp = series->timestamps[ring_index(series, series->count - 1)];
+    }
+
+    series->timestamps[series->head] = timestamp;
+    for (int j = 0; j < series->num_channels && j < sample->num_data; ++j) {
+        series->values[j][series->head] = sample->data[j];
+    }
+
+    series->head = (series->head + 1) % series->capacity;
+    if (series->count < series->capacity) {
+        ++series->count;
+    }
+
+    return NOERR;
+}
+
+bool history_latest(const struct History_Series* series, int channel, struct History_Point* point) {
+    uint32_t index;
+
+    if (channel < 0 || channel >= series->num_channels || series->count == 0) {
+        return false;
+    }
+
+    index = ring_index(series, series->count - 1);
+    point->timestamp_ms = series->timestamps[index];
+    point->value = series->values[channel][index];
+
+    return true;
+}
+
+uint32_t history_range(const struct History_Series* series, int channel, uint64_t from_ms,
+                        uint64_t to_ms, struct History_Point* points, uint32_t max_points) {
+    uint32_t num_points = 0;
+
+    if (channel < 0 || channel >= series->num_channels) {
+        return 0;
+    }
+
+    for (uint32_t i = lower_bound(series, from_ms); i < series->count && num_points < max_points; ++i) {
+        uint32_t index = ring_index(series, i);
+
+        if (series->timestamps[index] > to_ms) {
+            break;
+        }
+
+        points[num_points].timestamp_ms = series->timestamps[index];
+        points[num_points].value = series->values[channel][index];
+        ++num_points;
+    }
+
+    return num_points;
+}
+
+bool history_aggregate(const struct History_Series* series, int channel, uint64_t from_ms,
+                        uint64_t to_ms, float threshold, struct Scan_Result* result) {
+    scan_init(result);
+
+    if (channel < 0 || channel >= series->num_channels) {
+        return false;
+    }
+
+    scan_positions(series, channel, lower_bound(series, from_ms), upper_bound(series, to_ms),
+                   threshold, result);
+    return true;
+}
+
+uint32_t history_downsample(const struct History_Series* series, int channel, uint64_t from_ms,
+                            uint64_t to_ms, uint32_t step_ms, struct History_Bucket* buckets,
+                            uint32_t max_buckets) {
+    uint32_t num_buckets = 0;
+    uint32_t end = upper_bound(series, to_ms);
+
+    if (channel < 0 || channel >= series->num_channels || step_ms == 0) {
+        return 0;
+    }
+
+    //Each step is found by binary search and scanned as a whole
+    for (uint32_t first = lower_bound(series, from_ms); first < end && num_buckets < max_buckets;) {
+        uint64_t timestamp = series->timestamps[ring_index(series, first)];
+        uint64_t start_ms = from_ms + (timestamp - from_ms) / step_ms * step_ms;
+        uint32_t last = start_ms + step_ms > start_ms && start_ms + step_ms <= to_ms
+                      ? lower_bound(series, start_ms + step_ms)
+                      : end;
+        struct Scan_Result result;
+
+        scan_init(&result);
+        scan_positions(series, channel, first, last, NAN, &result);
+        first = last;
+
+        //NAN readings are left out of the summary
+        if (result.count == 0) {
+            continue;
+        }
+
+        buckets[num_buckets].start_ms = start_ms;
+        buckets[num_buckets].count = result.count;
+        buckets[num_buckets].min = result.min;
+        buckets[num_buckets].max = result.max;
+        buckets[num_buckets].mean = scan_mean(&result);
+        ++num_buckets;
+    }
+
+    return num_buckets;
+}
@@ -0,0 +1,353 @@
+#include "../include/i2c_bus.h"
+#include "../include/fault_inject.h"
+
+/*******************************************************************************
+*                                Macro Functions                               *
+*******************************************************************************/
+
+#define LOCK_BUS() (pthread_mutex_lock(&bus_lock))
+#define UNLOCK_BUS() (pthread_mutex_unlock(&bus_lock))
+
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+struct I2C_Bus {
+    uint32_t adapter_num;
+    int fd;
+    int ref_count;
+};
+
+/*******************************************************************************
+*                                Global Variables                              *
+*******************************************************************************/
+
+static struct I2C_Bus buses[MAX_BUSES];
+static pthread_mutex_t bus_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct Bus_Capture* capture = NULL;
+static struct Bus_Capture* replay = NULL;
+static struct Fault_Injector* injector = NULL;
+static const struct I2C_Backend* backend = NULL;
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Transfers a single message to or from the device at the given address
+ *
+ * @param data the message buffer
+ * @param count the number of bytes in the message
+ * @param device_addr the device's hex address on the I2C bus
+ * @param flags 0 for a write or I2C_M_RD for a read
+ * @param fd the file descriptor of the I2C adapter
+ * @return whether the transfer succeeded
+ */
+static bool i2c_bus_transfer(uint8_t* data, uint16_t count, uint8_t device_addr,
+                            uint16_t flags, int* fd) {
+    struct i2c_msg message = {
+        .addr = device_addr,
+        .flags = flags,
+        .len = count,
+        .buf = data,
+    };
+    struct i2c_rdwr_ioctl_data transfer = {
+        .msgs = &message,
+        .nmsgs = 1,
+    };
+
+    return ioctl(*fd, I2C_RDWR, &transfer) == 1;
+}
+
+/**
+ * @brief Replays the device's next captured transaction
+ *
+ * @param data the message buffer, filled with the captured bytes for a read
+ * @param count the number of bytes in the message
+ * @param device_addr the device's hex address on the I2C bus
+ * @param direction whether the message is written or read
+ * @param error the error if the transaction doesn't match the capture
+ * @return the captured transaction's result, or the error if the device has none
+ *          left, the direction or size differs, or a different command was written
+ */
+static int8_t i2c_bus_replay_transfer(uint8_t* data, uint16_t count, uint8_t device_addr,
+                                      enum Bus_Direction direction, int8_t error) {
+    const struct Bus_Capture_Record* record = bus_capture_next(replay, device_addr, direction);
+
+    if (record == NULL || record->count != count) {
+        return error;
+    }
+
+    //A different command means the replay has diverged from the capture
+    if (direction == BUS_WRITE && record->result == NOERR
+        && memcmp(record->data, data, count < BUS_CAPTURE_MAX_BYTES ? count : BUS_CAPTURE_MAX_BYTES) != 0) {
+        return error;
+    }
+
+    if (direction == BUS_READ && record->result == NOERR) {
+        memcpy(data, record->data, count < BUS_CAPTURE_MAX_BYTES ? count : BUS_CAPTURE_MAX_BYTES);
+    }
+
+    return record->result;
+}
+
+/**
+ * @brief Opens the adapter's device file, or /dev/null while replaying or simulating
+ *
+ * @param adapter_num the I2C adapter to open
+ * @return the file descriptor or -1 if it couldn't be opened
+ */
+static int i2c_bus_open_adapter(uint32_t adapter_num) {
+    char filename[20];
+
+    if (replay != NULL || backend != NULL) {
+        return open("/dev/null", O_RDWR);
+    }
+
+    snprintf(filename, 19, "/dev/i2c-%d", adapter_num);
+    return open(filename, O_RDWR);
+}
+
+int i2c_bus_open(uint32_t adapter_num, int* fd) {
+    struct I2C_Bus* free_slot = NULL;
+
+    LOCK_BUS();
+    for (int i = 0; i < MAX_BUSES; ++i) {
+        if (buses[i].ref_count > 0 && buses[i].adapter_num == adapter_num) {
+            ++buses[i].ref_count;
+            *fd = buses[i].fd;
+            UNLOCK_BUS();
+            return NOERR;
+        }
+
+        if (buses[i].ref_count == 0 && free_slot == NULL) {
+            free_slot = &buses[i];
+        }
+    }
+
+    if (free_slot == NULL) {
+        UNLOCK_BUS();
+        return INIT_ERR;
+    }
+
+    if ((*fd = i2c_bus_open_adapter(adapter_num)) < 0) {
+        UNLOCK_BUS();
+        return INIT_ERR;
+    }
+
+    free_slot->adapter_num = adapter_num;
+    free_slot->fd = *fd;
+    free_slot->ref_count = 1;
+    UNLOCK_BUS();
+
+    return NOERR;
+}
+
+void i2c_bus_close(int* fd) {
+    LOCK_BUS();
+    for (int i = 0; i < MAX_BUSES; ++i) {
+        if (buses[i].ref_count > 0 && buses[i].fd == *fd) {
+            if (--buses[i].ref_count == 0) {
+                close(buses[i].fd);
+                buses[i].fd = -1;
+            }
+            break;
+        }
+    }
+    UNLOCK_BUS();
+
+    *fd = -1;
+}
+
+/**
+ * @brief Writes the value to one of the driver's sysfs files
+ *
+ * @param driver the driver's sysfs directory
+ * @param file the file's name
+ * @param value the value to be written
+ * @return whether the whole value was written
+ */
+static bool i2c_bus_sysfs_write(const char* driver, const char* file, const char* value) {
+    char path[PATH_MAX];
+    ssize_t written;
+    int fd;
+
+    if (snprintf(path, sizeof(path), "%s/%s", driver, file) >= (int)sizeof(path)
+        || (fd = open(path, O_WRONLY)) < 0) {
+        return false;
+    }
+
+    written = write(fd, value, strlen(value));
+    close(fd);
+    return written == (ssize_t)strlen(value);
+}
+
+/**
+ * @brief Finds the number of the adapter the controller has registered
+ *
+ * @param controller the controller's sysfs directory
+ * @param adapter_num the out parameter for the adapter's number
+ * @return whether the controller has an adapter
+ */
+static bool i2c_bus_find_adapter(const char* controller, uint32_t* adapter_num) {
+    DIR* directory = opendir(controller);
+    struct dirent* entry;
+    bool found = false;
+    char end;
+
+    if (directory == NULL) {
+        return false;
+    }
+
+    while (!found && (entry = readdir(directory)) != NULL) {
+        found = sscanf(entry->d_name, "i2c-%u%c", adapter_num, &end) == 1;
+    }
+    closedir(directory);
+
+    return found;
+}
+
+/**
+ * @brief Unbinds the adapter's controller from its driver and binds it again
+ *
+ * The adapter's sysfs directory sits inside its controller's, whose driver link
+ * names the driver to rebind it to. Nothing may hold the adapter open, or the
+ * unbind waits for it to be closed
+ *
+ * @param adapter_num the I2C adapter to reset, set to its number once bound again
+ * @return whether the controller was unbound and bound again
+ */
+static bool i2c_bus_rebind(uint32_t* adapter_num) {
+    char path[PATH_MAX];
+    char controller[PATH_MAX];
+    char driver[PATH_MAX];
+    char* name;
+
+    snprintf(path, sizeof(path), I2C_SYSFS_ADAPTER, *adapter_num);
+    if (realpath(path, controller) == NULL || (name = strrchr(controller, '/')) == NULL) {
+        return false;
+    }
+    *name = '\0';
+
+    if (snprintf(path, sizeof(path), "%s/driver", controller) >= (int)sizeof(path)
+        || realpath(path, driver) == NULL || (name = strrchr(controller, '/')) == NULL) {
+        return false;
+    }
+
+    //A dynamically numbered adapter can come back as a different i2c-N
+    return i2c_bus_sysfs_write(driver, "unbind", name + 1)
+        && i2c_bus_sysfs_write(driver, "bind", name + 1)
+        && i2c_bus_find_adapter(controller, adapter_num);
+}
+
+/**
+ * @brief Points the descriptor at /dev/null, keeping its number for the devices sharing it
+ *
+ * @param fd the descriptor to be released
+ * @return whether the descriptor was released
+ */
+static bool i2c_bus_release(int fd) {
+    int null_fd = open("/dev/null", O_RDWR);
+    bool released;
+
+    if (null_fd < 0) {
+        return false;
+    }
+
+    released = dup2(null_fd, fd) >= 0;
+    close(null_fd);
+    return released;
+}
+
+int8_t i2c_bus_reset_adapter(int* fd) {
+    int new_fd;
+
+    LOCK_BUS();
+    for (int i = 0; i < MAX_BUSES; ++i) {
+        if (buses[i].ref_count > 0 && buses[i].fd == *fd) {
+            if (!i2c_bus_replaying()
+                && (!i2c_bus_release(buses[i].fd) || !i2c_bus_rebind(&buses[i].adapter_num))) {
+                break;
+            }
+
+            if ((new_fd = i2c_bus_open_adapter(buses[i].adapter_num)) < 0) {
+                break;
+            }
+
+            if (dup2(new_fd, buses[i].fd) < 0) {
+                close(new_fd);
+                break;
+            }
+
+            close(new_fd);
+            UNLOCK_BUS();
+            return NOERR;
+        }
+    }
+    UNLOCK_BUS();
+
+    return INIT_ERR;
+}
+
+int8_t i2c_bus_write(uint8_t* data, uint16_t count, uint8_t device_addr, int* fd) {
+    int8_t result = NOERR;
+
+    if (replay != NULL) {
+        result = i2c_bus_replay_transfer(data, count, device_addr, BUS_WRITE, WRITE_ERR);
+    } else if (backend != NULL) {
+        result = backend->write(backend->context, *fd, device_addr, data, count);
+    } else if (!i2c_bus_transfer(data, count, device_addr, 0, fd)) {
+        result = errno == ENXIO || errno == EREMOTEIO ? NACK_ERR : WRITE_ERR;
+    }
+
+    if (injector != NULL) {
+        result = fault_inject_bus(injector, device_addr, BUS_WRITE, data, count, result);
+    }
+
+    if (capture != NULL) {
+        bus_capture_add(capture, device_addr, BUS_WRITE, data, count, result);
+    }
+    return result;
+}
+
+int8_t i2c_bus_read(uint8_t* data, uint16_t count, uint8_t device_addr, int* fd) {
+    int8_t result = NOERR;
+
+    if (replay != NULL) {
+        result = i2c_bus_replay_transfer(data, count, device_addr, BUS_READ, READ_ERR);
+    } else if (backend != NULL) {
+        result = backend->read(backend->context, *fd, device_addr, data, count);
+    } else if (!i2c_bus_transfer(data, count, device_addr, I2C_M_RD, fd)) {
+        //Adapters report a missing acknowledge as one or the other
+        result = errno == ENXIO || errno == EREMOTEIO ? NACK_ERR : READ_ERR;
+    }
+
+    if (injector != NULL) {
+        result = fault_inject_bus(injector, device_addr, BUS_READ, data, count, result);
+    }
+
+    if (capture != NULL) {
+        bus_capture_add(capture, device_addr, BUS_READ, data, count, result);
+    }
+    return result;
+}
+
+void i2c_bus_capture(struct Bus_Capture* bus_capture) {
+    capture = bus_capture;
+}
+
+void i2c_bus_replay(struct Bus_Capture* bus_capture) {
+    replay = bus_capture;
+}
+
+void i2c_bus_simulate(const struct I2C_Backend* i2c_backend) {
+    backend = i2c_backend;
+}
+
+bool i2c_bus_replaying(void) {
+    return replay != NULL || backend != NULL;
+}
+
+void i2c_bus_inject(struct Fault_Injector* fault_injector) {
+    injector = fault_injector;
+}
@@ -1,36 +1,62 @@
 #include <bits/time.h>
 #include <bits/types/struct_itimerspec.h>
 #include <sys/timerfd.h>
+#include <sys/eventfd.h>
 #include <sys/epoll.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <signal.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include <regex.h>
 #include <cjson/cJSON.h>
 #include "MQTTClient.h"
-#include "../include/address.h"
+#include "../include/config.h"
 #include "../include/device_io.h"
 #include "../include/functions.h"
+#include "../include/sensor_data.h"
+#include "../include/record_join.h"
+#include "../include/timing_stats.h"
+#include "../include/realtime.h"
+#include "../include/recovery.h"
+#include "../include/backlog.h"
+#include "../include/delivery.h"
+#include "../include/topics.h"
+#include "../include/shm_writer.h"
+#include "../include/history.h"
+#include "../include/query_server.h"
+#include "../include/columnar.h"
+#include "../include/derived.h"
+#include "../include/alerts.h"
+#include "../include/filters.h"
+#include "../include/arena.h"
+#include "../include/i2c_bus.h"
+#include "../include/bus_capture.h"
+#include "../include/fault_inject.h"
+#ifdef ALLOC_COUNT
+#include "../include/alloc_count.h"
+#endif
 
 /*******************************************************************************
 *                              Defined Constants                               *
 *******************************************************************************/
 
-#define DEVICE_COUNT 2
-#define CLIENTID "sensor_pub"
-#define TOPIC "sensors/data"
-#define QOS 1
 #define TIMEOUT 10000L
-#define WAIT_TIME 5
+#define CONNECT_TIMEOUT 5
+#define RECONNECT_MIN_BACKOFF_MS 1000
+#define RECONNECT_MAX_BACKOFF_MS 60000
+#define BACKLOG_BATCH 32
+#define MAX_EVENTS (CONFIG_MAX_DEVICES + QUERY_MAX_CLIENTS + 2)
+//Between the workers' ids and the query server's
+#define DELIVERY_EVENT_ID 0x8000U
+#define MESSAGE_ARENA_SIZE (64 * 1024)
+#define PAYLOAD_SIZE 8192
+#define ALLOC_WARMUP_RECORDS 24
 #define SEN55_ADDR 0x69U
 #define SCD40_ADDR 0x62U
-#define ADAPTER_NUM 1
-
-static const uint8_t DEVICE_ADDRS[DEVICE_COUNT] = {SCD40_ADDR, SEN55_ADDR};
-static const uint8_t DATAPOINTS[DEVICE_COUNT] = {SCD40_DATAPOINTS, SEN55_DATAPOINTS};
 
 /*******************************************************************************
 *                                Macro Functions                               *
@@ -41,27 +67,89 @@ static const uint8_t DATAPOINTS[DEVICE_COUNT] = {SCD40_DATAPOINTS, SEN55_DATAPOI
 #define LOCK_MUTEX(x) (pthread_mutex_lock(&x))
 #define UNLOCK_MUTEX(x) (pthread_mutex_unlock(&x))
 
+/*******************************************************************************
+*                                    Structs                                   *
+*******************************************************************************/
+
+/**
+ * @brief A slot for a device's sensor worker
+ * 
+ * The worker only reads the device and calibrate fields as it starts, after which
+ * only main uses them. A new sampling period and the stop flag are written by main
+ * before it signals the worker's control_fd, which wakes the worker to apply them.
+ * Everything after them is only used by main
+ */
+struct Worker {
+    bool active;
+    pthread_t thread;
+    int pipe_fds[2];
+    int control_fd;
+    struct Device_Config device;
+    bool calibrate;
+    _Atomic uint32_t period;
+    volatile sig_atomic_t stop;
+
+    bool has_sequence;
+    uint32_t last_sequence;
+    struct Timing_Stats timing;
+    struct Recovery_Stats recovery;
+    struct Sensirion_Stats bus;
+};
+
+/**
+ * @brief The client and the state of its reconnection to the server
+ */
+struct Connection {
+    MQTTClient client;
+    bool connected;
+    uint32_t attempts;
+    uint64_t retry_ms;
+    unsigned int seed;
+};
+
 /*******************************************************************************
 *                                Global Variables                              *
 *******************************************************************************/
 
 //Globals for threading
 volatile sig_atomic_t sigint_recieved = 0;
+volatile sig_atomic_t keep_measuring = 0;
+volatile sig_atomic_t reload_requested = 0;
+volatile sig_atomic_t connection_lost = 0;
 pthread_mutex_t lock;
-int pipe_fds[DEVICE_COUNT][2];
-
-//Globals for the MQTT Server and logging
-MQTTClient_deliveryToken delivered_token;
+struct Worker workers[CONFIG_MAX_DEVICES];
+struct timespec start_time;
+
+//Globals for the configuration, MQTT Server and logging
+struct Config config;
+const char* config_path = CONFIG_PATH;
+struct Backlog backlog;
+struct Delivery_Tracker deliveries;
+int delivery_fd = -1;
+struct Topic_Aliases aliases;
+struct Shm_Table* shm_table = NULL;
+struct History history;
+struct Query_Server query_server = {.listen_fd = -1};
+struct Column_Writer exporters[CONFIG_MAX_DEVICES];
+int num_exporters = 0;
+struct Derived derived;
+struct Alert_Engine alert_engine;
+struct Filter_Chain filter_chain;
+struct Bus_Capture bus_capture;
+struct Fault_Injector fault_injector;
+//Only read at startup, a reload can't move threads that are already running
+struct Realtime_Config realtime_config;
 FILE* LOG_FILE;
 
-/*******************************************************************************
-*                                    Structs                                   *
-*******************************************************************************/
+//Every JSON message is built in the arena and printed into the payload buffer,
+//so nothing is allocated per message once the publisher has started
+struct Arena message_arena;
+char payload_buffer[PAYLOAD_SIZE];
 
-struct Sensor_Data {
-    int num_data;
-    float* data;
-};
+#ifdef ALLOC_COUNT
+uint32_t warmup_records = 0;
+uint64_t steady_allocations = 0;
+#endif
 
 /*******************************************************************************
 *                            Function Implementations                          *
@@ -72,12 +160,12 @@ struct Sensor_Data {
  * 
  */
 void print_timestamp(void) {
-    time_t raw_time;
+    struct timespec now;
     struct tm time_info;
     struct tm* result;
 
-    time(&raw_time);
-    result = localtime_r(&raw_time, &time_info);
+    clock_source_now(CLOCK_REALTIME, &now);
+    result = localtime_r(&now.tv_sec, &time_info);
 
     if (result == NULL) {
         perror("Failed to get local time");
@@ -91,60 +179,188 @@ void print_timestamp(void) {
  * @brief Handles when the user interupts the publish cycle
  * 
  * Increments the sigint_recieved flag to tell the main loop to disconnect and
- * clean up
+ * clean up. SIGTERM leaves the devices measuring so a restarted publisher can
+ * adopt them without losing their warm-up, and SIGHUP asks the main loop to
+ * reload the configuration file
  * 
  * @param signum 
  */
-void signal_handler(int signum __attribute__((unused))) {
+void signal_handler(int signum) {
+    if (signum == SIGHUP) {
+        reload_requested = 1;
+        return;
+    }
+
+    if (signum == SIGTERM) {
+        keep_measuring = 1;
+    }
+
     sigint_recieved = 1;
 }
 
 /**
- * @brief Turns the inputted data into a JSON string
+ * @brief Finds the device's sample in the record
+ * 
+ * @param record the joined record
+ * @param device_addr the device's hex address on the I2C bus
+ * @return the sample or NULL if the device isn't joined or is missing
+ */
+const struct Sensor_Data* record_sample(const struct Joined_Record* record, uint8_t device_addr) {
+    for (int i = 0; i < record->num_devices; ++i) {
+        if (record->samples[i].device_addr == device_addr) {
+            return record->states[i] == FIELD_MISSING ? NULL : &record->samples[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Adds the acquisition metadata of each device's sample in the record to the JSON
+ * 
+ * Each device is marked as fresh, stale, or missing so consumers can tell whether
+ * its fields were read during the record's time bucket
+ * 
+ * @param root the JSON object to add the metadata to
+ * @param record the joined record
+ */
+void add_sample_metadata(cJSON* root, struct Joined_Record* record) {
+    static const char* STATE_NAMES[] = {
+        [FIELD_MISSING] = "Missing",
+        [FIELD_STALE] = "Stale",
+        [FIELD_FRESH] = "Fresh",
+    };
+    cJSON* metadata = cJSON_AddObjectToObject(root, "Samples");
+
+    for (int i = 0; i < record->num_devices; ++i) {
+        struct Sensor_Data* sample = &record->samples[i];
+        cJSON* device = cJSON_AddObjectToObject(metadata, device_name(sample->device_addr));
+
+        cJSON_AddStringToObject(device, "State", STATE_NAMES[record->states[i]]);
+        if (record->states[i] == FIELD_MISSING) {
+            continue;
+        }
+
+        cJSON_AddNumberToObject(device, "Sequence", sample->sequence);
+        cJSON_AddNumberToObject(device, "Monotonic", timespec_to_ms(&sample->monotonic));
+        cJSON_AddNumberToObject(device, "Timestamp", timespec_to_ms(&sample->realtime));
+
+        if (config.timing_metadata) {
+            cJSON_AddNumberToObject(device, "Lateness", timing_lateness_us(sample));
+            cJSON_AddNumberToObject(device, "Overruns", sample->overruns);
+        }
+    }
+}
+
+/**
+ * @brief Allocates cJSON's nodes from the message arena
+ * 
+ * @param size the size of the allocation
+ * @return the allocation or NULL once the arena is exhausted
+ */
+void* json_alloc(size_t size) {
+    return arena_alloc(&message_arena, size);
+}
+
+/**
+ * @brief Leaves cJSON's nodes in the message arena until it is reset
+ * 
+ * @param pointer the allocation, unused
+ */
+void json_free(void* pointer __attribute__((unused))) {}
+
+/**
+ * @brief Routes every cJSON allocation into the message arena
+ * 
+ * @return SIZE_ERR if the arena couldn't be allocated, NOERR otherwise
+ */
+int8_t initialize_json(void) {
+    cJSON_Hooks hooks = {.malloc_fn = json_alloc, .free_fn = json_free};
+
+    if (arena_init(&message_arena, MESSAGE_ARENA_SIZE) != NOERR) {
+        return SIZE_ERR;
+    }
+
+    cJSON_InitHooks(&hooks);
+    return NOERR;
+}
+
+/**
+ * @brief Prints the JSON built in the message arena and resets the arena
+ * 
+ * The tree isn't deleted node by node, resetting the arena frees all of it
+ * 
+ * @param root the JSON object built in the message arena
+ * @param json the out parameter for the JSON string
+ * @param size the size of json
+ * @param format whether the JSON is indented
+ * @return SIZE_ERR if the arena or json ran out of room, NOERR otherwise
+ */
+int8_t print_json(cJSON* root, char* json, size_t size, bool format) {
+    bool printed = root != NULL && !message_arena.overflowed
+                && cJSON_PrintPreallocated(root, json, (int)size, format);
+
+    arena_reset(&message_arena);
+    return printed ? NOERR : SIZE_ERR;
+}
+
+/**
+ * @brief Turns the joined record into a JSON string
  * 
- * Currently only indecies 0-8 are being inputted
+ * The readings are keyed by their channel table labels, in the order of known_devices()
  * 
- * @param json the output JSON string variable
- * @param data the collected data from the sensors
- * @return PNTR_ERR if json is NULL, NOERR otherwise
+ * @param json the out parameter for the JSON string
+ * @param size the size of json
+ * @param record the record holding a sample from every device
+ * @return PNTR_ERR if json is NULL, SIZE_ERR if the JSON doesn't fit, NOERR otherwise
  */
-int make_json(char** json, float* data) {
+int make_json(char* json, size_t size, struct Joined_Record* record) {
 
         if (json == NULL) {
             return PNTR_ERR;
         }
 
-        cJSON* root = cJSON_CreateObject();
-        cJSON_AddNumberToObject(root, "Mass Concentration PM1.0", data[0]);
-        cJSON_AddNumberToObject(root, "Mass Concentration PM2.5", data[1]);
-        cJSON_AddNumberToObject(root, "Mass Concentration PM4.0", data[2]);
-        cJSON_AddNumberToObject(root, "Mass Concentration PM10", data[3]);
-        cJSON_AddNumberToObject(root, "Ambient Humidity", data[4]);
-        cJSON_AddNumberToObject(root, "Ambient Temperature", data[5]);
-        cJSON_AddNumberToObject(root, "VOC Index", data[6]);
-        cJSON_AddNumberToObject(root, "NOx Index", data[7]);
-        cJSON_AddNumberToObject(root, "CO2", data[8]);
+        int num_devices;
+        const uint8_t* addresses = known_devices(&num_devices);
 
-        char* json_str = cJSON_Print(root);
+        //Every labelled channel is written, missing devices' as NAN which prints as null
+        cJSON* root = cJSON_CreateObject();
+        for (int i = 0; i < num_devices; ++i) {
+            const struct Sensor_Data* sample = record_sample(record, addresses[i]);
 
-        *json = malloc(strlen(json_str) + 1);
-        strcpy(*json, json_str);
+            for (int j = 0; j < channel_count(addresses[i]); ++j) {
+                const char* label = channel_descriptor(addresses[i], j)->label;
 
-        free(json_str);
-        cJSON_Delete(root);
+                if (label != NULL) {
+                    cJSON_AddNumberToObject(root, label, sample != NULL ? sample->data[j] : NAN);
+                }
+            }
+        }
+        if (config.derived_metrics) {
+            for (int i = 0; i < DERIVED_METRICS; ++i) {
+                cJSON_AddNumberToObject(root, derived_label(i), record->derived.values[i]);
+            }
+        }
+        add_sample_metadata(root, record);
 
-        return NOERR;
+        return print_json(root, json, size, true);
 }
 
 /**
  * @brief The delivered callback which is called whenever a payload is delievered
  *          to the server
  * 
+ * Runs on the client's thread, so the token is only handed to the main loop,
+ * which is woken through delivery_fd
+ * 
  * @param context 
  * @param token 
  */
 void delivered(void* context __attribute__((unused)), MQTTClient_deliveryToken token) {
-    delivered_token = token;
+    uint64_t one = 1;
+
+    delivery_confirm(&deliveries, token);
+    (void)write(delivery_fd, &one, sizeof(one));
 }
 
 /**
@@ -173,6 +389,8 @@ int msgarrvd(void* context __attribute__((unused)), char* topic_name,
  * @brief The connection lost callback which is used whenever the connection to 
  *          the server is lost
  * 
+ * Runs on the client's thread, so it only flags the main loop to start reconnecting
+ * 
  * @param context 
  * @param cause 
  */
@@ -180,18 +398,57 @@ void connlost(void* context __attribute__((unused)), char* cause) {
     print_timestamp();
     fprintf(LOG_FILE, "Connection Lost!\nCause: %s\n", cause);
     fflush(LOG_FILE);
+    connection_lost = 1;
+}
+
+/**
+ * @brief Arms the timer so it expires every period in phase with start_time
+ * 
+ * The absolute first expiration is left in timerspec->it_value so the scheduled
+ * time of every later expiration is known
+ * 
+ * @param timer_fd the file descriptor for the timer
+ * @param timerspec the timer object
+ * @param period the sampling period in seconds
+ * @param immediate whether the first expiration is the latest period boundary 
+ *          instead of the next one
+ * @return errno if the timer couldn't be set, NOERR otherwise
+ */
+int arm_timer(int timer_fd, struct itimerspec* timerspec, uint32_t period, bool immediate) {
+    struct timespec now;
+    time_t elapsed;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    elapsed = now.tv_sec - start_time.tv_sec;
+
+    timerspec->it_value = start_time;
+    timerspec->it_value.tv_sec += (elapsed / period + (immediate ? 0 : 1)) * period;
+    timerspec->it_interval.tv_nsec = 0;
+    timerspec->it_interval.tv_sec = period;
+
+    if ((timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, timerspec, NULL)) < 0) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Failed to set timer time, returned with error %d\n", errno);
+        fflush(LOG_FILE);
+        return errno;
+    }
+
+    return NOERR;
 }
 
 /**
  * @brief Create a timer object for each sensor
  * 
+ * Both the timer and the worker's control eventfd are added to the epoll
+ * 
  * @param timer_fd the file descriptor for the timer
  * @param epoll_fd the file descriptor for the epoll
- * @param event the epoll_event for the timer event
- * @param timerspec the timer object
+ * @param control_fd the worker's control eventfd
  * @return errno if the timer epoll couldn't be initialized, NOERR otherwise
  */
-int create_timer(int* timer_fd, int* epoll_fd, struct epoll_event* event, struct itimerspec* timerspec) {
+int create_timer(int* timer_fd, int* epoll_fd, int control_fd) {
+    struct epoll_event event;
+
     if ((*timer_fd = timerfd_create(CLOCK_MONOTONIC, 0)) == -1) {
         print_timestamp();
         fprintf(LOG_FILE, "Failed to create timerfd, returned with error %d\n", errno);
@@ -199,28 +456,24 @@ int create_timer(int* timer_fd, int* epoll_fd, struct epoll_event* event, struct
         return errno;
     }
 
-    timerspec->it_interval.tv_nsec = 0;
-    timerspec->it_interval.tv_sec = WAIT_TIME;
-    timerspec->it_value.tv_nsec = 0;
-    timerspec->it_value.tv_sec = WAIT_TIME;
-
-    if ((timerfd_settime(*timer_fd, 0, timerspec, NULL)) < 0) {
+    if ((*epoll_fd = epoll_create1(0)) == -1) {
         print_timestamp();
-        fprintf(LOG_FILE, "Failed to set timer time, returned with error %d\n", errno);
+        fprintf(LOG_FILE, "failed to create epoll, returned with error %d\n", errno);
         fflush(LOG_FILE);
         return errno;
     }
 
-    if ((*epoll_fd = epoll_create1(0)) == -1) {
+    event.events = EPOLLIN;
+    event.data.fd = *timer_fd;
+    if ((epoll_ctl(*epoll_fd, EPOLL_CTL_ADD, *timer_fd, &event)) == -1) {
         print_timestamp();
-        fprintf(LOG_FILE, "failed to create epoll, returned with error %d\n", errno);
+        fprintf(LOG_FILE, "Failed epoll_ctl, returned with error %d\n", errno);
         fflush(LOG_FILE);
         return errno;
     }
 
-    event->events = EPOLLIN;
-    event->data.fd = *timer_fd;
-    if ((epoll_ctl(*epoll_fd, EPOLL_CTL_ADD, *timer_fd, event)) == -1) {
+    event.data.fd = control_fd;
+    if ((epoll_ctl(*epoll_fd, EPOLL_CTL_ADD, control_fd, &event)) == -1) {
         print_timestamp();
         fprintf(LOG_FILE, "Failed epoll_ctl, returned with error %d\n", errno);
         fflush(LOG_FILE);
@@ -230,117 +483,293 @@ int create_timer(int* timer_fd, int* epoll_fd, struct epoll_event* event, struct
     return NOERR;
 }
 
+/**
+ * @brief Wakes the worker to apply its updated device configuration or stop flag
+ * 
+ * @param worker the worker's slot
+ */
+void signal_worker(struct Worker* worker) {
+    uint64_t one = 1;
+
+    (void)write(worker->control_fd, &one, sizeof(one));
+}
+
+/**
+ * @brief Takes a recovery step and puts the device back into Measurement-Mode
+ * 
+ * A reset leaves the device idle, and a glitch may have too, so the device's state
+ * is probed after every step and its measurements restarted if needed
+ * 
+ * @param step the recovery step to take
+ * @param device the device's configuration
+ * @param device_fd the opened file descriptor for the I2C device
+ * @return an error if the step or restarting the measurements failed, NOERR otherwise
+ */
+int8_t recover_device(enum Recovery_Step step, const struct Device_Config* device, int* device_fd) {
+    bool is_measuring = false;
+    int8_t error = NOERR;
+
+    switch (step) {
+        case RECOVERY_REOPEN:
+            device_free(device->address, device_fd);
+            error = device_init(device->adapter_num, device->address, device_fd);
+            break;
+        case RECOVERY_RESET:
+            error = reset(device->address, device_fd);
+            break;
+        case RECOVERY_ADAPTER:
+            error = i2c_bus_reset_adapter(device_fd);
+            break;
+        default:
+            break;
+    }
+
+    if (error != NOERR 
+        || (error = read_measurement_state(&is_measuring, device->address, device_fd)) != NOERR) {
+        return error;
+    }
+
+    return is_measuring ? NOERR : start_measurement(device->address, device_fd);
+}
+
+/**
+ * @brief Picks the least drastic recovery step that can fix the failed read
+ * 
+ * Noise has already been read again and resent for, so a read that still failed the
+ * CRC after the device sent the same bad bytes twice needs the device reset
+ * 
+ * @param device_addr the device's hex address on the I2C bus
+ * @param error the error returned by the failed read
+ * @param bus the device's link counts as of the last read, updated to the current ones
+ * @return the step to start the recovery from
+ */
+enum Recovery_Step fault_step(uint8_t device_addr, int error, struct Sensirion_Stats* bus) {
+    uint32_t systematic = bus->crc_errors[SENSIRION_CRC_SYSTEMATIC];
+
+    read_bus_stats(bus, device_addr);
+    if (error == CRC_ERR && bus->crc_errors[SENSIRION_CRC_SYSTEMATIC] > systematic) {
+        return RECOVERY_RESET;
+    }
+
+    return RECOVERY_RETRY;
+}
+
+/**
+ * @brief Logs the failure and schedules the device's next recovery step
+ * 
+ * A stuck bus goes straight to resetting the adapter
+ * 
+ * @param recovery the device's recovery state machine
+ * @param device_addr the device's hex address on the I2C bus
+ * @param error the error returned by the failed read or recovery step
+ * @param step the least drastic step that can fix the failure
+ */
+void record_fault(struct Recovery* recovery, uint8_t device_addr, int error, enum Recovery_Step step) {
+    bool new_fault = !recovery->recovering;
+
+    step = recovery_fail_from(recovery, error == BUS_ERR ? RECOVERY_ADAPTER : step, monotonic_now_ms());
+
+    print_timestamp();
+    fprintf(LOG_FILE, "%s device %d, returned with error %d, attempting %s in %d ms\n",
+            new_fault ? "Lost" : "Failed to recover", device_addr, error, 
+            recovery_step_name(step), recovery_timeout(recovery, monotonic_now_ms()));
+    fflush(LOG_FILE);
+}
+
 /**
  * @brief A thread for each sensor to collect data
  * 
  * Putting each sensor into their own thread allows data to be read concurrently
  * instead of sequentially 
  * 
- * @param arg the id for the thread (its index for the pipe array)
+ * @param arg the id for the thread (its index in the workers array)
  * @return the device status when the thread exits
  */
 void* sensor_worker(void* arg) {
     int id = MAKE_INT(arg);
-    int device_status, timer_fd, epoll_fd;
+    struct Worker* worker = &workers[id];
+    int device_status;
+    int timer_fd = -1;
+    int epoll_fd = -1;
+    bool is_measuring = false;
 
-    //Device info
+    //Device info, main keeps its own copy in the slot
     int device_fd = 0;
-    const uint8_t ADDR = DEVICE_ADDRS[id];
-    const int NUM_DATA = DATAPOINTS[id];
+    const struct Device_Config DEVICE = worker->device;
+    const uint8_t ADDR = DEVICE.address;
+    const int NUM_DATA = channel_count(ADDR);
+    uint32_t period = DEVICE.period;
 
     //Device Read Data
-    float buffer[NUM_DATA];
-    struct Sensor_Data data = {};
+    uint32_t sequence = 0;
+    struct Recovery recovery;
+    struct Sensor_Data data = {.device_addr = ADDR, .num_data = NUM_DATA};
 
     //Timer data
     uint64_t result;
+    uint64_t expirations = 0;
     struct epoll_event event;
     struct itimerspec timerspec;
 
-    if ((device_status = create_timer(&timer_fd, &epoll_fd, 
-                                &event, &timerspec)) != 0) {
-        goto exit;
+    if (realtime_config.enabled) {
+        realtime_prefault_stack(REALTIME_PREFAULT_SIZE);
     }
+    recovery_init(&recovery);
 
-    if ((device_status = device_init(ADAPTER_NUM, ADDR, &device_fd)) != NOERR) {
+    if ((device_status = device_init(DEVICE.adapter_num, ADDR, &device_fd)) != NOERR) {
         print_timestamp();
         fprintf(LOG_FILE, "Unable to initialize device %d, " 
-                "returned with error %d\n", DEVICE_ADDRS[id], device_status);
-        UNLOCK_MUTEX(lock);
+                "returned with error %d\n", ADDR, device_status);
+        fflush(LOG_FILE);
+        goto exit;
+    }
+
+    //Each transfer on the shared bus is atomic and only this worker talks to the
+    //device, so the devices are brought up in parallel without the bus lock
+    if ((device_status = read_measurement_state(&is_measuring, ADDR, &device_fd)) != NOERR) {
+        is_measuring = false;
+    }
+
+    if (is_measuring) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Device %d is already measuring, adopting it\n", ADDR);
         fflush(LOG_FILE);
-        goto close_descriptors;
+    } else if ((device_status = start_measurement(ADDR, &device_fd)) != NOERR) {
+        //A device that is only briefly unreachable is brought up by the recovery
+        record_fault(&recovery, ADDR, device_status, RECOVERY_RETRY);
     }
 
-    LOCK_MUTEX(lock);
-    if ((device_status = start_measurement(ADDR, &device_fd)) != NOERR) {
+    //Probes how fast the device really answers so each read waits no longer than it has to
+    if (worker->calibrate && device_status == NOERR) {
+        LOCK_MUTEX(lock);
+        device_status = calibrate_delays(ADDR, &device_fd);
         UNLOCK_MUTEX(lock);
+
+        read_bus_stats(&data.bus, ADDR);
         print_timestamp();
-        fprintf(LOG_FILE, "Failed to start measurements for device %d,"
-                " returned with error %d\n", DEVICE_ADDRS[id], device_status);
+        if (device_status == NOERR) {
+            fprintf(LOG_FILE, "Device %d calibrated, reads wait %u us\n", ADDR, data.bus.delay_us);
+        } else {
+            fprintf(LOG_FILE, "Unable to calibrate device %d, returned with error %d\n", 
+                    ADDR, device_status);
+        }
         fflush(LOG_FILE);
-        goto free_device;
     }
-    UNLOCK_MUTEX(lock);
 
-    while (!sigint_recieved) {
+    //An adopted device already has data so it is read as soon as possible
+    if ((device_status = create_timer(&timer_fd, &epoll_fd, worker->control_fd)) != NOERR
+        || (device_status = arm_timer(timer_fd, &timerspec, period, is_measuring)) != NOERR) {
+        goto stop_measurements;
+    }
+
+    while (!sigint_recieved && !worker->stop) {
         bool is_ready = false;
+        int num_events;
 
-        if ((device_status = epoll_wait(epoll_fd, 
-                                &event, 1, -1)) == -1) {
+        if ((num_events = epoll_wait(epoll_fd, &event, 1, 
+                            recovery_timeout(&recovery, monotonic_now_ms()))) == -1) {
+            device_status = errno;
             fprintf(LOG_FILE, "Failed the epoll_wait() for device %d,"
-                    " returned with error %s\n", DEVICE_ADDRS[id], strerror(errno));
+                    " returned with error %s\n", ADDR, strerror(errno));
             goto stop_measurements;
         }
 
+        //The backoff ran out, the step is checked by the next read
+        if (num_events == 0) {
+            LOCK_MUTEX(lock);
+            device_status = recover_device(recovery.step, &DEVICE, &device_fd);
+            UNLOCK_MUTEX(lock);
+
+            recovery_step_taken(&recovery);
+            if (device_status != NOERR) {
+                record_fault(&recovery, ADDR, device_status, RECOVERY_RETRY);
+            }
+            continue;
+        }
+
+        //Woken by main to stop or to apply a new sampling period
+        if (event.data.fd == worker->control_fd) {
+            uint32_t new_period;
+
+            //Read after the wake-up is consumed, so a later change signals again
+            (void)read(worker->control_fd, &result, sizeof(result));
+            new_period = atomic_load_explicit(&worker->period, memory_order_acquire);
+
+            if (!sigint_recieved && !worker->stop && new_period != period) {
+                period = new_period;
+                expirations = 0;
+                (void)arm_timer(timer_fd, &timerspec, period, false);
+            }
+            continue;
+        }
+
+        //Every expiration past the first is a period that was skipped
+        if (read(timer_fd, &result, sizeof(result)) == sizeof(result) && result > 0) {
+            data.overruns += result - 1;
+            expirations += result;
+            sensor_data_schedule(&data, &sequence, result);
+            data.scheduled = timerspec.it_value;
+            data.scheduled.tv_sec += (expirations - 1) * period;
+        }
+
+        //Periods during a backoff are skipped until the next step has been taken,
+        //and missed like any other period without a sample
+        if (recovery.waiting) {
+            ++data.overruns;
+            continue;
+        }
+
         LOCK_MUTEX(lock);
 
         do {
-            if ((device_status = read_data_flag(&is_ready, 
-                                    ADDR, &device_fd)) != NOERR) {
-                UNLOCK_MUTEX(lock);
-                print_timestamp();
-                fprintf(LOG_FILE, "Failed to read data-ready flag for device %d, "
-                        "returned with error %d\n", DEVICE_ADDRS[id], device_status);
-                fflush(LOG_FILE);
-                goto stop_measurements;
-            }
-        } while(!is_ready);
+            device_status = read_data_flag(&is_ready, ADDR, &device_fd);
+        } while(device_status == NOERR && !is_ready);
+
+        if (device_status == NOERR) {
+            device_status = read_into_buffer(data.data, NUM_DATA, ADDR, &device_fd);
+        }
 
-        if ((device_status = read_into_buffer(buffer, NUM_DATA, 
-                                    ADDR, &device_fd)) != NOERR) {
+        if (device_status != NOERR) {
             UNLOCK_MUTEX(lock);
-            print_timestamp();
-            fprintf(LOG_FILE, "Failed to read data into buffer for device %d, "
-                    "returned with error %d\n", DEVICE_ADDRS[id], device_status);
-            fflush(LOG_FILE);
-            goto stop_measurements;
+            ++data.overruns;
+            record_fault(&recovery, ADDR, device_status, fault_step(ADDR, device_status, &data.bus));
+            continue;
         }
+        sensor_data_stamp(&data);
         UNLOCK_MUTEX(lock);
 
-        data.num_data = NUM_DATA;
-        data.data = buffer;
-
-        write(pipe_fds[id][1], &data, sizeof(data));
+        if (recovery_succeed(&recovery, timespec_to_ms(&data.monotonic))) {
+            print_timestamp();
+            fprintf(LOG_FILE, "Device %d recovered after %u ms and %u attempts\n", ADDR,
+                    recovery.stats.last_recovery_ms, recovery.episode_attempts);
+            fflush(LOG_FILE);
+        }
+        data.recovery = recovery.stats;
+        read_bus_stats(&data.bus, ADDR);
 
-        device_status = read(timer_fd, &result, sizeof(result));
+        write(worker->pipe_fds[1], &data, sizeof(data));
     }
+    device_status = NOERR;
 
     stop_measurements:
+        if (keep_measuring) {
+            goto close_descriptors;
+        }
+
         LOCK_MUTEX(lock);
         if ((device_status = stop_measurement(ADDR, &device_fd)) != NOERR) {
             print_timestamp();
             fprintf(LOG_FILE, "Failed to stop measurements for device %d, "
-                    "returned with code %d\n", DEVICE_ADDRS[id], device_status);
+                    "returned with code %d\n", ADDR, device_status);
             fflush(LOG_FILE);
         }
         UNLOCK_MUTEX(lock);
-    free_device:
-        device_free(ADDR, &device_fd);
     close_descriptors:
         close(epoll_fd);
         close(timer_fd);
+        device_free(ADDR, &device_fd);
     exit:
-        close(pipe_fds[id][1]);
+        close(worker->pipe_fds[1]);
         pthread_exit(MAKE_VOID(device_status));
 }
 
@@ -353,7 +782,7 @@ void* sensor_worker(void* arg) {
 int disconnect(MQTTClient* client) {
     int client_status = MQTTCLIENT_SUCCESS;
 
-    if (MQTTClient_isConnected(client)) {
+    if (MQTTClient_isConnected(*client)) {
         if ((client_status = MQTTClient_disconnect(*client, TIMEOUT)) != MQTTCLIENT_SUCCESS) {
             print_timestamp();
             fprintf(LOG_FILE, "\nFailed to disconnect, exited with code %d\n", client_status);
@@ -364,6 +793,44 @@ int disconnect(MQTTClient* client) {
     return client_status;
 }
 
+/**
+ * @brief Connects the already created client to the server
+ * 
+ * @param client 
+ * @return whether the client could connect to the server
+ */
+int connect_client(MQTTClient* client) {
+    MQTTClient_connectOptions conn_opts = MQTTClient_connectOptions_initializer5;
+    MQTTResponse response;
+    int client_status = MQTTCLIENT_SUCCESS;
+    uint16_t alias_maximum = 0;
+
+    conn_opts.keepAliveInterval = 20; //keeps the connection alive for 20 seconds
+    conn_opts.cleanstart = 1; //disregards state info after disconects
+    conn_opts.connectTimeout = CONNECT_TIMEOUT; //keeps a dead broker from stalling the main loop
+
+    response = MQTTClient_connect5(*client, &conn_opts, NULL, NULL);
+    if ((client_status = response.reasonCode) != MQTTCLIENT_SUCCESS) {
+        MQTTResponse_free(response);
+        print_timestamp();
+        fprintf(LOG_FILE, "Failed to connect, returned with code %d\n", client_status);
+        fflush(LOG_FILE);
+        disconnect(client);
+        return client_status;
+    }
+
+    //Aliases only last for a single connection and the broker sets how many there can be
+    if (response.properties != NULL 
+        && MQTTProperties_hasProperty(response.properties, MQTTPROPERTY_CODE_TOPIC_ALIAS_MAXIMUM)) {
+        alias_maximum = (uint16_t)MQTTProperties_getNumericValue(response.properties, 
+                                                    MQTTPROPERTY_CODE_TOPIC_ALIAS_MAXIMUM);
+    }
+    topic_aliases_reset(&aliases, alias_maximum);
+    MQTTResponse_free(response);
+    
+    return client_status;
+}
+
 /**
  * @brief Initializes the connection of the client
  * 
@@ -371,13 +838,16 @@ int disconnect(MQTTClient* client) {
  * @return whether the client could be initialized and connect to the server
  */
 int initialize_connection(MQTTClient* client) {
-    MQTTClient_connectOptions conn_opts = MQTTClient_connectOptions_initializer;
+    MQTTClient_createOptions create_opts = MQTTClient_createOptions_initializer;
     int client_status = MQTTCLIENT_SUCCESS;
-    if ((client_status = MQTTClient_create(client, ADDRESS, CLIENTID, 
-        MQTTCLIENT_PERSISTENCE_NONE, NULL)) != MQTTCLIENT_SUCCESS) {
+
+    create_opts.MQTTVersion = MQTTVERSION_5; //needed for topic aliases
+    if ((client_status = MQTTClient_createWithOptions(client, config.address, config.client_id, 
+        MQTTCLIENT_PERSISTENCE_NONE, NULL, &create_opts)) != MQTTCLIENT_SUCCESS) {
             print_timestamp();
             fprintf(LOG_FILE, "Failed to create client, returned with code %d\n", client_status);
             fflush(LOG_FILE);
+            *client = NULL;
             return client_status;
         }
     
@@ -389,188 +859,1599 @@ int initialize_connection(MQTTClient* client) {
             fflush(LOG_FILE);
             return client_status;
         }
-    
-    conn_opts.keepAliveInterval = 20; //keeps the connection alive for 20 seconds
-    conn_opts.cleansession = 1; //disregards state info after disconects
 
-    if ((client_status = MQTTClient_connect(*client, &conn_opts)) != MQTTCLIENT_SUCCESS) {
-        print_timestamp();
-        fprintf(LOG_FILE, "Failed to connect, returned with code %d\n", client_status);
-        fflush(LOG_FILE);
-        disconnect(client);
-        return client_status;
-    }
-    
-    return client_status;
+    return connect_client(client);
 }
 
 /**
- * @brief Initializes the sigaction to the signal handler
+ * @brief Schedules the next reconnection attempt after a jittered exponential backoff
  * 
- * @return errno if the signal handler couldn't be bound to sigaction, NOERR otherwise
+ * The backoff doubles from RECONNECT_MIN_BACKOFF_MS up to RECONNECT_MAX_BACKOFF_MS,
+ * and a random half of it is taken off so gateways that lost the same broker don't
+ * all reconnect at once
+ * 
+ * @param connection 
  */
-int initialize_sigaction() {
-    struct sigaction action;
-    action.sa_handler = signal_handler;
-    sigemptyset(&action.sa_mask);
-    action.sa_flags = SA_RESTART;
+void schedule_reconnect(struct Connection* connection) {
+    uint64_t backoff = RECONNECT_MIN_BACKOFF_MS;
 
-    if (sigaction(SIGINT, &action, NULL) != 0) {
-        fprintf(stderr, "Failed to initialize sigaction, returned with error %d\n", errno);
-        return errno;
+    for (uint32_t i = 0; i < connection->attempts && backoff < RECONNECT_MAX_BACKOFF_MS; ++i) {
+        backoff *= 2;
     }
+    backoff = backoff < RECONNECT_MAX_BACKOFF_MS ? backoff : RECONNECT_MAX_BACKOFF_MS;
+    backoff -= rand_r(&connection->seed) % (backoff / 2 + 1);
 
-    return NOERR;
+    connection->connected = false;
+    connection->retry_ms = monotonic_now_ms() + backoff;
+    ++connection->attempts;
+
+    //The new connection starts a clean session, so whatever was in flight is sent again
+    delivery_reset(&deliveries);
+    backlog_resend(&backlog);
+
+    print_timestamp();
+    fprintf(LOG_FILE, "Reconnecting in %lu ms, %u records backlogged\n", 
+            (unsigned long)backoff, backlog.count);
+    fflush(LOG_FILE);
 }
 
 /**
- * @brief Initializes the threads with their respective indecies
+ * @brief Gets how long until the next reconnection attempt
  * 
- * @param threads the array of sensor threads
- * @param epoll_fd the epoll file descriptor for binding the thread pipes to the epoll
- * @return if the threads could be initialized correctly
+ * @param connection 
+ * @param now_ms the current monotonic time in milliseconds
+ * @return the timeout in milliseconds or -1 if connected, usable by epoll_wait()
  */
-int initialize_threads(pthread_t* threads, const int epoll_fd) {
-    pthread_mutex_init(&lock, NULL);
+int reconnect_timeout(const struct Connection* connection, uint64_t now_ms) {
+    if (connection->connected || connection->client == NULL) {
+        return -1;
+    }
 
-    for (int i = 0; i < DEVICE_COUNT; ++i) {
-        if (pipe(pipe_fds[i]) == -1) {
-            print_timestamp();
-            fprintf(LOG_FILE, "Failed to create pipe\n");
-            fflush(LOG_FILE);
-            return -1;
-        }
-        
-        struct epoll_event event;
-        event.events = EPOLLIN;
-        event.data.u32 = i;
+    return connection->retry_ms > now_ms ? (int)(connection->retry_ms - now_ms) : 0;
+}
+
+/**
+ * @brief Reconnects the client once its backoff has run out
+ * 
+ * @param connection 
+ */
+void try_reconnect(struct Connection* connection) {
+    if (reconnect_timeout(connection, monotonic_now_ms()) != 0) {
+        return;
+    }
 
-        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pipe_fds[i][0], &event);
-        void* id = MAKE_VOID(i);
-        pthread_create(&threads[i], NULL, sensor_worker, id);
+    if (connect_client(&connection->client) != MQTTCLIENT_SUCCESS) {
+        schedule_reconnect(connection);
+        return;
     }
 
-    return NOERR;
+    connection->connected = true;
+    connection->attempts = 0;
+
+    print_timestamp();
+    fprintf(LOG_FILE, "Reconnected, publishing %u backlogged records, %u dropped so far\n", 
+            backlog.count, backlog.dropped);
+    fflush(LOG_FILE);
 }
 
-int main(void) {
-    //MQTT variables
-    MQTTClient client;
+/**
+ * @brief Connects the client to the server while the devices are being brought up
+ * 
+ * @param arg the MQTTClient to connect
+ * @return the client status once the connection attempt finishes
+ */
+void* connect_worker(void* arg) {
+    pthread_exit(MAKE_VOID(initialize_connection((MQTTClient*)arg)));
+}
+
+/**
+ * @brief Initializes the sigaction to the signal handler
+ * 
+ * @return errno if the signal handler couldn't be bound to sigaction, NOERR otherwise
+ */
+int initialize_sigaction() {
+    struct sigaction action;
+    action.sa_handler = signal_handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+
+    if (sigaction(SIGINT, &action, NULL) != 0 || sigaction(SIGTERM, &action, NULL) != 0
+        || sigaction(SIGHUP, &action, NULL) != 0) {
+        fprintf(stderr, "Failed to initialize sigaction, returned with error %d\n", errno);
+        return errno;
+    }
+
+    return NOERR;
+}
+
+/**
+ * @brief Creates a thread with the shutdown and reload signals blocked so they are
+ *          always handled by main
+ * 
+ * @param thread the thread
+ * @param attr the thread's attributes, may be NULL
+ * @param routine the thread's routine
+ * @param arg the routine's argument
+ * @return the pthread_create() error
+ */
+int create_thread(pthread_t* thread, pthread_attr_t* attr, void* (*routine)(void*), void* arg) {
+    sigset_t signals, previous;
+    int error;
+
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+
+    pthread_sigmask(SIG_BLOCK, &signals, &previous);
+    error = pthread_create(thread, attr, routine, arg);
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+    return error;
+}
+
+/**
+ * @brief Starts the sensor worker, pinned and under SCHED_FIFO while in real-time mode
+ * 
+ * Falls back to the default scheduling if the real-time attributes are refused,
+ * for example when not running with CAP_SYS_NICE
+ * 
+ * @param thread the sensor thread
+ * @param id the id for the thread
+ * @return the pthread_create() error
+ */
+int start_worker(pthread_t* thread, void* id) {
+    pthread_attr_t attr;
+    int error;
+
+    if (!realtime_config.enabled) {
+        return create_thread(thread, NULL, sensor_worker, id);
+    }
+
+    if ((error = realtime_thread_attr(&attr, realtime_config.acquisition_cpu, 
+                                    realtime_config.acquisition_priority)) == NOERR) {
+        error = create_thread(thread, &attr, sensor_worker, id);
+    }
+    pthread_attr_destroy(&attr);
+
+    if (error != NOERR) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Failed to start real-time worker, returned with error %d, "
+                "falling back to default scheduling\n", error);
+        fflush(LOG_FILE);
+        error = create_thread(thread, NULL, sensor_worker, id);
+    }
+
+    return error;
+}
+
+/**
+ * @brief Starts a worker for the device in a free slot
+ * 
+ * @param device the device's configuration
+ * @param epoll_fd the epoll file descriptor for binding the worker's pipe to the epoll
+ * @return -1 if the worker couldn't be started, NOERR otherwise
+ */
+int add_worker(const struct Device_Config* device, const int epoll_fd) {
+    struct Worker* worker = NULL;
+    int id;
+
+    for (id = 0; id < CONFIG_MAX_DEVICES; ++id) {
+        if (!workers[id].active) {
+            worker = &workers[id];
+            break;
+        }
+    }
+
+    if (worker == NULL) {
+        return -1;
+    }
+
+    memset(worker, 0, sizeof(*worker));
+    worker->device = *device;
+    worker->calibrate = config.calibrate_delays;
+    atomic_init(&worker->period, device->period);
+
+    if (pipe(worker->pipe_fds) == -1 || (worker->control_fd = eventfd(0, 0)) == -1) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Failed to create pipe\n");
+        fflush(LOG_FILE);
+        return -1;
+    }
+
+    struct epoll_event event;
+    event.events = EPOLLIN;
+    event.data.u32 = id;
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, worker->pipe_fds[0], &event);
+    if (start_worker(&worker->thread, MAKE_VOID(id)) != 0) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, worker->pipe_fds[0], NULL);
+        close(worker->pipe_fds[0]);
+        close(worker->pipe_fds[1]);
+        close(worker->control_fd);
+        return -1;
+    }
+
+    worker->active = true;
+    return NOERR;
+}
+
+/**
+ * @brief Joins the worker whose pipe was closed and frees its slot
+ * 
+ * @param worker the worker's slot
+ * @param epoll_fd the epoll file descriptor the worker's pipe is bound to
+ */
+void remove_worker(struct Worker* worker, const int epoll_fd) {
+    void* retval = NULL;
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, worker->pipe_fds[0], NULL);
+    close(worker->pipe_fds[0]);
+    pthread_join(worker->thread, &retval);
+    close(worker->control_fd);
+    worker->active = false;
+
+    if(MAKE_INT(retval) != NOERR) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Worker returned error with code %d\n", MAKE_INT(retval));
+        fflush(LOG_FILE);
+    }
+}
+
+/**
+ * @brief Gets the worker reading the device
+ * 
+ * @param address the device's hex address on the I2C bus
+ * @return the worker's slot or NULL if no worker is reading the device
+ */
+struct Worker* find_worker(uint8_t address) {
+    for (int i = 0; i < CONFIG_MAX_DEVICES; ++i) {
+        if (workers[i].active && workers[i].device.address == address) {
+            return &workers[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Makes the running workers match the configured devices
+ * 
+ * Workers of removed devices, or of devices moved to another adapter, are asked 
+ * to stop. Their replacements are started once they have exited. Workers whose 
+ * sampling period changed are woken to re-arm their timers, and every other 
+ * worker is left untouched
+ * 
+ * @param epoll_fd the epoll file descriptor for binding new workers' pipes
+ */
+void sync_workers(const int epoll_fd) {
+    for (int i = 0; i < CONFIG_MAX_DEVICES; ++i) {
+        struct Worker* worker = &workers[i];
+        const struct Device_Config* device;
+
+        if (!worker->active || worker->stop) {
+            continue;
+        }
+
+        device = config_find_device(&config, worker->device.address);
+        if (device == NULL || device->adapter_num != worker->device.adapter_num) {
+            worker->stop = 1;
+            signal_worker(worker);
+        } else if (device->period != worker->device.period) {
+            worker->device.period = device->period;
+            atomic_store_explicit(&worker->period, device->period, memory_order_release);
+            signal_worker(worker);
+        }
+    }
+
+    for (int i = 0; i < config.num_devices && !sigint_recieved; ++i) {
+        if (find_worker(config.devices[i].address) == NULL 
+            && add_worker(&config.devices[i], epoll_fd) != NOERR) {
+            print_timestamp();
+            fprintf(LOG_FILE, "Failed to start worker for device %d\n", 
+                    config.devices[i].address);
+            fflush(LOG_FILE);
+        }
+    }
+}
+
+/**
+ * @brief Counts the workers that haven't exited yet
+ * 
+ * @return the number of active workers
+ */
+int active_workers(void) {
+    int active = 0;
+
+    for (int i = 0; i < CONFIG_MAX_DEVICES; ++i) {
+        active += workers[i].active;
+    }
+
+    return active;
+}
+
+/**
+ * @brief Initializes the threads for every configured device
+ * 
+ * @param epoll_fd the epoll file descriptor for binding the thread pipes to the epoll
+ * @return if the threads could be initialized correctly
+ */
+int initialize_threads(const int epoll_fd) {
+    pthread_mutexattr_t lock_attr;
+
+    //Keeps a preempted lock holder from stalling the real-time workers
+    pthread_mutexattr_init(&lock_attr);
+    if (realtime_config.enabled) {
+        pthread_mutexattr_setprotocol(&lock_attr, PTHREAD_PRIO_INHERIT);
+    }
+    pthread_mutex_init(&lock, &lock_attr);
+    pthread_mutexattr_destroy(&lock_attr);
+
+    sync_workers(epoll_fd);
+
+    return active_workers() == config.num_devices ? NOERR : -1;
+}
+
+/**
+ * @brief Initializes the join for the configured devices
+ * 
+ * @param join the join to be initialized
+ * @return SIZE_ERR if the devices couldn't be joined, NOERR otherwise
+ */
+int8_t initialize_join(struct Record_Join* join) {
+    uint8_t addresses[CONFIG_MAX_DEVICES];
+
+    for (int i = 0; i < config.num_devices; ++i) {
+        addresses[i] = config.devices[i].address;
+    }
+
+    return record_join_init(join, addresses, config.num_devices, 
+                            config.wait_time * 1000, config.join_lateness_ms);
+}
+
+/**
+ * @brief Publishes the payload, through the topic's alias if the broker allows one
+ * 
+ * @param client 
+ * @param topic the full topic
+ * @param payload the payload string
+ * @param qos the quality of service
+ * @param retained whether the broker keeps the payload as the topic's last value
+ * @param token the out parameter for the delivery token
+ * @return whether the message could be published
+ */
+int publish_message(MQTTClient* client, const char* topic, const char* payload, 
+                    int qos, bool retained, MQTTClient_deliveryToken* token) {
     MQTTClient_message message = MQTTClient_message_initializer;
+    MQTTProperty property;
+    MQTTResponse response;
+    int client_status;
+    bool established;
+    bool disconnected;
+    uint16_t alias;
+
+    //An injected broker fault fails the publish the way a lost connection would
+    if (fault_injector.num_rules > 0 && fault_inject_broker(&fault_injector, &disconnected) != NOERR) {
+        if (disconnected) {
+            disconnect(client);
+            connection_lost = 1;
+            return MQTTCLIENT_DISCONNECTED;
+        }
+        return MQTTCLIENT_FAILURE;
+    }
+
+    alias = topic_alias_lookup(&aliases, topic, &established);
+
+    message.payload = (void*)payload;
+    message.payloadlen = (int)strlen(payload);
+    message.qos = qos;
+    message.retained = retained;
+
+    if (alias > 0) {
+        property.identifier = MQTTPROPERTY_CODE_TOPIC_ALIAS;
+        property.value.integer2 = alias;
+        MQTTProperties_add(&message.properties, &property);
+    }
+
+    //Once the broker knows the alias the topic is left out
+    response = MQTTClient_publishMessage5(*client, established ? "" : topic, &message, token);
+    client_status = response.reasonCode;
+    MQTTResponse_free(response);
+    MQTTProperties_free(&message.properties);
+
+    if (client_status == MQTTCLIENT_SUCCESS) {
+        topic_alias_established(&aliases, alias);
+    }
+
+    return client_status;
+}
+
+/**
+ * @brief Lays the configured devices out in the shared-memory latest-value table
+ * 
+ * The table is created on first use, or recreated under its new name, and an
+ * empty name removes it
+ * 
+ * @param old_name the table's name before the configuration changed
+ */
+void initialize_shm_table(const char* old_name) {
+    uint8_t addresses[CONFIG_MAX_DEVICES];
+
+    if (shm_table != NULL && strcmp(old_name, config.shm_name) != 0) {
+        shm_table_destroy(old_name, &shm_table);
+    }
+
+    if (config.shm_name[0] == '\0') {
+        return;
+    }
+
+    if (shm_table == NULL && shm_table_create(config.shm_name, &shm_table) != NOERR) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Failed to create shared-memory table %s, "
+                "returned with error %d\n", config.shm_name, errno);
+        fflush(LOG_FILE);
+        return;
+    }
+
+    for (int i = 0; i < config.num_devices; ++i) {
+        addresses[i] = config.devices[i].address;
+    }
+    shm_table_layout(shm_table, addresses, config.num_devices);
+}
+
+/**
+ * @brief Faults in every column of the history ring
+ * 
+ * The ring is only written as samples arrive, so in real-time mode its pages are
+ * touched up front instead of by the first pass through the ring
+ */
+void prefault_history(void) {
+    for (int i = 0; i < history.num_series; ++i) {
+        const struct History_Series* series = &history.series[i];
+
+        realtime_prefault_buffer(series->timestamps, sizeof(uint64_t) * series->capacity);
+        for (int j = 0; j < series->num_channels; ++j) {
+            realtime_prefault_buffer(series->values[j], sizeof(float) * series->capacity);
+        }
+    }
+}
+
+/**
+ * @brief Allocates the history ring for the configured devices
+ * 
+ * The previous history is dropped, so it is only called at startup and when the
+ * history's length changes
+ */
+void initialize_history(void) {
+    uint8_t addresses[CONFIG_MAX_DEVICES];
+    int8_t error;
+
+    history_free(&history);
+    for (int i = 0; i < config.num_devices; ++i) {
+        addresses[i] = config.devices[i].address;
+    }
+
+    if ((error = history_init(&history, addresses, config.num_devices, 
+                            config.history_length)) != NOERR) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Failed to allocate the history, returned with error %d\n", error);
+        fflush(LOG_FILE);
+    } else if (realtime_config.enabled) {
+        prefault_history();
+    }
+}
+
+/**
+ * @brief Gives the added devices a series and frees the removed devices', the
+ *          other devices keep their readings
+ */
+void update_history(void) {
+    uint8_t addresses[CONFIG_MAX_DEVICES];
+    int8_t error;
+
+    for (int i = 0; i < config.num_devices; ++i) {
+        addresses[i] = config.devices[i].address;
+    }
+
+    if ((error = history_set_devices(&history, addresses, config.num_devices)) != NOERR) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Failed to resize the history, returned with error %d\n", error);
+        fflush(LOG_FILE);
+    }
+
+    if (realtime_config.enabled) {
+        prefault_history();
+    }
+}
+
+/**
+ * @brief Opens the query socket at the configured path, an empty path closes it
+ * 
+ * @param epoll_fd the epoll file descriptor the query sockets are added to
+ */
+void initialize_query_server(const int epoll_fd) {
+    query_server_close(&query_server, epoll_fd);
+
+    if (config.query_socket[0] != '\0' 
+        && query_server_open(&query_server, config.query_socket, epoll_fd) != NOERR) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Failed to open query socket %s, returned with error %d\n", 
+                config.query_socket, errno);
+        fflush(LOG_FILE);
+    }
+}
+
+/**
+ * @brief Starts tracking the records in flight and adds the eventfd the delivered
+ *          callback wakes the main loop through to the epoll
+ * 
+ * @param epoll_fd the epoll file descriptor
+ * @return INIT_ERR if the eventfd couldn't be created or added, NOERR otherwise
+ */
+int8_t initialize_deliveries(const int epoll_fd) {
+    struct epoll_event event;
+
+    delivery_init(&deliveries);
+    if ((delivery_fd = eventfd(0, EFD_NONBLOCK)) == -1) {
+        return INIT_ERR;
+    }
+
+    event.events = EPOLLIN;
+    event.data.u32 = DELIVERY_EVENT_ID;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, delivery_fd, &event) == -1) {
+        close(delivery_fd);
+        delivery_fd = -1;
+        return INIT_ERR;
+    }
+
+    return NOERR;
+}
+
+/**
+ * @brief Starts capturing the I2C traffic to capture_file, or replaying it from
+ *          replay_file instead of the adapters
+ * 
+ * Only called at startup, before any worker talks to the bus
+ */
+void initialize_bus_capture(void) {
+    int8_t error;
+
+    if (config.replay_file[0] != '\0') {
+        if ((error = bus_capture_open(&bus_capture, config.replay_file)) != NOERR) {
+            print_timestamp();
+            fprintf(LOG_FILE, "Failed to open I2C capture %s, returned with error %d\n",
+                    config.replay_file, error);
+            fflush(LOG_FILE);
+            return;
+        }
+
+        i2c_bus_replay(&bus_capture);
+        print_timestamp();
+        fprintf(LOG_FILE, "Replaying %llu I2C transactions from %s\n", 
+                (unsigned long long)bus_capture_count(&bus_capture), config.replay_file);
+        fflush(LOG_FILE);
+    } else if (config.capture_file[0] != '\0') {
+        if ((error = bus_capture_create(&bus_capture, config.capture_file, 
+                                        config.capture_records)) != NOERR) {
+            print_timestamp();
+            fprintf(LOG_FILE, "Failed to create I2C capture %s, returned with error %d\n",
+                    config.capture_file, error);
+            fflush(LOG_FILE);
+            return;
+        }
+
+        i2c_bus_capture(&bus_capture);
+    }
+}
+
+/**
+ * @brief Starts injecting the configured faults into the devices' transfers and
+ *          the broker's publishes
+ * 
+ * Only called at startup, before any worker talks to the bus
+ */
+void initialize_fault_injector(void) {
+    fault_inject_init(&fault_injector, config.faults, config.num_faults, config.fault_seed);
+    if (fault_injector.num_rules == 0) {
+        return;
+    }
+
+    i2c_bus_inject(&fault_injector);
+    print_timestamp();
+    fprintf(LOG_FILE, "Injecting %d faults with seed %u\n", fault_injector.num_rules, 
+            config.fault_seed);
+    fflush(LOG_FILE);
+}
+
+/**
+ * @brief Finishes the open export files and starts a writer for each configured
+ *          device, an empty export directory turns the export off
+ */
+void initialize_exporters(void) {
+    int8_t error;
+
+    for (int i = 0; i < num_exporters; ++i) {
+        if ((error = columnar_writer_close(&exporters[i])) != NOERR) {
+            print_timestamp();
+            fprintf(LOG_FILE, "Failed to finish the export for device %d, returned with "
+                    "error %d\n", exporters[i].footer.device_addr, error);
+            fflush(LOG_FILE);
+        }
+    }
+    num_exporters = 0;
+
+    if (config.export_dir[0] == '\0') {
+        return;
+    }
+
+    for (int i = 0; i < config.num_devices; ++i) {
+        uint8_t address = config.devices[i].address;
+
+        if (columnar_writer_init(&exporters[num_exporters], config.export_dir, config.export_rotate_s,
+                                address, channel_count(address)) == NOERR) {
+            ++num_exporters;
+        }
+    }
+}
+
+/**
+ * @brief Finishes the export files of the removed devices and starts a writer for
+ *          each added device, the other devices keep writing to their open files
+ */
+void update_exporters(void) {
+    int num_kept = 0;
+    int8_t error;
+
+    for (int i = 0; i < num_exporters; ++i) {
+        uint8_t address = exporters[i].footer.device_addr;
+
+        if (config_find_device(&config, address) != NULL) {
+            if (num_kept != i) {
+                exporters[num_kept] = exporters[i];
+            }
+            ++num_kept;
+        } else if ((error = columnar_writer_close(&exporters[i])) != NOERR) {
+            print_timestamp();
+            fprintf(LOG_FILE, "Failed to finish the export for device %d, returned with "
+                    "error %d\n", address, error);
+            fflush(LOG_FILE);
+        }
+    }
+    num_exporters = num_kept;
+
+    for (int i = 0; config.export_dir[0] != '\0' && i < config.num_devices; ++i) {
+        uint8_t address = config.devices[i].address;
+        bool exported = false;
+
+        for (int j = 0; j < num_kept && !exported; ++j) {
+            exported = exporters[j].footer.device_addr == address;
+        }
+
+        if (!exported && columnar_writer_init(&exporters[num_exporters], config.export_dir,
+                            config.export_rotate_s, address, channel_count(address)) == NOERR) {
+            ++num_exporters;
+        }
+    }
+}
+
+/**
+ * @brief Adds the sample to its device's export file
+ * 
+ * @param sample the sample just read
+ */
+void export_sample(const struct Sensor_Data* sample) {
+    for (int i = 0; i < num_exporters; ++i) {
+        if (exporters[i].footer.device_addr == sample->device_addr
+            && columnar_writer_add(&exporters[i], sample) != NOERR) {
+            print_timestamp();
+            fprintf(LOG_FILE, "Failed to export a sample from device %d to %s, returned "
+                    "with error %d\n", sample->device_addr, config.export_dir, errno);
+            fflush(LOG_FILE);
+        }
+    }
+}
+
+/**
+ * @brief Publishes each device's sampling-timing statistics to the metrics topic
+ * 
+ * Lateness percentiles are in microseconds after the timer's scheduled expiration
+ * 
+ * @param client 
+ * @return whether the metrics could be published
+ */
+int publish_metrics(MQTTClient* client) {
+    MQTTClient_deliveryToken token;
+    int client_status;
+
+    cJSON* root = cJSON_CreateObject();
+    for (int i = 0; i < CONFIG_MAX_DEVICES; ++i) {
+        struct Timing_Stats* timing = &workers[i].timing;
+
+        if (!workers[i].active) {
+            continue;
+        }
+
+        cJSON* device = cJSON_AddObjectToObject(root, device_name(workers[i].device.address));
+        cJSON_AddNumberToObject(device, "Samples", timing->samples);
+        cJSON_AddNumberToObject(device, "Overruns", timing->overruns);
+        cJSON_AddNumberToObject(device, "Lateness P50", timing_stats_percentile(timing, 50));
+        cJSON_AddNumberToObject(device, "Lateness P95", timing_stats_percentile(timing, 95));
+        cJSON_AddNumberToObject(device, "Lateness P99", timing_stats_percentile(timing, 99));
+        cJSON_AddNumberToObject(device, "Lateness Max", timing->max_lateness_us);
+        cJSON_AddNumberToObject(device, "Faults", workers[i].recovery.faults);
+        cJSON_AddNumberToObject(device, "Recoveries", workers[i].recovery.recoveries);
+        cJSON_AddNumberToObject(device, "Recovery Attempts", workers[i].recovery.attempts);
+        cJSON_AddNumberToObject(device, "Last Recovery ms", workers[i].recovery.last_recovery_ms);
+        cJSON_AddNumberToObject(device, "Max Recovery ms", workers[i].recovery.max_recovery_ms);
+        cJSON_AddNumberToObject(device, "Read Delay us", workers[i].bus.delay_us);
+        cJSON_AddNumberToObject(device, "NACKs", workers[i].bus.nacks);
+        cJSON_AddNumberToObject(device, "Rereads", workers[i].bus.rereads);
+        cJSON_AddNumberToObject(device, "CRC Noise", workers[i].bus.crc_errors[SENSIRION_CRC_NOISE]);
+        cJSON_AddNumberToObject(device, "CRC Systematic", 
+                                workers[i].bus.crc_errors[SENSIRION_CRC_SYSTEMATIC]);
+        cJSON_AddNumberToObject(device, "CRC Bus Stuck", workers[i].bus.crc_errors[SENSIRION_CRC_BUS_STUCK]);
+        cJSON_AddNumberToObject(device, "CRC Error Rate", workers[i].bus.responses == 0 ? 0.0 
+            : (double)(workers[i].bus.crc_errors[SENSIRION_CRC_NOISE] 
+                       + workers[i].bus.crc_errors[SENSIRION_CRC_SYSTEMATIC]
+                       + workers[i].bus.crc_errors[SENSIRION_CRC_BUS_STUCK]) / workers[i].bus.responses);
+
+        cJSON* rejected = NULL;
+        for (int j = 0; j < filter_chain.num_filters; ++j) {
+            const struct Filter* filter = &filter_chain.filters[j];
+            char name[64];
+
+            if (filter->config.device_addr != workers[i].device.address) {
+                continue;
+            }
+
+            if (rejected == NULL) {
+                rejected = cJSON_AddObjectToObject(device, "Filter Rejections");
+            }
+            snprintf(name, sizeof(name), "%s %s", channel_name(filter->config.device_addr, 
+                    filter->config.channel), filter_name(filter->config.type));
+            cJSON_AddNumberToObject(rejected, name, filter->rejected);
+        }
+    }
+
+    cJSON* pending = cJSON_AddObjectToObject(root, "Backlog");
+    cJSON_AddNumberToObject(pending, "Records", backlog.count);
+    cJSON_AddNumberToObject(pending, "In Flight", deliveries.count);
+    cJSON_AddNumberToObject(pending, "Dropped", backlog.dropped);
+
+    //In the order the faults are configured
+    if (fault_injector.num_rules > 0) {
+        cJSON* injected = cJSON_AddArrayToObject(root, "Faults Injected");
+        for (int i = 0; i < fault_injector.num_rules; ++i) {
+            cJSON_AddItemToArray(injected, cJSON_CreateNumber((double)fault_injected(&fault_injector, i)));
+        }
+    }
+
+    cJSON* memory = cJSON_AddObjectToObject(root, "Memory");
+    cJSON_AddNumberToObject(memory, "Arena High Water", message_arena.high_water);
+    cJSON_AddNumberToObject(memory, "Arena Exhausted", message_arena.exhausted);
+#ifdef ALLOC_COUNT
+    cJSON_AddNumberToObject(memory, "Allocations", alloc_count_total());
+#endif
+
+    if (print_json(root, payload_buffer, sizeof(payload_buffer), false) != NOERR) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Metrics don't fit in %d bytes\n", PAYLOAD_SIZE);
+        fflush(LOG_FILE);
+        return MQTTCLIENT_SUCCESS;
+    }
+
+    if ((client_status = publish_message(client, config.metrics_topic, 
+        payload_buffer, 0, false, &token)) != MQTTCLIENT_SUCCESS) {
+            print_timestamp();
+            fprintf(LOG_FILE, "Failed to publish metrics, "
+                    "returned with code %d\n", client_status);
+            fflush(LOG_FILE);
+    }
+
+    return client_status;
+}
+
+/**
+ * @brief Publishes each of the record's fresh readings to its own channel topic
+ * 
+ * Stale and missing devices are left out so subscribers only see new readings
+ * 
+ * @param client 
+ * @param record the record to be published
+ * @param tokens the out parameter for the delivery tokens
+ * @param num_tokens the number of tokens, incremented for every message published
+ * @return whether every reading could be published
+ */
+int publish_channels(MQTTClient* client, const struct Joined_Record* record,
+                    MQTTClient_deliveryToken* tokens, int* num_tokens) {
+    char topic[TOPIC_SIZE];
+    char payload[32];
+    int client_status = MQTTCLIENT_SUCCESS;
+
+    if (config.channel_topic[0] == '\0') {
+        return MQTTCLIENT_SUCCESS;
+    }
+
+    for (int i = 0; i < record->num_devices; ++i) {
+        const struct Sensor_Data* sample = &record->samples[i];
+
+        if (record->states[i] != FIELD_FRESH) {
+            continue;
+        }
+
+        for (int j = 0; j < sample->num_data; ++j) {
+            const char* channel = channel_name(sample->device_addr, j);
+
+            if (channel == NULL || topic_format(topic, sizeof(topic), config.channel_topic, 
+                    config.gateway, device_name(sample->device_addr), channel) != NOERR) {
+                continue;
+            }
+
+            snprintf(payload, sizeof(payload), "%g", sample->data[j]);
+            if ((client_status = publish_message(client, topic, payload, config.qos, 
+                    config.retain_channels, &tokens[(*num_tokens)++])) != MQTTCLIENT_SUCCESS) {
+                print_timestamp();
+                fprintf(LOG_FILE, "Failed to publish to %s, "
+                        "returned with code %d\n", topic, client_status);
+                fflush(LOG_FILE);
+                return client_status;
+            }
+        }
+    }
+
+    //Derived metrics are published under the "derived" device once their inputs exist
+    for (int i = 0; config.derived_metrics && i < DERIVED_METRICS; ++i) {
+        if (isnan(record->derived.values[i]) || topic_format(topic, sizeof(topic), 
+                config.channel_topic, config.gateway, "derived", derived_name(i)) != NOERR) {
+            continue;
+        }
+
+        snprintf(payload, sizeof(payload), "%g", record->derived.values[i]);
+        if ((client_status = publish_message(client, topic, payload, config.qos, 
+                config.retain_channels, &tokens[(*num_tokens)++])) != MQTTCLIENT_SUCCESS) {
+            print_timestamp();
+            fprintf(LOG_FILE, "Failed to publish to %s, "
+                    "returned with code %d\n", topic, client_status);
+            fflush(LOG_FILE);
+            return client_status;
+        }
+    }
+
+    return client_status;
+}
+
+/**
+ * @brief Hands a single record to the client without waiting for its delivery
+ * 
+ * The whole record goes to the topic and each fresh reading to its channel topic
+ * 
+ * @param client 
+ * @param record the record to be published
+ * @param tokens the out parameter for the delivery tokens, DELIVERY_MAX_TOKENS long
+ * @param num_tokens the out parameter for the number of tokens
+ * @return whether the record could be published
+ */
+int publish_record(MQTTClient* client, const struct Joined_Record* record,
+                    MQTTClient_deliveryToken* tokens, int* num_tokens) {
+    int client_status = MQTTCLIENT_SUCCESS;
+
+    *num_tokens = 0;
+
+    //A record too large for the payload buffer is logged and left out of the 
+    //combined topic, the per-channel topics are still published
+    if (config.topic[0] != '\0' 
+        && make_json(payload_buffer, sizeof(payload_buffer), (struct Joined_Record*)record) != NOERR) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Record doesn't fit in %d bytes\n", PAYLOAD_SIZE);
+        fflush(LOG_FILE);
+    } else if (config.topic[0] != '\0') {
+        client_status = publish_message(client, config.topic, payload_buffer, config.qos, 
+                                        false, &tokens[(*num_tokens)++]);
+
+        if (client_status != MQTTCLIENT_SUCCESS) {
+            print_timestamp();
+            fprintf(LOG_FILE, "Failed to publish message, "
+                    "returned with code %d\n", client_status);
+            fflush(LOG_FILE);
+            return client_status;
+        }
+    }
+
+    return publish_channels(client, record, tokens, num_tokens);
+}
+
+/**
+ * @brief Removes the records the broker has confirmed from the backlog
+ * 
+ * @return the number of records removed
+ */
+uint32_t collect_deliveries(void) {
+    uint32_t completed = delivery_collect(&deliveries);
+
+    for (uint32_t i = 0; i < completed; ++i) {
+        backlog_pop(&backlog);
+    }
+
+    return completed;
+}
+
+/**
+ * @brief Sends up to max_records of the backlog, oldest first, and removes the
+ *          records the broker has confirmed
+ * 
+ * Sending never waits on the broker. A record is only removed from the backlog
+ * once every one of its messages is confirmed, at most DELIVERY_MAX_RECORDS are in
+ * flight at once. If publishing fails, or the oldest record waits longer than 
+ * TIMEOUT, the client is considered disconnected and a reconnection is scheduled
+ * 
+ * @param connection 
+ * @param max_records the most records to send, keeps the main loop responsive
+ * @return the number of records confirmed
+ */
+uint32_t flush_backlog(struct Connection* connection, uint32_t max_records) {
+    const struct Joined_Record* record;
+    MQTTClient_deliveryToken tokens[DELIVERY_MAX_TOKENS];
+    uint64_t now_ms = monotonic_now_ms();
+    uint32_t published = collect_deliveries();
+    uint32_t sent = 0;
+    int num_tokens;
+
+    if (connection->connected && delivery_timeout(&deliveries, now_ms, TIMEOUT) == 0) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Record was not delivered within %ld ms\n", TIMEOUT);
+        fflush(LOG_FILE);
+        disconnect(&connection->client);
+        schedule_reconnect(connection);
+        return published;
+    }
+
+    while (connection->connected && sent < max_records && !delivery_full(&deliveries)
+            && (record = backlog_next(&backlog)) != NULL) {
+        //A token is reused once its message is delivered, so the confirmations
+        //already in are matched before it can be handed out again
+        published += collect_deliveries();
+
+        if (publish_record(&connection->client, record, tokens, &num_tokens) != MQTTCLIENT_SUCCESS) {
+            disconnect(&connection->client);
+            schedule_reconnect(connection);
+            break;
+        }
+
+        backlog_sent(&backlog);
+        delivery_track(&deliveries, tokens, config.qos > 0 ? num_tokens : 0, now_ms);
+        ++sent;
+    }
+
+    //Records sent at QoS 0 are done as soon as they're handed to the client
+    return published + collect_deliveries();
+}
+
+/**
+ * @brief Publishes the whole backlog and waits for the broker to confirm it, used
+ *          when shutting down
+ * 
+ * @param connection 
+ */
+void drain_backlog(struct Connection* connection) {
+    struct pollfd confirmed = {.fd = delivery_fd, .events = POLLIN};
+    uint64_t count;
+
+    while (connection->connected && !connection_lost && backlog.count > 0) {
+        (void)flush_backlog(connection, BACKLOG_SIZE);
+
+        if (connection->connected && backlog.count > 0 
+            && poll(&confirmed, 1, delivery_timeout(&deliveries, monotonic_now_ms(), TIMEOUT)) > 0) {
+            (void)read(delivery_fd, &count, sizeof(count));
+        }
+    }
+}
+
+/**
+ * @brief Evaluates the alert rules against the sample and publishes every change
+ *          of state straight away
+ * 
+ * Alerts skip the join and the backlog, they are only logged while disconnected
+ * since a late alert is of no use to ventilation control
+ * 
+ * @param connection 
+ * @param sample the sample just read
+ */
+void evaluate_alerts(struct Connection* connection, const struct Sensor_Data* sample) {
+    struct Alert_Event events[ALERT_MAX_RULES];
     MQTTClient_deliveryToken token;
+    int num_events = alert_engine_update(&alert_engine, sample, events);
+
+    for (int i = 0; i < num_events; ++i) {
+        const char* state = events[i].active ? "Active" : "Cleared";
+
+        print_timestamp();
+        fprintf(LOG_FILE, "Alert %s is %s\n", events[i].rule->name, state);
+        fflush(LOG_FILE);
+
+        if (!connection->connected || config.alert_topic[0] == '\0') {
+            continue;
+        }
+
+        cJSON* root = cJSON_CreateObject();
+        cJSON_AddStringToObject(root, "Rule", events[i].rule->name);
+        cJSON_AddStringToObject(root, "State", state);
+        cJSON_AddNumberToObject(root, "Value", events[i].value);
+        cJSON_AddStringToObject(root, "Device", device_name(sample->device_addr));
+        cJSON_AddNumberToObject(root, "Timestamp", timespec_to_ms(&sample->realtime));
+        cJSON_AddNumberToObject(root, "Latency ms", 
+                                monotonic_now_ms() - timespec_to_ms(&sample->monotonic));
+
+        if (print_json(root, payload_buffer, sizeof(payload_buffer), false) != NOERR) {
+            print_timestamp();
+            fprintf(LOG_FILE, "Alert %s doesn't fit in %d bytes\n", events[i].rule->name, 
+                    PAYLOAD_SIZE);
+            fflush(LOG_FILE);
+            continue;
+        }
+
+        //Delivery isn't waited on so the next sample isn't held up
+        int client_status = publish_message(&connection->client, config.alert_topic, 
+                                            payload_buffer, config.alert_qos, false, &token);
+
+        if (client_status != MQTTCLIENT_SUCCESS) {
+            print_timestamp();
+            fprintf(LOG_FILE, "Failed to publish alert %s, returned with code %d\n", 
+                    events[i].rule->name, client_status);
+            fflush(LOG_FILE);
+        }
+    }
+}
+
+/**
+ * @brief Converts a temperature reading to Celsius using its channel's unit
+ * 
+ * @param device_addr the device's hex address on the I2C bus
+ * @param channel the index of the temperature datapoint
+ * @param value the reading in the channel's unit
+ * @return the temperature in degrees Celsius
+ */
+float celsius(uint8_t device_addr, int channel, float value) {
+    return strcmp(channel_descriptor(device_addr, channel)->unit, "F") == 0 
+            ? (value - 32.0F) / 1.8F 
+            : value;
+}
+
+/**
+ * @brief Derives the record's metrics from its fresh readings
+ * 
+ * The SEN55's temperature and humidity are used over the SCD40's when both are fresh
+ * 
+ * @param record the record, in the order the join emitted it
+ */
+void derive_record(struct Joined_Record* record) {
+    struct Derived_Inputs inputs = {NAN, NAN, NAN, NAN, NAN};
+
+    for (int i = 0; i < DERIVED_METRICS; ++i) {
+        record->derived.values[i] = NAN;
+    }
+
+    if (!config.derived_metrics) {
+        return;
+    }
+
+    for (int i = 0; i < record->num_devices; ++i) {
+        const struct Sensor_Data* sample = &record->samples[i];
+
+        if (record->states[i] != FIELD_FRESH) {
+            continue;
+        }
+
+        if (sample->device_addr == SEN55_ADDR) {
+            inputs.pm2_5 = sample->data[SEN55_PM2_5];
+            inputs.pm10 = sample->data[SEN55_PM10];
+            inputs.humidity = sample->data[SEN55_HUMIDITY];
+            inputs.temperature = celsius(SEN55_ADDR, SEN55_TEMPERATURE, sample->data[SEN55_TEMPERATURE]);
+        } else if (sample->device_addr == SCD40_ADDR) {
+            inputs.co2 = sample->data[SCD40_CO2];
+            if (isnan(inputs.temperature) || isnan(inputs.humidity)) {
+                inputs.temperature = celsius(SCD40_ADDR, SCD40_TEMPERATURE, 
+                                            sample->data[SCD40_TEMPERATURE]);
+                inputs.humidity = sample->data[SCD40_HUMIDITY];
+            }
+        }
+    }
+
+    derived_update(&derived, record->monotonic_ms, &inputs, &record->derived);
+}
+
+/**
+ * @brief Queues the joined records behind the backlog and publishes a batch of it
+ * 
+ * While disconnected the records stay in the backlog, evicting the oldest once it
+ * is full, and are published in order after reconnecting. Each record's metrics are
+ * derived before it is queued so they are only computed once
+ * 
+ * @param connection 
+ * @param records the records emitted by the join
+ * @param num_records the number of records
+ * @return the number of records published
+ */
+uint32_t publish_records(struct Connection* connection, struct Joined_Record* records, 
+                        int num_records) {
+    for (int i = 0; i < num_records; ++i) {
+        bool in_flight = backlog.sent > 0;
+
+        derive_record(&records[i]);
+        if (backlog_push(&backlog, &records[i])) {
+            //The broker's confirmation of an evicted record is ignored
+            if (in_flight) {
+                delivery_forget_oldest(&deliveries);
+            }
+            print_timestamp();
+            fprintf(LOG_FILE, "Backlog is full, dropped the oldest record\n");
+            fflush(LOG_FILE);
+        }
+    }
+
+    return flush_backlog(connection, BACKLOG_BATCH);
+}
+
+/**
+ * @brief Gets the earlier of two epoll_wait() timeouts
+ * 
+ * @param first a timeout in milliseconds or -1 to wait forever
+ * @param second a timeout in milliseconds or -1 to wait forever
+ * @return the earlier timeout or -1 if both wait forever
+ */
+int earliest_timeout(int first, int second) {
+    if (first < 0) {
+        return second;
+    }
+
+    return second < 0 || first < second ? first : second;
+}
+
+/**
+ * @brief Re-reads the configuration file and applies only what changed
+ * 
+ * Devices whose configuration didn't change keep measuring untouched. The join is 
+ * flushed and rebuilt when the devices or the sampling period change, and the 
+ * client is recreated when the broker address or client id change. An invalid
+ * file is logged and the current configuration is kept
+ * 
+ * @param connection 
+ * @param join the join of the devices' samples
+ * @param epoll_fd the epoll file descriptor for binding new workers' pipes
+ * @return whether the client could be recreated, a failed connection is retried
+ */
+int reload_config(struct Connection* connection, struct Record_Join* join, const int epoll_fd) {
+    struct Joined_Record records[JOIN_MAX_PENDING];
+    struct Config old_config = config;
+    struct Config new_config;
+    int client_status = MQTTCLIENT_SUCCESS;
+    int error_line;
+    int num_records;
+
+    if (config_load(config_path, &new_config, &error_line) != NOERR) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Failed to reload %s, invalid line %d, keeping the current "
+                "configuration\n", config_path, error_line);
+        fflush(LOG_FILE);
+        return MQTTCLIENT_SUCCESS;
+    }
+
+    print_timestamp();
+    fprintf(LOG_FILE, "Reloading configuration from %s\n", config_path);
+    fflush(LOG_FILE);
+#ifdef ALLOC_COUNT
+    warmup_records = 0;
+#endif
+
+    bool join_changed = new_config.num_devices != old_config.num_devices 
+        || memcmp(new_config.devices, old_config.devices, 
+                    sizeof(new_config.devices[0]) * new_config.num_devices) != 0
+        || new_config.wait_time != old_config.wait_time
+        || new_config.join_lateness_ms != old_config.join_lateness_ms;
+
+    //Records from the old devices are queued before the join is rebuilt
+    if (join_changed && (num_records = record_join_flush(join, records)) > 0) {
+        (void)publish_records(connection, records, num_records);
+    }
+
+    config = new_config;
+    if (new_config.num_alerts != old_config.num_alerts
+        || memcmp(new_config.alerts, old_config.alerts, 
+                    sizeof(new_config.alerts[0]) * new_config.num_alerts) != 0) {
+        alert_engine_init(&alert_engine, config.alerts, config.num_alerts);
+    }
+
+    if (new_config.num_filters != old_config.num_filters
+        || memcmp(new_config.filters, old_config.filters, 
+                    sizeof(new_config.filters[0]) * new_config.num_filters) != 0) {
+        filter_chain_init(&filter_chain, config.filters, config.num_filters);
+    }
+
+    if (new_config.derived_metrics && !old_config.derived_metrics) {
+        derived_init(&derived, (float)config.outdoor_co2);
+    }
+    derived.outdoor_co2 = (float)config.outdoor_co2;
+
+    if (join_changed) {
+        (void)initialize_join(join);
+    }
+
+    if (join_changed || strcmp(old_config.shm_name, new_config.shm_name) != 0) {
+        initialize_shm_table(old_config.shm_name);
+    }
+
+    //A device's readings are only dropped when the history's length changes, a
+    //device that just moved to another adapter or period keeps its series
+    if (new_config.history_length != old_config.history_length) {
+        initialize_history();
+    } else if (config_devices_changed(&old_config, &new_config)) {
+        update_history();
+    }
+
+    if (strcmp(old_config.query_socket, new_config.query_socket) != 0) {
+        initialize_query_server(epoll_fd);
+    }
+
+    //Restarting a writer closes its file early, and reopening it in the same
+    //rotation period splits the period over suffixed files
+    if (strcmp(old_config.export_dir, new_config.export_dir) != 0
+        || new_config.export_rotate_s != old_config.export_rotate_s) {
+        initialize_exporters();
+    } else if (config_devices_changed(&old_config, &new_config)) {
+        update_exporters();
+    }
+
+    //Sending a topic with an alias already in use remaps it, so the aliases are
+    //handed out again from the start for the new topics
+    if (strcmp(old_config.topic, new_config.topic) != 0
+        || strcmp(old_config.metrics_topic, new_config.metrics_topic) != 0
+        || strcmp(old_config.channel_topic, new_config.channel_topic) != 0
+        || strcmp(old_config.gateway, new_config.gateway) != 0) {
+        topic_aliases_reset(&aliases, aliases.maximum);
+    }
+
+    if (config_broker_changed(&old_config, &new_config)) {
+        disconnect(&connection->client);
+        MQTTClient_destroy(&connection->client);
+        delivery_reset(&deliveries);
+        backlog_resend(&backlog);
+
+        connection->attempts = 0;
+        connection->connected = (client_status = initialize_connection(&connection->client)) 
+                                == MQTTCLIENT_SUCCESS;
+        if (connection->client == NULL) {
+            return client_status;
+        }
+
+        if (!connection->connected) {
+            schedule_reconnect(connection);
+        }
+        client_status = MQTTCLIENT_SUCCESS;
+    }
+
+    sync_workers(epoll_fd);
+
+    return client_status;
+}
+
+/**
+ * @brief Checks that nothing has been allocated since the publisher warmed up
+ * 
+ * Only built with ALLOC_COUNT, where the count of every allocation made by the
+ * publisher's own code is snapshotted once ALLOC_WARMUP_RECORDS records have been
+ * published. A reload starts the warm-up over since it resizes the history
+ * 
+ * @param published the number of records just published
+ * @return whether the allocation count is unchanged, always true without ALLOC_COUNT
+ */
+bool allocations_steady(uint32_t published __attribute__((unused))) {
+#ifdef ALLOC_COUNT
+    if (warmup_records < ALLOC_WARMUP_RECORDS) {
+        warmup_records += published;
+        steady_allocations = alloc_count_total();
+        return true;
+    }
+
+    if (alloc_count_total() != steady_allocations) {
+        print_timestamp();
+        fprintf(LOG_FILE, "%llu allocations after warming up\n", 
+                (unsigned long long)(alloc_count_total() - steady_allocations));
+        fflush(LOG_FILE);
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+int main(int argc, char** argv) {
+    //MQTT variables
+    struct Connection connection = {.client = NULL, .seed = (unsigned int)getpid()};
+    pthread_t connect_thread;
+    void* connect_status = NULL;
     int client_status = MQTTCLIENT_SUCCESS;
 
     //Epoll variables
     int epoll_fd = epoll_create1(0);
-    struct epoll_event events[DEVICE_COUNT];
+    struct epoll_event events[MAX_EVENTS];
 
     //Thread variables
-    int active_threads = DEVICE_COUNT;
-    pthread_t threads[DEVICE_COUNT];
-    bool connection_terminated = false;
+    bool workers_stopped = false;
     
-    float data[SEN55_DATAPOINTS + SCD40_DATAPOINTS] = {0};
+    //Join variables
+    struct Record_Join join;
+    struct Joined_Record records[JOIN_MAX_PENDING];
+    int config_error_line;
+
+    //Metrics variables
+    uint32_t published_records = 0;
 
     if ((LOG_FILE = fopen("log.txt", "a")) == NULL) {
         printf("Could not open log file!\n");
         exit(EXIT_FAILURE);
     }
 
-    if ((client_status = initialize_connection(&client)) != MQTTCLIENT_SUCCESS) {
+    if (argc > 1) {
+        config_path = argv[1];
+    }
+
+    if (config_load(config_path, &config, &config_error_line) != NOERR) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Invalid line %d in %s\n", config_error_line, config_path);
+        fflush(LOG_FILE);
+        fclose(LOG_FILE);
+        exit(EXIT_FAILURE);
+    }
+
+    realtime_config = config.realtime;
+    (void)initialize_join(&join);
+    initialize_shm_table(config.shm_name);
+    initialize_history();
+    initialize_query_server(epoll_fd);
+    initialize_exporters();
+    derived_init(&derived, (float)config.outdoor_co2);
+    alert_engine_init(&alert_engine, config.alerts, config.num_alerts);
+    filter_chain_init(&filter_chain, config.filters, config.num_filters);
+    backlog_init(&backlog);
+    initialize_bus_capture();
+    initialize_fault_injector();
+
+    if (initialize_deliveries(epoll_fd) != NOERR) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Failed to track deliveries, returned with error %d\n", errno);
+        fflush(LOG_FILE);
+        goto destroy_exit;
+    }
+
+    if (initialize_json() != NOERR) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Failed to allocate the message arena\n");
+        fflush(LOG_FILE);
         goto destroy_exit;
     }
 
     if (initialize_sigaction() != NOERR) {
-        disconnect(&client);
         goto destroy_exit;
     }
 
-    if (initialize_threads(threads, epoll_fd) != NOERR) {
-        disconnect(&client);
+    //The MQTT client's background thread inherits the publish CPU when it is created.
+    //The buffers the main loop writes are faulted in so the first samples don't
+    //take the page faults, even if the memory couldn't be locked
+    if (realtime_config.enabled) {
+        if (realtime_lock_memory() != NOERR) {
+            print_timestamp();
+            fprintf(LOG_FILE, "Failed to lock memory, returned with error %d\n", errno);
+            fflush(LOG_FILE);
+        }
+        realtime_prefault_buffer(&backlog, sizeof(backlog));
+        realtime_prefault_buffer(&deliveries, sizeof(deliveries));
+        realtime_prefault_buffer(payload_buffer, sizeof(payload_buffer));
+        realtime_prefault_buffer(message_arena.base, message_arena.size);
+        realtime_prefault_buffer(records, sizeof(records));
+        realtime_pin_current(realtime_config.publish_cpu);
+    }
+
+    //The broker is connected while the devices are being probed and started
+    if ((client_status = create_thread(&connect_thread, NULL, 
+                                    connect_worker, &connection.client)) != 0) {
         goto destroy_exit;
     }
 
-    while (active_threads != 0) {
-        bool read_data = false;
-        char* payload = NULL;
+    if (realtime_config.enabled) {
+        realtime_pin_current(realtime_config.processing_cpu);
+        realtime_prefault_stack(REALTIME_PREFAULT_SIZE);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    if (initialize_threads(epoll_fd) != NOERR) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Failed to start every worker\n");
+        fflush(LOG_FILE);
+    }
+
+    //Without a client the workers are stopped and drained by the main loop, an
+    //unreachable broker is retried while the records are backlogged
+    pthread_join(connect_thread, &connect_status);
+    if ((client_status = MAKE_INT(connect_status)) == MQTTCLIENT_SUCCESS) {
+        connection.connected = true;
+    } else if (connection.client == NULL) {
+        sigint_recieved = 1;
+    } else {
+        schedule_reconnect(&connection);
+        client_status = MQTTCLIENT_SUCCESS;
+    }
+
+    while (!sigint_recieved || active_workers() != 0) {
+        int num_records = 0;
+        uint32_t published = 0;
+        uint64_t now_ms = monotonic_now_ms();
+        int timeout = earliest_timeout(record_join_timeout(&join, now_ms), 
+                                        reconnect_timeout(&connection, now_ms));
+
+        if (connection_lost) {
+            connection_lost = 0;
+            if (connection.connected) {
+                schedule_reconnect(&connection);
+                continue;
+            }
+        }
+
+        if (!connection.connected && !sigint_recieved) {
+            try_reconnect(&connection);
+        }
+
+        //Whatever is left of the backlog is sent a batch per iteration, while the
+        //records in flight are waited on until they expire
+        if (connection.connected && backlog.count > 0) {
+            published += flush_backlog(&connection, BACKLOG_BATCH);
+            timeout = connection.connected && backlog_next(&backlog) != NULL 
+                    && !delivery_full(&deliveries) ? 0 
+                    : earliest_timeout(timeout, delivery_timeout(&deliveries, 
+                                                    monotonic_now_ms(), TIMEOUT));
+        }
+
+        //The workers are woken right away instead of at their next sample
+        if (sigint_recieved && !workers_stopped) {
+            for (int i = 0; i < CONFIG_MAX_DEVICES; ++i) {
+                if (workers[i].active) {
+                    signal_worker(&workers[i]);
+                }
+            }
+            workers_stopped = true;
+        }
+
+        if (reload_requested && !sigint_recieved) {
+            reload_requested = 0;
+            if ((client_status = reload_config(&connection, &join, epoll_fd)) != MQTTCLIENT_SUCCESS) {
+                sigint_recieved = 1;
+            }
+            continue;
+        }
 
-        int num_ready = epoll_wait(epoll_fd, events, DEVICE_COUNT, -1);
+        int num_ready = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout);
 
         for (int i = 0; i < num_ready; ++i) {
-            int index = events[i].data.u32;
-            uint8_t address = DEVICE_ADDRS[index];
+            uint32_t index = events[i].data.u32;
+
+            //Confirmed records make room for the next ones to be sent
+            if (index == DELIVERY_EVENT_ID) {
+                uint64_t count;
+
+                (void)read(delivery_fd, &count, sizeof(count));
+                published += flush_backlog(&connection, BACKLOG_BATCH);
+                continue;
+            }
+
+            //Queries are answered between samples so the history needs no lock
+            if (index >= QUERY_EVENT_ID) {
+                query_server_handle(&query_server, index, epoll_fd, &history);
+                continue;
+            }
+
+            struct Worker* worker = &workers[index];
+            uint8_t address = worker->device.address;
 
             struct Sensor_Data thread_data;
-            ssize_t closed = read(pipe_fds[index][0], &thread_data, sizeof(thread_data));
+            ssize_t closed = read(worker->pipe_fds[0], &thread_data, sizeof(thread_data));
 
             if (closed == 0) {
+                bool replaced = worker->stop;
 
-                void* retval = NULL;
-                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, pipe_fds[index][0], NULL);
-                close(pipe_fds[index][0]);
-                pthread_join(threads[index], retval);
+                remove_worker(worker, epoll_fd);
 
-                if(MAKE_INT(retval) != NOERR) {
-                    print_timestamp();
-                    fprintf(LOG_FILE, "Worker returned error with code %d\n", MAKE_INT(retval));
-                    fflush(LOG_FILE);
+                //Starts the replacement for a device moved to another adapter, a
+                //worker that exited on a device error is not restarted
+                if (replaced && !sigint_recieved) {
+                    sync_workers(epoll_fd);
                 }
-
-                --active_threads;
                 continue;
             }
 
-            switch (address) {
-                case SEN55_ADDR:
-                    memcpy(data, thread_data.data, SEN55_DATAPOINTS * sizeof(float));
-                    read_data = true;
-                    break;
-                case SCD40_ADDR:
-                    memcpy(data + SEN55_DATAPOINTS, thread_data.data, 
-                            SCD40_DATAPOINTS * sizeof(float));
-                    read_data = true;
-                    break;
+            //Outliers are filtered first so nothing downstream sees them, then
+            //alerts go out before anything else is done with the sample
+            filter_chain_apply(&filter_chain, &thread_data);
+            evaluate_alerts(&connection, &thread_data);
+
+            if (worker->has_sequence 
+                && sensor_data_gap(worker->last_sequence, thread_data.sequence) != 0) {
+                print_timestamp();
+                fprintf(LOG_FILE, "Missed %u samples from device %d\n", 
+                        sensor_data_gap(worker->last_sequence, thread_data.sequence), address);
+                fflush(LOG_FILE);
             }
-        }
+            worker->last_sequence = thread_data.sequence;
+            worker->has_sequence = true;
 
-        if (!read_data || connection_terminated) {
-            continue;
+            if (thread_data.overruns > worker->timing.overruns) {
+                print_timestamp();
+                fprintf(LOG_FILE, "Device %d missed %u sampling periods\n", address, 
+                        thread_data.overruns - worker->timing.overruns);
+                fflush(LOG_FILE);
+            }
+            timing_stats_add(&worker->timing, &thread_data);
+            worker->recovery = thread_data.recovery;
+            worker->bus = thread_data.bus;
+
+            if (shm_table != NULL) {
+                shm_table_update(shm_table, &thread_data);
+            }
+            (void)history_add(&history, &thread_data);
+            export_sample(&thread_data);
+
+            num_records = record_join_add(&join, &thread_data, records);
+            if (num_records > 0) {
+                published += publish_records(&connection, records, num_records);
+            }
         }
 
-        (void)make_json(&payload, data);
+        num_records = !sigint_recieved
+                    ? record_join_poll(&join, monotonic_now_ms(), records)
+                    : record_join_flush(&join, records);
 
-        message.payload = payload;
-        message.payloadlen = (int)strlen(payload);
-        message.qos = QOS;
-        message.retained = 0;
-        delivered_token = 0;
+        if (num_records > 0) {
+            published += publish_records(&connection, records, num_records);
+        }
 
-        //This is technically blocking but since the data comes every 5 seconds
-        //it doesn't matter too much
-        if ((client_status = MQTTClient_publishMessage(client, TOPIC, 
-            &message, &token)) != MQTTCLIENT_SUCCESS) {
-                print_timestamp();
-                fprintf(LOG_FILE, "Failed to publish message, "
-                        "returned with code %d\n", client_status);
-                fflush(LOG_FILE);
-                disconnect(&client);
-                sigint_recieved = 1;
-                connection_terminated = true;
-                goto free_payload;
-        } 
+        published_records += published;
+        if (!allocations_steady(published)) {
+            client_status = EXIT_FAILURE;
+            sigint_recieved = 1;
+        }
 
-        while(delivered_token != token) {
-            usleep(TIMEOUT);
+        if (config.metrics_interval > 0 && published_records >= config.metrics_interval 
+            && connection.connected) {
+            (void)publish_metrics(&connection.client);
+            published_records = 0;
         }
+    }
+
+    //The backlog only lives in memory, so it is published before shutting down
+    if (connection.connected) {
+        drain_backlog(&connection);
+        disconnect(&connection.client);
+    }
 
-        free_payload:
-            free(payload);
-            payload = NULL;
+    if (backlog.count > 0) {
+        print_timestamp();
+        fprintf(LOG_FILE, "Shutting down with %u unpublished records\n", backlog.count);
+        fflush(LOG_FILE);
     }
 
     destroy_exit:
-        MQTTClient_destroy(&client);
+        MQTTClient_destroy(&connection.client);
+        shm_table_destroy(config.shm_name, &shm_table);
+        query_server_close(&query_server, epoll_fd);
+        history_free(&history);
+        config.export_dir[0] = '\0';
+        initialize_exporters();
+        arena_free(&message_arena);
+        i2c_bus_capture(NULL);
+        i2c_bus_replay(NULL);
+        i2c_bus_inject(NULL);
+        bus_capture_close(&bus_capture);
+        if (delivery_fd != -1) {
+            close(delivery_fd);
+        }
         fclose(LOG_FILE);
         pthread_mutex_destroy(&lock);
         return client_status;
-}
\ No newline at end of file
+}
@@ -0,0 +1,196 @@
+#include "../include/query_server.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Disconnects the client and frees its slot
+ *
+ * @param server the server
+ * @param client the client's slot
+ * @param epoll_fd the epoll file descriptor the client was added to
+ */
+static void close_client(struct Query_Server* server, int client, int epoll_fd) {
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, server->client_fds[client], NULL);
+    close(server->client_fds[client]);
+    server->client_fds[client] = -1;
+}
+
+/**
+ * @brief Accepts a pending connection into a free slot
+ *
+ * @param server the server
+ * @param epoll_fd the epoll file descriptor the client is added to
+ */
+static void accept_client(struct Query_Server* server, int epoll_fd) {
+    struct epoll_event event;
+    int fd;
+
+    if ((fd = accept(server->listen_fd, NULL, NULL)) < 0) {
+        return;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    for (int i = 0; i < QUERY_MAX_CLIENTS; ++i) {
+        if (server->client_fds[i] < 0) {
+            event.events = EPOLLIN;
+            event.data.u32 = QUERY_EVENT_ID + 1 + i;
+
+            if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0) {
+                server->client_fds[i] = fd;
+                return;
+            }
+            break;
+        }
+    }
+
+    close(fd);
+}
+
+size_t query_execute(const struct History* history, const struct Query_Request* request,
+                    uint8_t* response) {
+    struct Query_Response* header = (struct Query_Response*)response;
+    const struct History_Series* series = history_find(history, request->device_addr);
+    uint8_t* body = response + sizeof(*header);
+    size_t entry_size = sizeof(struct Query_Point);
+    static struct History_Point points[QUERY_MAX_POINTS];
+    static struct History_Bucket buckets[QUERY_MAX_POINTS];
+    struct Scan_Result result;
+
+    header->status = NOERR;
+    header->type = request->type;
+    header->reserved = 0;
+    header->count = 0;
+
+    if (series == NULL || request->channel >= series->num_channels) {
+        header->status = ADDR_ERR;
+        return sizeof(*header);
+    }
+
+    switch (request->type) {
+        case QUERY_LATEST:
+            header->count = history_latest(series, request->channel, &points[0]) ? 1 : 0;
+            break;
+        case QUERY_RANGE:
+            header->count = history_range(series, request->channel, request->from_ms, 
+                                        request->to_ms, points, QUERY_MAX_POINTS);
+            break;
+        case QUERY_DOWNSAMPLE:
+            if (request->step_ms == 0) {
+                header->status = SIZE_ERR;
+                return sizeof(*header);
+            }
+
+            header->count = history_downsample(series, request->channel, request->from_ms,
+                                request->to_ms, request->step_ms, buckets, QUERY_MAX_POINTS);
+            entry_size = sizeof(struct Query_Bucket);
+            break;
+        case QUERY_AGGREGATE:
+            (void)history_aggregate(series, request->channel, request->from_ms, request->to_ms,
+                                    request->threshold, &result);
+
+            struct Query_Aggregate aggregate = {result.count, result.nan_count, result.above,
+                                                result.min, result.max, scan_mean(&result)};
+            memcpy(body, &aggregate, sizeof(aggregate));
+            header->count = 1;
+            return sizeof(*header) + sizeof(aggregate);
+        default:
+            header->status = SIZE_ERR;
+            return sizeof(*header);
+    }
+
+    for (uint32_t i = 0; i < header->count; ++i) {
+        if (request->type == QUERY_DOWNSAMPLE) {
+            struct Query_Bucket bucket = {buckets[i].start_ms, buckets[i].count, 
+                                        buckets[i].min, buckets[i].max, buckets[i].mean};
+            memcpy(body + i * entry_size, &bucket, entry_size);
+        } else {
+            struct Query_Point point = {points[i].timestamp_ms, points[i].value};
+            memcpy(body + i * entry_size, &point, entry_size);
+        }
+    }
+
+    return sizeof(*header) + header->count * entry_size;
+}
+
+int8_t query_server_open(struct Query_Server* server, const char* path, int epoll_fd) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    struct epoll_event event;
+
+    server->listen_fd = -1;
+    for (int i = 0; i < QUERY_MAX_CLIENTS; ++i) {
+        server->client_fds[i] = -1;
+    }
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        return INIT_ERR;
+    }
+    strcpy(address.sun_path, path);
+    strcpy(server->path, path);
+
+    if ((server->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) < 0) {
+        return INIT_ERR;
+    }
+
+    unlink(path);
+    event.events = EPOLLIN;
+    event.data.u32 = QUERY_EVENT_ID;
+
+    if (bind(server->listen_fd, (struct sockaddr*)&address, sizeof(address)) != 0
+        || listen(server->listen_fd, QUERY_MAX_CLIENTS) != 0
+        || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &event) != 0) {
+        close(server->listen_fd);
+        server->listen_fd = -1;
+        return INIT_ERR;
+    }
+
+    return NOERR;
+}
+
+void query_server_close(struct Query_Server* server, int epoll_fd) {
+    if (server->listen_fd < 0) {
+        return;
+    }
+
+    for (int i = 0; i < QUERY_MAX_CLIENTS; ++i) {
+        if (server->client_fds[i] >= 0) {
+            close_client(server, i, epoll_fd);
+        }
+    }
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, server->listen_fd, NULL);
+    close(server->listen_fd);
+    unlink(server->path);
+    server->listen_fd = -1;
+}
+
+void query_server_handle(struct Query_Server* server, uint32_t event_id, int epoll_fd,
+                        const struct History* history) {
+    static uint8_t response[QUERY_RESPONSE_SIZE];
+    struct Query_Request request;
+    int client = (int)(event_id - QUERY_EVENT_ID) - 1;
+    ssize_t received;
+    size_t size;
+
+    if (client < 0) {
+        accept_client(server, epoll_fd);
+        return;
+    }
+
+    if (client >= QUERY_MAX_CLIENTS || server->client_fds[client] < 0) {
+        return;
+    }
+
+    received = recv(server->client_fds[client], &request, sizeof(request), MSG_DONTWAIT);
+    if (received != sizeof(request)) {
+        close_client(server, client, epoll_fd);
+        return;
+    }
+
+    size = query_execute(history, &request, response);
+    if (send(server->client_fds[client], response, size, MSG_DONTWAIT | MSG_NOSIGNAL) != (ssize_t)size) {
+        close_client(server, client, epoll_fd);
+    }
+}
@@ -0,0 +1,86 @@
+#define _GNU_SOURCE
+#include <sched.h>
+#include "../include/realtime.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+int realtime_lock_memory(void) {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        return errno;
+    }
+
+    return NOERR;
+}
+
+void realtime_prefault_stack(size_t size) {
+    volatile uint8_t stack[size];
+    long page_size = sysconf(_SC_PAGESIZE);
+
+    for (size_t i = 0; i < size; i += (size_t)page_size) {
+        stack[i] = 0;
+    }
+
+    (void)stack[0];
+}
+
+void realtime_prefault_buffer(void* buffer, size_t size) {
+    volatile uint8_t* bytes = buffer;
+    long page_size = sysconf(_SC_PAGESIZE);
+
+    for (size_t i = 0; i < size; i += (size_t)page_size) {
+        bytes[i] = bytes[i];
+    }
+
+    //A buffer that doesn't start on a page boundary ends on one more page
+    if (size > 0) {
+        bytes[size - 1] = bytes[size - 1];
+    }
+}
+
+int realtime_pin_current(int cpu) {
+    cpu_set_t cpus;
+
+    if (cpu == NO_CPU_PIN) {
+        return NOERR;
+    }
+
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+}
+
+int realtime_thread_attr(pthread_attr_t* attr, int cpu, int priority) {
+    struct sched_param param = {.sched_priority = priority};
+    cpu_set_t cpus;
+    int error;
+
+    if ((error = pthread_attr_init(attr)) != 0) {
+        return error;
+    }
+
+    if ((error = pthread_attr_setstacksize(attr, REALTIME_STACK_SIZE)) != 0) {
+        return error;
+    }
+
+    if (cpu != NO_CPU_PIN) {
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+
+        if ((error = pthread_attr_setaffinity_np(attr, sizeof(cpus), &cpus)) != 0) {
+            return error;
+        }
+    }
+
+    if (priority > 0) {
+        if ((error = pthread_attr_setinheritsched(attr, PTHREAD_EXPLICIT_SCHED)) != 0
+            || (error = pthread_attr_setschedpolicy(attr, SCHED_FIFO)) != 0
+            || (error = pthread_attr_setschedparam(attr, &param)) != 0) {
+            return error;
+        }
+    }
+
+    return NOERR;
+}
@@ -0,0 +1,209 @@
+#include "../include/record_join.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Gets the index of the device in the join
+ *
+ * @param join the join
+ * @param device_addr the device's hex address on the I2C bus
+ * @return the index of the device or -1 if it isn't being joined
+ */
+static int device_index(const struct Record_Join* join, uint8_t device_addr) {
+    for (int i = 0; i < join->num_devices; ++i) {
+        if (join->device_addrs[i] == device_addr) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Gets the monotonic time at which the bucket's lateness window runs out
+ *
+ * @param join the join
+ * @param bucket the index of the bucket
+ * @return the deadline in milliseconds
+ */
+static uint64_t bucket_deadline(const struct Record_Join* join, uint64_t bucket) {
+    return join->origin_ms + (bucket + 1) * join->bucket_ms + join->lateness_ms;
+}
+
+/**
+ * @brief Whether every device has either delivered a sample for the bucket or moved past it
+ *
+ * @param join the join
+ * @param bucket the index of the bucket
+ * @return whether no more samples can arrive for the bucket
+ */
+static bool bucket_complete(const struct Record_Join* join, uint64_t bucket) {
+    const struct Join_Bucket* pending = &join->pending[bucket % JOIN_MAX_PENDING];
+
+    for (int i = 0; i < join->num_devices; ++i) {
+        bool fresh = pending->in_use && pending->index == bucket && pending->fresh[i];
+        bool moved_past = join->has_latest[i] && join->latest_bucket[i] > bucket;
+
+        if (!fresh && !moved_past) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Emits the next bucket if it holds any samples and advances to the following one
+ *
+ * Devices without a sample in the bucket are filled in with their last emitted
+ * sample and marked stale, or marked missing if they have never delivered one
+ *
+ * @param join the join
+ * @param record the out parameter for the emitted record
+ * @return whether a record was emitted
+ */
+static bool emit_next(struct Record_Join* join, struct Joined_Record* record) {
+    uint64_t bucket = join->next_bucket++;
+    struct Join_Bucket* pending = &join->pending[bucket % JOIN_MAX_PENDING];
+
+    if (!pending->in_use || pending->index != bucket) {
+        return false;
+    }
+
+    record->bucket = bucket;
+    record->monotonic_ms = join->origin_ms + bucket * join->bucket_ms;
+    record->num_devices = join->num_devices;
+
+    for (int i = 0; i < join->num_devices; ++i) {
+        if (pending->fresh[i]) {
+            record->states[i] = FIELD_FRESH;
+            record->samples[i] = pending->samples[i];
+            join->last_emitted[i] = pending->samples[i];
+            join->has_emitted[i] = true;
+        } else if (join->has_emitted[i]) {
+            record->states[i] = FIELD_STALE;
+            record->samples[i] = join->last_emitted[i];
+        } else {
+            record->states[i] = FIELD_MISSING;
+            memset(&record->samples[i], 0, sizeof(record->samples[i]));
+            record->samples[i].device_addr = join->device_addrs[i];
+        }
+    }
+
+    pending->in_use = false;
+    return true;
+}
+
+/**
+ * @brief Whether any bucket is waiting to be emitted
+ *
+ * @param join the join
+ * @return whether a bucket is pending
+ */
+static bool has_pending(const struct Record_Join* join) {
+    for (int i = 0; i < JOIN_MAX_PENDING; ++i) {
+        if (join->pending[i].in_use) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int8_t record_join_init(struct Record_Join* join, const uint8_t* device_addrs,
+                        int num_devices, uint32_t bucket_ms, uint32_t lateness_ms) {
+    if (num_devices <= 0 || num_devices > JOIN_MAX_DEVICES || bucket_ms == 0) {
+        return SIZE_ERR;
+    }
+
+    memset(join, 0, sizeof(*join));
+    memcpy(join->device_addrs, device_addrs, num_devices * sizeof(*device_addrs));
+    join->num_devices = num_devices;
+    join->bucket_ms = bucket_ms;
+    join->lateness_ms = lateness_ms;
+
+    return NOERR;
+}
+
+int record_join_add(struct Record_Join* join, const struct Sensor_Data* sample,
+                    struct Joined_Record* records) {
+    int device = device_index(join, sample->device_addr);
+    uint64_t sample_ms = timespec_to_ms(&sample->monotonic);
+    uint64_t bucket;
+    int num_records = 0;
+
+    if (device < 0) {
+        return ADDR_ERR;
+    }
+
+    if (!join->has_origin) {
+        join->origin_ms = sample_ms > join->bucket_ms / 2 ? sample_ms - join->bucket_ms / 2 : 0;
+        join->next_bucket = (sample_ms - join->origin_ms) / join->bucket_ms;
+        join->has_origin = true;
+    }
+
+    if (sample_ms < join->origin_ms
+        || (bucket = (sample_ms - join->origin_ms) / join->bucket_ms) < join->next_bucket) {
+        ++join->late_samples;
+        return 0;
+    }
+
+    while (bucket >= join->next_bucket + JOIN_MAX_PENDING) {
+        if (!has_pending(join)) {
+            join->next_bucket = bucket - JOIN_MAX_PENDING + 1;
+            break;
+        }
+
+        num_records += emit_next(join, &records[num_records]);
+    }
+
+    struct Join_Bucket* pending = &join->pending[bucket % JOIN_MAX_PENDING];
+    if (!pending->in_use) {
+        memset(pending, 0, sizeof(*pending));
+        pending->in_use = true;
+        pending->index = bucket;
+    }
+
+    pending->fresh[device] = true;
+    pending->samples[device] = *sample;
+    join->has_latest[device] = true;
+    join->latest_bucket[device] = bucket;
+
+    while (has_pending(join) && bucket_complete(join, join->next_bucket)) {
+        num_records += emit_next(join, &records[num_records]);
+    }
+
+    return num_records;
+}
+
+int record_join_poll(struct Record_Join* join, uint64_t now_ms, struct Joined_Record* records) {
+    int num_records = 0;
+
+    while (has_pending(join) && bucket_deadline(join, join->next_bucket) <= now_ms) {
+        num_records += emit_next(join, &records[num_records]);
+    }
+
+    return num_records;
+}
+
+int record_join_flush(struct Record_Join* join, struct Joined_Record* records) {
+    int num_records = 0;
+
+    while (has_pending(join)) {
+        num_records += emit_next(join, &records[num_records]);
+    }
+
+    return num_records;
+}
+
+int record_join_timeout(const struct Record_Join* join, uint64_t now_ms) {
+    if (!has_pending(join)) {
+        return -1;
+    }
+
+    uint64_t deadline = bucket_deadline(join, join->next_bucket);
+
+    return deadline > now_ms ? (int)(deadline - now_ms) : 0;
+}
@@ -0,0 +1,104 @@
+#include "../include/recovery.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Gets the backoff before the attempt, doubling from RECOVERY_MIN_BACKOFF_MS
+ *
+ * @param attempt the number of attempts already made during the fault
+ * @return the backoff in milliseconds, at most RECOVERY_MAX_BACKOFF_MS
+ */
+static uint32_t recovery_backoff_ms(uint32_t attempt) {
+    uint64_t backoff = RECOVERY_MIN_BACKOFF_MS;
+
+    while (attempt-- > 0 && backoff < RECOVERY_MAX_BACKOFF_MS) {
+        backoff *= 2;
+    }
+
+    return backoff < RECOVERY_MAX_BACKOFF_MS ? (uint32_t)backoff : RECOVERY_MAX_BACKOFF_MS;
+}
+
+void recovery_init(struct Recovery* recovery) {
+    memset(recovery, 0, sizeof(*recovery));
+}
+
+enum Recovery_Step recovery_fail(struct Recovery* recovery, uint64_t now_ms) {
+    return recovery_fail_from(recovery, RECOVERY_RETRY, now_ms);
+}
+
+enum Recovery_Step recovery_fail_from(struct Recovery* recovery, enum Recovery_Step step, uint64_t now_ms) {
+    uint32_t position;
+
+    if (!recovery->recovering) {
+        recovery->recovering = true;
+        recovery->episode_attempts = 0;
+        recovery->skipped_attempts = 0;
+        recovery->fault_ms = now_ms;
+        ++recovery->stats.faults;
+    }
+
+    //Only skips ahead within the current round of steps
+    position = (recovery->episode_attempts + recovery->skipped_attempts) 
+             % (RECOVERY_STEPS * RECOVERY_STEP_ATTEMPTS);
+    if (position < step * RECOVERY_STEP_ATTEMPTS) {
+        recovery->skipped_attempts += step * RECOVERY_STEP_ATTEMPTS - position;
+    }
+
+    recovery->step = (enum Recovery_Step)(((recovery->episode_attempts + recovery->skipped_attempts) 
+                                            / RECOVERY_STEP_ATTEMPTS) % RECOVERY_STEPS);
+    recovery->retry_ms = now_ms + recovery_backoff_ms(recovery->episode_attempts);
+    recovery->waiting = true;
+
+    ++recovery->episode_attempts;
+    ++recovery->stats.attempts;
+
+    return recovery->step;
+}
+
+bool recovery_succeed(struct Recovery* recovery, uint64_t now_ms) {
+    uint64_t duration_ms;
+
+    if (!recovery->recovering) {
+        return false;
+    }
+
+    duration_ms = now_ms - recovery->fault_ms;
+    recovery->stats.last_recovery_ms = duration_ms < UINT32_MAX ? (uint32_t)duration_ms : UINT32_MAX;
+    if (recovery->stats.last_recovery_ms > recovery->stats.max_recovery_ms) {
+        recovery->stats.max_recovery_ms = recovery->stats.last_recovery_ms;
+    }
+    ++recovery->stats.recoveries;
+
+    recovery->recovering = false;
+    recovery->waiting = false;
+    return true;
+}
+
+void recovery_step_taken(struct Recovery* recovery) {
+    recovery->waiting = false;
+}
+
+int recovery_timeout(const struct Recovery* recovery, uint64_t now_ms) {
+    if (!recovery->waiting) {
+        return -1;
+    }
+
+    return recovery->retry_ms > now_ms ? (int)(recovery->retry_ms - now_ms) : 0;
+}
+
+const char* recovery_step_name(enum Recovery_Step step) {
+    switch (step) {
+        case RECOVERY_RETRY:
+            return "retry";
+        case RECOVERY_REOPEN:
+            return "reopen";
+        case RECOVERY_RESET:
+            return "soft reset";
+        case RECOVERY_ADAPTER:
+            return "adapter reset";
+        default:
+            return "unknown";
+    }
+}
@@ -0,0 +1,204 @@
+#include "../include/scan.h"
+
+#if !defined(SCAN_SCALAR) && defined(__SSE2__)
+#include <emmintrin.h>
+#define SCAN_SSE2
+#elif !defined(SCAN_SCALAR) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SCAN_NEON
+#endif
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Adds the aggregates of one block to the result
+ *
+ * @param result the result
+ * @param count the number of valid values in the block
+ * @param nan_count the number of NAN values in the block
+ * @param above the number of values above the threshold in the block
+ * @param min the block's min, only used if count isn't 0
+ * @param max the block's max, only used if count isn't 0
+ * @param sum the block's sum
+ */
+static void merge(struct Scan_Result* result, uint32_t count, uint32_t nan_count,
+                  uint32_t above, float min, float max, double sum) {
+    if (count > 0) {
+        result->min = isnan(result->min) || min < result->min ? min : result->min;
+        result->max = isnan(result->max) || max > result->max ? max : result->max;
+    }
+
+    result->count += count;
+    result->nan_count += nan_count;
+    result->above += above;
+    result->sum += sum;
+}
+
+void scan_init(struct Scan_Result* result) {
+    result->count = 0;
+    result->nan_count = 0;
+    result->above = 0;
+    result->min = NAN;
+    result->max = NAN;
+    result->sum = 0;
+}
+
+void scan_column_scalar(const float* values, uint32_t num_values, float threshold,
+                        struct Scan_Result* result) {
+    float min = INFINITY;
+    float max = -INFINITY;
+    double sum = 0;
+    uint32_t count = 0;
+    uint32_t above = 0;
+
+    for (uint32_t i = 0; i < num_values; ++i) {
+        float value = values[i];
+
+        if (isnan(value)) {
+            continue;
+        }
+
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+        sum += value;
+        above += value > threshold;
+        ++count;
+    }
+
+    merge(result, count, num_values - count, above, min, max, sum);
+}
+
+#if defined(SCAN_SSE2)
+
+/**
+ * @brief Scans a block four values at a time, NAN lanes are masked to values that
+ *          leave the min, max, and sum unchanged
+ *
+ * @param values the block
+ * @param num_values the number of values, at most SCAN_BLOCK
+ * @param threshold the exceedance threshold
+ * @param result the result the block is added to
+ */
+static void scan_block(const float* values, uint32_t num_values, float threshold,
+                       struct Scan_Result* result) {
+    const __m128 infinity = _mm_set1_ps(INFINITY);
+    const __m128 negative_infinity = _mm_set1_ps(-INFINITY);
+    const __m128 limit = _mm_set1_ps(threshold);
+    __m128 min = infinity;
+    __m128 max = negative_infinity;
+    __m128 sum = _mm_setzero_ps();
+    __m128i count = _mm_setzero_si128();
+    __m128i above = _mm_setzero_si128();
+    float lanes[3][4];
+    uint32_t counts[2][4];
+    uint32_t i = 0;
+
+    for (; i + 4 <= num_values; i += 4) {
+        __m128 value = _mm_loadu_ps(values + i);
+        __m128 valid = _mm_cmpord_ps(value, value);
+        __m128 masked = _mm_and_ps(valid, value);
+
+        min = _mm_min_ps(min, _mm_or_ps(masked, _mm_andnot_ps(valid, infinity)));
+        max = _mm_max_ps(max, _mm_or_ps(masked, _mm_andnot_ps(valid, negative_infinity)));
+        sum = _mm_add_ps(sum, masked);
+        //A true comparison is all ones, so subtracting it counts the lane
+        count = _mm_sub_epi32(count, _mm_castps_si128(valid));
+        above = _mm_sub_epi32(above, _mm_castps_si128(_mm_cmpgt_ps(value, limit)));
+    }
+
+    _mm_storeu_ps(lanes[0], min);
+    _mm_storeu_ps(lanes[1], max);
+    _mm_storeu_ps(lanes[2], sum);
+    _mm_storeu_si128((__m128i*)counts[0], count);
+    _mm_storeu_si128((__m128i*)counts[1], above);
+
+    for (int lane = 0; lane < 4; ++lane) {
+        merge(result, counts[0][lane], 0, counts[1][lane], lanes[0][lane], lanes[1][lane],
+              lanes[2][lane]);
+    }
+    result->nan_count += i - (counts[0][0] + counts[0][1] + counts[0][2] + counts[0][3]);
+
+    scan_column_scalar(values + i, num_values - i, threshold, result);
+}
+
+#elif defined(SCAN_NEON)
+
+/**
+ * @brief Scans a block four values at a time, NAN lanes are masked to values that
+ *          leave the min, max, and sum unchanged
+ *
+ * @param values the block
+ * @param num_values the number of values, at most SCAN_BLOCK
+ * @param threshold the exceedance threshold
+ * @param result the result the block is added to
+ */
+static void scan_block(const float* values, uint32_t num_values, float threshold,
+                       struct Scan_Result* result) {
+    const float32x4_t infinity = vdupq_n_f32(INFINITY);
+    const float32x4_t negative_infinity = vdupq_n_f32(-INFINITY);
+    const float32x4_t limit = vdupq_n_f32(threshold);
+    float32x4_t min = infinity;
+    float32x4_t max = negative_infinity;
+    float32x4_t sum = vdupq_n_f32(0);
+    uint32x4_t count = vdupq_n_u32(0);
+    uint32x4_t above = vdupq_n_u32(0);
+    float lanes[3][4];
+    uint32_t counts[2][4];
+    uint32_t i = 0;
+
+    for (; i + 4 <= num_values; i += 4) {
+        float32x4_t value = vld1q_f32(values + i);
+        uint32x4_t valid = vceqq_f32(value, value);
+
+        min = vminq_f32(min, vbslq_f32(valid, value, infinity));
+        max = vmaxq_f32(max, vbslq_f32(valid, value, negative_infinity));
+        sum = vaddq_f32(sum, vreinterpretq_f32_u32(vandq_u32(valid, vreinterpretq_u32_f32(value))));
+        //A true comparison is all ones, so subtracting it counts the lane
+        count = vsubq_u32(count, valid);
+        above = vsubq_u32(above, vcgtq_f32(value, limit));
+    }
+
+    vst1q_f32(lanes[0], min);
+    vst1q_f32(lanes[1], max);
+    vst1q_f32(lanes[2], sum);
+    vst1q_u32(counts[0], count);
+    vst1q_u32(counts[1], above);
+
+    for (int lane = 0; lane < 4; ++lane) {
+        merge(result, counts[0][lane], 0, counts[1][lane], lanes[0][lane], lanes[1][lane],
+              lanes[2][lane]);
+    }
+    result->nan_count += i - (counts[0][0] + counts[0][1] + counts[0][2] + counts[0][3]);
+
+    scan_column_scalar(values + i, num_values - i, threshold, result);
+}
+
+#endif
+
+void scan_column(const float* values, uint32_t num_values, float threshold,
+                struct Scan_Result* result) {
+#if defined(SCAN_SSE2) || defined(SCAN_NEON)
+    for (uint32_t i = 0; i < num_values; i += SCAN_BLOCK) {
+        scan_block(values + i, num_values - i < SCAN_BLOCK ? num_values - i : SCAN_BLOCK,
+                   threshold, result);
+    }
+#else
+    scan_column_scalar(values, num_values, threshold, result);
+#endif
+}
+
+float scan_mean(const struct Scan_Result* result) {
+    return result->count > 0 ? (float)(result->sum / result->count) : NAN;
+}
+
+const char* scan_kernel(void) {
+#if defined(SCAN_SSE2)
+    return "sse2";
+#elif defined(SCAN_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,281 @@
+#include "../include/sensirion.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+void sensirion_wait(uint32_t delay_us) {
+    if (clock_source_is_virtual() || !i2c_bus_replaying()) {
+        clock_source_sleep_us(delay_us);
+    }
+}
+
+uint8_t sensirion_crc(const uint8_t* word) {
+    uint8_t crc = 0xFF;
+
+    for (int i = 0; i < SENSIRION_WORD_SIZE; ++i) {
+        crc ^= word[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ SENSIRION_CRC_POLYNOMIAL) : (uint8_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+int8_t sensirion_send(uint8_t device_addr, const struct Sensirion_Command* command, int* fd) {
+    uint8_t buffer[SENSIRION_WORD_SIZE] = {(uint8_t)(command->code >> 8), (uint8_t)command->code};
+
+    return i2c_bus_write(buffer, SENSIRION_WORD_SIZE, device_addr, fd);
+}
+
+/**
+ * @brief Reads the command's response, keeping the bytes as read for classifying
+ *
+ * @param device_addr the device's hex address on the I2C bus
+ * @param command the command that was sent
+ * @param raw the out parameter for the response as read, words and CRCs
+ * @param response the out parameter for the words
+ * @param fd the opened file descriptor for the I2C device
+ * @return the error from sensirion_receive()
+ */
+static int8_t receive_raw(uint8_t device_addr, const struct Sensirion_Command* command, 
+                          uint8_t* raw, uint8_t* response, int* fd) {
+    uint16_t size = command->response_words * (SENSIRION_WORD_SIZE + SENSIRION_CRC_LENGTH);
+    int8_t error;
+
+    if (command->response_words > SENSIRION_MAX_WORDS) {
+        return SIZE_ERR;
+    }
+
+    if ((error = i2c_bus_read(raw, size, device_addr, fd)) != NOERR) {
+        return error;
+    }
+
+    for (int i = 0; i < command->response_words; ++i) {
+        const uint8_t* word = &raw[i * (SENSIRION_WORD_SIZE + SENSIRION_CRC_LENGTH)];
+
+        if (sensirion_crc(word) != word[SENSIRION_WORD_SIZE]) {
+            return CRC_ERR;
+        }
+
+        response[i * SENSIRION_WORD_SIZE] = word[0];
+        response[i * SENSIRION_WORD_SIZE + 1] = word[1];
+    }
+
+    return NOERR;
+}
+
+/**
+ * @brief Reads the command's response and counts it if the device answered
+ *
+ * @param device_addr the device's hex address on the I2C bus
+ * @param command the command that was sent
+ * @param tuning the command's tuned delay and errors on the device, can be NULL
+ * @param raw the out parameter for the response as read, words and CRCs
+ * @param response the out parameter for the words
+ * @param fd the opened file descriptor for the I2C device
+ * @return the error from sensirion_receive()
+ */
+static int8_t read_response(uint8_t device_addr, const struct Sensirion_Command* command, 
+                            struct Sensirion_Tuning* tuning, uint8_t* raw, uint8_t* response, int* fd) {
+    int8_t error = receive_raw(device_addr, command, raw, response, fd);
+
+    if (tuning != NULL && (error == NOERR || error == CRC_ERR)) {
+        ++tuning->responses;
+    }
+
+    return error;
+}
+
+int8_t sensirion_receive(uint8_t device_addr, const struct Sensirion_Command* command, 
+                         uint8_t* response, int* fd) {
+    uint8_t raw[SENSIRION_MAX_WORDS * (SENSIRION_WORD_SIZE + SENSIRION_CRC_LENGTH)];
+
+    return receive_raw(device_addr, command, raw, response, fd);
+}
+
+enum Sensirion_Crc_Class sensirion_classify(const uint8_t* raw, uint16_t size, const uint8_t* previous) {
+    bool all_ones = true;
+    bool all_zeros = true;
+
+    for (uint16_t i = 0; i < size; ++i) {
+        all_ones &= raw[i] == 0xFF;
+        all_zeros &= raw[i] == 0x00;
+    }
+
+    if (all_ones || all_zeros) {
+        return SENSIRION_CRC_BUS_STUCK;
+    }
+
+    return previous != NULL && memcmp(raw, previous, size) == 0 
+        ? SENSIRION_CRC_SYSTEMATIC 
+        : SENSIRION_CRC_NOISE;
+}
+
+/**
+ * @brief Reads a response that failed the CRC again without resending the command
+ *
+ * Only noise is worth reading again. Bad bytes that repeat came from the device and
+ * need the command sent again, and a stuck bus needs the adapter reset
+ *
+ * @param device_addr the device's hex address on the I2C bus
+ * @param command the command that was sent
+ * @param tuning the command's tuned delay and errors on the device, can be NULL
+ * @param raw the response as read, overwritten by every read
+ * @param response the out parameter for the words
+ * @param fd the opened file descriptor for the I2C device
+ * @return BUS_ERR if the bus is stuck, CRC_ERR if the command has to be sent again,
+ *          the read's error otherwise
+ */
+static int8_t reread(uint8_t device_addr, const struct Sensirion_Command* command,
+                     struct Sensirion_Tuning* tuning, uint8_t* raw, uint8_t* response, int* fd) {
+    uint8_t previous[SENSIRION_MAX_WORDS * (SENSIRION_WORD_SIZE + SENSIRION_CRC_LENGTH)];
+    uint16_t size = command->response_words * (SENSIRION_WORD_SIZE + SENSIRION_CRC_LENGTH);
+    enum Sensirion_Crc_Class class = sensirion_classify(raw, size, NULL);
+    int8_t error = CRC_ERR;
+
+    for (int i = 0; i < command->rereads && class == SENSIRION_CRC_NOISE && error == CRC_ERR; ++i) {
+        memcpy(previous, raw, size);
+        error = read_response(device_addr, command, tuning, raw, response, fd);
+
+        if (tuning != NULL) {
+            ++tuning->rereads;
+        }
+
+        if (error == CRC_ERR) {
+            class = sensirion_classify(raw, size, previous);
+        }
+    }
+
+    if (tuning != NULL) {
+        ++tuning->crc_errors[class];
+    }
+
+    return class == SENSIRION_CRC_BUS_STUCK ? BUS_ERR : error;
+}
+
+/**
+ * @brief Backs the delay off toward the execution time after a NACK
+ *
+ * @param command the command that was NACKed
+ * @param tuning the command's tuned delay on the device
+ */
+static void tuning_nacked(const struct Sensirion_Command* command, struct Sensirion_Tuning* tuning) {
+    uint32_t delay_us = tuning->delay_us + tuning->delay_us / 2 + SENSIRION_MARGIN_MIN_US;
+
+    ++tuning->nacks;
+    tuning->clean_responses = 0;
+    tuning->delay_us = delay_us < command->execution_us ? delay_us : command->execution_us;
+}
+
+/**
+ * @brief Steps a backed off delay halfway back to the calibrated one after enough
+ *          clean responses
+ *
+ * @param tuning the command's tuned delay on the device
+ */
+static void tuning_responded(struct Sensirion_Tuning* tuning) {
+    if (tuning->delay_us <= tuning->calibrated_us 
+        || ++tuning->clean_responses < SENSIRION_TIGHTEN_AFTER) {
+        return;
+    }
+
+    tuning->delay_us -= (tuning->delay_us - tuning->calibrated_us + 1) / 2;
+    tuning->clean_responses = 0;
+}
+
+
+void sensirion_add_stats(struct Sensirion_Stats* stats, const struct Sensirion_Tuning* tuning) {
+    stats->responses += tuning->responses;
+    stats->nacks += tuning->nacks;
+    stats->rereads += tuning->rereads;
+    for (int class = 0; class < SENSIRION_CRC_CLASSES; ++class) {
+        stats->crc_errors[class] += tuning->crc_errors[class];
+    }
+}
+
+uint32_t sensirion_delay(const struct Sensirion_Command* command, const struct Sensirion_Tuning* tuning) {
+    return tuning != NULL && tuning->delay_us != 0 ? tuning->delay_us : command->execution_us;
+}
+
+int8_t sensirion_execute(uint8_t device_addr, const struct Sensirion_Command* command, 
+                         struct Sensirion_Tuning* tuning, uint8_t* response, int* fd) {
+    uint8_t raw[SENSIRION_MAX_WORDS * (SENSIRION_WORD_SIZE + SENSIRION_CRC_LENGTH)];
+    int8_t error = NOERR;
+
+    for (int attempt = 0; attempt < command->attempts; ++attempt) {
+        uint32_t delay_us = sensirion_delay(command, tuning);
+
+        if ((error = sensirion_send(device_addr, command, fd)) != NOERR) {
+            return error;
+        }
+
+        sensirion_wait(delay_us);
+
+        if (command->response_words == 0) {
+            return NOERR;
+        }
+
+        error = read_response(device_addr, command, tuning, raw, response, fd);
+
+        //Read too early, by the execution time the response is certainly ready
+        if (error == NACK_ERR && tuning != NULL && delay_us < command->execution_us) {
+            tuning_nacked(command, tuning);
+            sensirion_wait(command->execution_us - delay_us);
+            error = read_response(device_addr, command, tuning, raw, response, fd);
+        } else if (error == NOERR && tuning != NULL) {
+            tuning_responded(tuning);
+        }
+
+        if (error == CRC_ERR) {
+            error = reread(device_addr, command, tuning, raw, response, fd);
+        }
+
+        if (error != CRC_ERR) {
+            return error;
+        }
+    }
+
+    return error;
+}
+
+int8_t sensirion_calibrate(uint8_t device_addr, const struct Sensirion_Command* command,
+                           struct Sensirion_Tuning* tuning, int* fd) {
+    uint8_t response[SENSIRION_WORD_SIZE * SENSIRION_MAX_WORDS];
+    uint32_t slowest_us = 0;
+    int8_t error;
+
+    if (command->response_words == 0) {
+        return SIZE_ERR;
+    }
+
+    for (int round = 0; round < SENSIRION_CALIBRATION_ROUNDS; ++round) {
+        uint64_t start_us = clock_source_now_us();
+        uint32_t elapsed_us;
+
+        if ((error = sensirion_send(device_addr, command, fd)) != NOERR) {
+            return error;
+        }
+
+        do {
+            sensirion_wait(SENSIRION_PROBE_STEP_US);
+            elapsed_us = (uint32_t)(clock_source_now_us() - start_us);
+        } while ((error = sensirion_receive(device_addr, command, response, fd)) == NACK_ERR
+                 && elapsed_us < command->execution_us);
+
+        if (error != NOERR) {
+            return error;
+        }
+
+        slowest_us = elapsed_us > slowest_us ? elapsed_us : slowest_us;
+    }
+
+    uint32_t margin_us = slowest_us * SENSIRION_MARGIN_PERCENT / 100;
+    uint32_t delay_us = slowest_us + (margin_us > SENSIRION_MARGIN_MIN_US ? margin_us : SENSIRION_MARGIN_MIN_US);
+
+    tuning->calibrated_us = delay_us < command->execution_us ? delay_us : command->execution_us;
+    tuning->delay_us = tuning->calibrated_us;
+    tuning->clean_responses = 0;
+    return NOERR;
+}
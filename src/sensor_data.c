@@ -0,0 +1,30 @@
+#include "../include/sensor_data.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+void sensor_data_schedule(struct Sensor_Data* sample, uint32_t* sequence, uint64_t periods) {
+    *sequence += (uint32_t)periods;
+    sample->sequence = *sequence - 1;
+}
+
+void sensor_data_stamp(struct Sensor_Data* sample) {
+    clock_source_now(CLOCK_MONOTONIC, &sample->monotonic);
+    clock_source_now(CLOCK_REALTIME, &sample->realtime);
+}
+
+uint32_t sensor_data_gap(uint32_t previous, uint32_t current) {
+    return current - previous - 1;
+}
+
+uint64_t timespec_to_ms(const struct timespec* time) {
+    return (uint64_t)time->tv_sec * 1000 + (uint64_t)time->tv_nsec / 1000000;
+}
+
+uint64_t monotonic_now_ms(void) {
+    struct timespec now;
+
+    clock_source_now(CLOCK_MONOTONIC, &now);
+    return timespec_to_ms(&now);
+}
@@ -0,0 +1,95 @@
+#include "../include/shm_reader.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+int8_t shm_reader_open(const char* name, struct Shm_Reader* reader) {
+    const struct Shm_Table* table;
+    int fd;
+
+    if ((fd = shm_open(name, O_RDONLY, 0)) < 0) {
+        return INIT_ERR;
+    }
+
+    table = mmap(NULL, sizeof(struct Shm_Table), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (table == MAP_FAILED) {
+        return INIT_ERR;
+    }
+
+    if (table->magic != SHM_TABLE_MAGIC || table->version != SHM_TABLE_VERSION) {
+        munmap((void*)table, sizeof(struct Shm_Table));
+        return INIT_ERR;
+    }
+
+    reader->table = table;
+    return NOERR;
+}
+
+void shm_reader_close(struct Shm_Reader* reader) {
+    if (reader->table != NULL) {
+        munmap((void*)reader->table, sizeof(struct Shm_Table));
+        reader->table = NULL;
+    }
+}
+
+int8_t shm_reader_lookup(const struct Shm_Reader* reader, const char* device,
+                        const char* channel, struct Shm_Handle* handle) {
+    const struct Shm_Table* table = reader->table;
+    uint32_t layout;
+    int8_t error;
+
+    //Retried while the publisher is rewriting the device and channel names
+    do {
+        layout = atomic_load_explicit(&table->layout, memory_order_acquire);
+        error = ADDR_ERR;
+
+        for (uint32_t i = 0; i < table->num_devices && i < SHM_MAX_DEVICES && error != NOERR; ++i) {
+            const struct Shm_Device* entry = &table->devices[i];
+
+            if (strncmp(entry->name, device, SHM_NAME_SIZE) != 0) {
+                continue;
+            }
+
+            for (uint32_t j = 0; j < entry->num_channels && j < SHM_MAX_CHANNELS; ++j) {
+                if (strncmp(entry->channels[j], channel, SHM_NAME_SIZE) == 0) {
+                    handle->device = (int)i;
+                    handle->channel = (int)j;
+                    error = NOERR;
+                    break;
+                }
+            }
+        }
+
+        atomic_thread_fence(memory_order_acquire);
+    } while ((layout & 1) || layout != atomic_load_explicit(&table->layout, memory_order_relaxed));
+
+    handle->layout = layout;
+    return error;
+}
+
+int8_t shm_reader_read(const struct Shm_Reader* reader, const struct Shm_Handle* handle,
+                        struct Shm_Value* value) {
+    const struct Shm_Slot* slot = &reader->table->devices[handle->device].slots[handle->channel];
+    uint32_t sequence;
+
+    do {
+        sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+
+        value->value = slot->value;
+        value->sample_sequence = slot->sample_sequence;
+        value->monotonic_ms = slot->monotonic_ms;
+        value->realtime_ms = slot->realtime_ms;
+
+        atomic_thread_fence(memory_order_acquire);
+    } while ((sequence & 1) || sequence != atomic_load_explicit(&slot->sequence, memory_order_relaxed));
+
+    if (atomic_load_explicit(&reader->table->layout, memory_order_acquire) != handle->layout) {
+        return STALE_ERR;
+    }
+
+    //A slot that was never written, or was cleared for a new layout, has no timestamp
+    return sequence == 0 || value->monotonic_ms == 0 ? READ_ERR : NOERR;
+}
@@ -0,0 +1,161 @@
+#include "../include/shm_writer.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Opens a seqlock write section, readers retry until it is closed
+ *
+ * @param sequence the seqlock's counter
+ * @return the counter's value before the write
+ */
+static uint32_t write_begin(_Atomic uint32_t* sequence) {
+    uint32_t value = atomic_load_explicit(sequence, memory_order_relaxed);
+
+    atomic_store_explicit(sequence, value + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    return value;
+}
+
+/**
+ * @brief Closes the seqlock write section opened by write_begin()
+ *
+ * @param sequence the seqlock's counter
+ * @param value the value returned by write_begin()
+ */
+static void write_end(_Atomic uint32_t* sequence, uint32_t value) {
+    atomic_store_explicit(sequence, value + 2, memory_order_release);
+}
+
+/**
+ * @brief Closes a write section an earlier run crashed in, which would otherwise
+ *          leave readers retrying forever
+ *
+ * @param sequence the seqlock's counter
+ */
+static void write_recover(_Atomic uint32_t* sequence) {
+    uint32_t value = atomic_load_explicit(sequence, memory_order_relaxed);
+
+    if (value & 1) {
+        atomic_store_explicit(sequence, value + 1, memory_order_release);
+    }
+}
+
+/**
+ * @brief Clears the slot's value so it reads as having none, for a slot handed to
+ *          another device or channel
+ *
+ * @param slot the slot
+ */
+static void slot_clear(struct Shm_Slot* slot) {
+    uint32_t sequence = write_begin(&slot->sequence);
+
+    slot->value = NAN;
+    slot->sample_sequence = 0;
+    slot->monotonic_ms = 0;
+    slot->realtime_ms = 0;
+
+    write_end(&slot->sequence, sequence);
+}
+
+int8_t shm_table_create(const char* name, struct Shm_Table** table) {
+    int fd;
+
+    if ((fd = shm_open(name, O_CREAT | O_RDWR, 0644)) < 0) {
+        return INIT_ERR;
+    }
+
+    if (ftruncate(fd, sizeof(struct Shm_Table)) != 0) {
+        close(fd);
+        return INIT_ERR;
+    }
+
+    *table = mmap(NULL, sizeof(struct Shm_Table), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (*table == MAP_FAILED) {
+        *table = NULL;
+        return INIT_ERR;
+    }
+
+    //A table left by an earlier run keeps its counters so readers see the layout change
+    (*table)->magic = SHM_TABLE_MAGIC;
+    (*table)->version = SHM_TABLE_VERSION;
+    write_recover(&(*table)->layout);
+    for (int i = 0; i < SHM_MAX_DEVICES; ++i) {
+        for (int j = 0; j < SHM_MAX_CHANNELS; ++j) {
+            write_recover(&(*table)->devices[i].slots[j].sequence);
+        }
+    }
+
+    return NOERR;
+}
+
+void shm_table_destroy(const char* name, struct Shm_Table** table) {
+    if (*table == NULL) {
+        return;
+    }
+
+    munmap(*table, sizeof(struct Shm_Table));
+    shm_unlink(name);
+    *table = NULL;
+}
+
+void shm_table_layout(struct Shm_Table* table, const uint8_t* device_addrs, int num_devices) {
+    uint32_t layout = write_begin(&table->layout);
+    uint32_t old_devices = table->num_devices;
+
+    table->num_devices = 0;
+    for (int i = 0; i < num_devices && i < SHM_MAX_DEVICES; ++i) {
+        struct Shm_Device* device = &table->devices[i];
+        const char* channel;
+
+        //Another device's readings must not show up under this device's name
+        if (i >= (int)old_devices || device->address != device_addrs[i]) {
+            for (int j = 0; j < SHM_MAX_CHANNELS; ++j) {
+                slot_clear(&device->slots[j]);
+            }
+        }
+
+        device->address = device_addrs[i];
+        strncpy(device->name, device_name(device_addrs[i]), SHM_NAME_SIZE - 1);
+        device->name[SHM_NAME_SIZE - 1] = '\0';
+
+        device->num_channels = 0;
+        while (device->num_channels < SHM_MAX_CHANNELS
+                && (channel = channel_name(device_addrs[i], device->num_channels)) != NULL) {
+            strncpy(device->channels[device->num_channels], channel, SHM_NAME_SIZE - 1);
+            device->channels[device->num_channels][SHM_NAME_SIZE - 1] = '\0';
+            ++device->num_channels;
+        }
+
+        ++table->num_devices;
+    }
+
+    write_end(&table->layout, layout);
+}
+
+void shm_table_update(struct Shm_Table* table, const struct Sensor_Data* sample) {
+    for (uint32_t i = 0; i < table->num_devices; ++i) {
+        struct Shm_Device* device = &table->devices[i];
+
+        if (device->address != sample->device_addr) {
+            continue;
+        }
+
+        for (uint32_t j = 0; j < device->num_channels && j < (uint32_t)sample->num_data; ++j) {
+            struct Shm_Slot* slot = &device->slots[j];
+            uint32_t sequence = write_begin(&slot->sequence);
+
+            slot->value = sample->data[j];
+            slot->sample_sequence = sample->sequence;
+            slot->monotonic_ms = timespec_to_ms(&sample->monotonic);
+            slot->realtime_ms = timespec_to_ms(&sample->realtime);
+
+            write_end(&slot->sequence, sequence);
+        }
+        return;
+    }
+}
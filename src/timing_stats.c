@@ -0,0 +1,59 @@
+#include "../include/timing_stats.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Gets the histogram bucket for the lateness
+ *
+ * Bucket 0 holds anything below 2us, bucket i holds [2^i, 2^(i + 1)) microseconds
+ *
+ * @param lateness_us the lateness in microseconds
+ * @return the index of the bucket
+ */
+static int lateness_bucket(uint64_t lateness_us) {
+    int bucket = lateness_us < 2 ? 0 : 63 - __builtin_clzll(lateness_us);
+
+    return bucket < TIMING_BUCKETS ? bucket : TIMING_BUCKETS - 1;
+}
+
+uint64_t timing_lateness_us(const struct Sensor_Data* sample) {
+    int64_t lateness_ns = (sample->monotonic.tv_sec - sample->scheduled.tv_sec) * 1000000000LL
+                        + (sample->monotonic.tv_nsec - sample->scheduled.tv_nsec);
+
+    return lateness_ns > 0 ? (uint64_t)lateness_ns / 1000 : 0;
+}
+
+void timing_stats_add(struct Timing_Stats* stats, const struct Sensor_Data* sample) {
+    uint64_t lateness_us = timing_lateness_us(sample);
+
+    ++stats->samples;
+    stats->overruns = sample->overruns;
+    stats->last_lateness_us = lateness_us;
+    if (lateness_us > stats->max_lateness_us) {
+        stats->max_lateness_us = lateness_us;
+    }
+
+    ++stats->histogram[lateness_bucket(lateness_us)];
+}
+
+uint64_t timing_stats_percentile(const struct Timing_Stats* stats, double percentile) {
+    uint64_t rank = (uint64_t)((percentile / 100.0) * stats->samples + 0.5);
+    uint64_t seen = 0;
+
+    if (stats->samples == 0) {
+        return 0;
+    }
+
+    for (int i = 0; i < TIMING_BUCKETS; ++i) {
+        seen += stats->histogram[i];
+
+        if (seen >= rank && seen != 0) {
+            uint64_t upper = (2ULL << i) - 1;
+            return upper < stats->max_lateness_us ? upper : stats->max_lateness_us;
+        }
+    }
+
+    return stats->max_lateness_us;
+}
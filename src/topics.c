@@ -0,0 +1,92 @@
+#include "../include/topics.h"
+
+/*******************************************************************************
+*                           Function Implementations                           *
+*******************************************************************************/
+
+/**
+ * @brief Gets the value of the placeholder at the start of the template
+ *
+ * @param template the rest of the topic template, starting with '{'
+ * @param gateway the gateway's name
+ * @param device the device's name
+ * @param channel the channel's name
+ * @param placeholder_length the out parameter for the length of the placeholder
+ * @return the placeholder's value or NULL if the placeholder is unknown
+ */
+static const char* placeholder_value(const char* template, const char* gateway, 
+                                    const char* device, const char* channel,
+                                    size_t* placeholder_length) {
+    static const char* PLACEHOLDERS[] = {"{gateway}", "{device}", "{channel}"};
+    const char* values[] = {gateway, device, channel};
+
+    for (int i = 0; i < 3; ++i) {
+        *placeholder_length = strlen(PLACEHOLDERS[i]);
+        if (strncmp(template, PLACEHOLDERS[i], *placeholder_length) == 0) {
+            return values[i];
+        }
+    }
+
+    return NULL;
+}
+
+int8_t topic_format(char* topic, size_t size, const char* template, const char* gateway,
+                    const char* device, const char* channel) {
+    size_t length = 0;
+
+    while (*template != '\0') {
+        const char* value = template;
+        size_t value_length = 1;
+        size_t placeholder_length = 1;
+
+        if (*template == '{') {
+            if ((value = placeholder_value(template, gateway, device, channel, 
+                                        &placeholder_length)) == NULL) {
+                return CONFIG_ERR;
+            }
+            value_length = strlen(value);
+        }
+
+        if (length + value_length >= size) {
+            return SIZE_ERR;
+        }
+
+        memcpy(topic + length, value, value_length);
+        length += value_length;
+        template += placeholder_length;
+    }
+
+    topic[length] = '\0';
+    return NOERR;
+}
+
+void topic_aliases_reset(struct Topic_Aliases* aliases, uint16_t maximum) {
+    aliases->maximum = maximum < TOPIC_ALIAS_MAX_TOPICS ? maximum : TOPIC_ALIAS_MAX_TOPICS;
+    aliases->num_topics = 0;
+}
+
+uint16_t topic_alias_lookup(struct Topic_Aliases* aliases, const char* topic, bool* established) {
+    *established = false;
+
+    for (int i = 0; i < aliases->num_topics; ++i) {
+        if (strcmp(aliases->topics[i], topic) == 0) {
+            *established = aliases->established[i];
+            return (uint16_t)(i + 1);
+        }
+    }
+
+    if (aliases->num_topics >= aliases->maximum || strlen(topic) >= TOPIC_SIZE) {
+        return 0;
+    }
+
+    strcpy(aliases->topics[aliases->num_topics], topic);
+    aliases->established[aliases->num_topics] = false;
+
+    return (uint16_t)++aliases->num_topics;
+}
+
+void topic_alias_established(struct Topic_Aliases* aliases, uint16_t alias) {
+    if (alias > 0 && alias <= aliases->num_topics) {
+        aliases->established[alias - 1] = true;
+    }
+}
@@ -0,0 +1,63 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/alerts.c"
+
+static struct Alert_Rule rules[2];
+static struct Alert_Engine engine;
+static struct Alert_Event events[ALERT_MAX_RULES];
+
+void setUp() {
+    TEST_ASSERT_EQUAL_INT(NOERR, alert_compile("co2_high: SCD40.co2 > 1500", &rules[0]));
+    TEST_ASSERT_EQUAL_INT(NOERR, alert_compile("pm_spike : delta(SEN55.pm2_5) >= 50 || "
+                                                "(SEN55.pm10 - 2 * 10) > 100", &rules[1]));
+    alert_engine_init(&engine, rules, 2);
+}
+
+void tearDown() {
+}
+
+static int add(uint8_t device_addr, float first, float second) {
+    struct Sensor_Data sample = {.device_addr = device_addr, .num_data = 4};
+    sample.data[0] = device_addr == SCD40_ADDRESS ? first : 0;
+    sample.data[1] = device_addr == SEN55_ADDRESS ? first : 0;
+    sample.data[3] = second;
+    return alert_engine_update(&engine, &sample, events);
+}
+
+void test_rejects_invalid_rules(void) {
+    struct Alert_Rule rule;
+
+    TEST_ASSERT_EQUAL_INT(CONFIG_ERR, alert_compile("SCD40.co2 > 1500", &rule));
+    TEST_ASSERT_EQUAL_INT(CONFIG_ERR, alert_compile("bad name: SCD40.co2 > 1500", &rule));
+    TEST_ASSERT_EQUAL_INT(CONFIG_ERR, alert_compile("x: SCD40.pm2_5 > 1", &rule));
+    TEST_ASSERT_EQUAL_INT(CONFIG_ERR, alert_compile("x: (SCD40.co2 > 1", &rule));
+    TEST_ASSERT_EQUAL_INT(CONFIG_ERR, alert_compile("x: SCD40.co2 >", &rule));
+    TEST_ASSERT_EQUAL_STRING("pm_spike", rules[1].name);
+}
+
+void test_fires_once_per_change_of_state(void) {
+    TEST_ASSERT_EQUAL_INT(0, add(SCD40_ADDRESS, 800, 0));
+    TEST_ASSERT_EQUAL_INT(1, add(SCD40_ADDRESS, 1600, 0));
+    TEST_ASSERT_TRUE(events[0].active);
+    TEST_ASSERT_EQUAL_STRING("co2_high", events[0].rule->name);
+
+    TEST_ASSERT_EQUAL_INT(0, add(SCD40_ADDRESS, 1700, 0));
+    TEST_ASSERT_EQUAL_INT(1, add(SCD40_ADDRESS, NAN, 0));
+    TEST_ASSERT_FALSE(events[0].active);
+}
+
+void test_delta_and_arithmetic(void) {
+    TEST_ASSERT_EQUAL_INT(0, add(SEN55_ADDRESS, 10, 20));
+    TEST_ASSERT_EQUAL_INT(1, add(SEN55_ADDRESS, 70, 20));
+    TEST_ASSERT_EQUAL_PTR(&rules[1], events[0].rule);
+    TEST_ASSERT_EQUAL_INT(1, add(SEN55_ADDRESS, 75, 20));
+    TEST_ASSERT_EQUAL_INT(1, add(SEN55_ADDRESS, 75, 121));
+    TEST_ASSERT_TRUE(events[0].active);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_rejects_invalid_rules);
+    RUN_TEST(test_fires_once_per_change_of_state);
+    RUN_TEST(test_delta_and_arithmetic);
+    return UNITY_END();
+}
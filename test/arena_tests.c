@@ -0,0 +1,79 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/arena.c"
+#include "../src/alloc_count.c"
+
+#define ARENA_SIZE 1024
+
+static struct Arena arena;
+
+void setUp() {
+    TEST_ASSERT_EQUAL_INT8(NOERR, arena_init(&arena, ARENA_SIZE));
+}
+
+void tearDown() {
+    arena_free(&arena);
+}
+
+void test_allocations_are_aligned(void) {
+    uint8_t* first = arena_alloc(&arena, 3);
+    uint8_t* second = arena_alloc(&arena, 5);
+
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_NOT_NULL(second);
+    TEST_ASSERT_EQUAL_size_t(0, (uintptr_t)(second - first) % ARENA_ALIGNMENT);
+    TEST_ASSERT_EQUAL_size_t(ARENA_ALIGNMENT + 5, arena.used);
+}
+
+void test_exhausted_until_reset(void) {
+    TEST_ASSERT_NOT_NULL(arena_alloc(&arena, ARENA_SIZE - 8));
+    TEST_ASSERT_NULL(arena_alloc(&arena, 16));
+    TEST_ASSERT_NULL(arena_alloc(&arena, SIZE_MAX));
+    TEST_ASSERT_EQUAL_UINT32(2, arena.exhausted);
+    TEST_ASSERT_TRUE(arena.overflowed);
+
+    arena_reset(&arena);
+    TEST_ASSERT_FALSE(arena.overflowed);
+    TEST_ASSERT_NOT_NULL(arena_alloc(&arena, 16));
+    TEST_ASSERT_EQUAL_size_t(ARENA_SIZE - 8, arena.high_water);
+}
+
+void test_reuses_memory_after_reset(void) {
+    void* first = arena_alloc(&arena, 64);
+
+    arena_reset(&arena);
+    TEST_ASSERT_EQUAL_PTR(first, arena_alloc(&arena, 64));
+}
+
+void test_counts_allocations(void) {
+    uint64_t allocations = alloc_count_total();
+    uint64_t frees = alloc_count_frees();
+    void* pointer = malloc(16);
+
+    pointer = realloc(pointer, 32);
+    free(pointer);
+    free(calloc(4, 4));
+
+    TEST_ASSERT_EQUAL_UINT64(allocations + 3, alloc_count_total());
+    TEST_ASSERT_EQUAL_UINT64(frees + 2, alloc_count_frees());
+}
+
+void test_no_allocations_after_init(void) {
+    uint64_t allocations = alloc_count_total();
+
+    for (int i = 0; i < 1000; ++i) {
+        while (arena_alloc(&arena, 24) != NULL) {}
+        arena_reset(&arena);
+    }
+
+    TEST_ASSERT_EQUAL_UINT64(allocations, alloc_count_total());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_allocations_are_aligned);
+    RUN_TEST(test_exhausted_until_reset);
+    RUN_TEST(test_reuses_memory_after_reset);
+    RUN_TEST(test_counts_allocations);
+    RUN_TEST(test_no_allocations_after_init);
+    return UNITY_END();
+}
@@ -0,0 +1,89 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/backlog.c"
+
+static struct Backlog backlog;
+
+void setUp() {
+    backlog_init(&backlog);
+}
+
+void tearDown() {}
+
+static struct Joined_Record make_record(uint64_t bucket) {
+    struct Joined_Record record = {.bucket = bucket};
+    return record;
+}
+
+void test_publishes_oldest_first(void) {
+    struct Joined_Record first = make_record(1);
+    struct Joined_Record second = make_record(2);
+
+    TEST_ASSERT_NULL(backlog_peek(&backlog));
+    TEST_ASSERT_FALSE(backlog_push(&backlog, &first));
+    TEST_ASSERT_FALSE(backlog_push(&backlog, &second));
+
+    TEST_ASSERT_EQUAL_UINT64(1, backlog_peek(&backlog)->bucket);
+    backlog_pop(&backlog);
+    TEST_ASSERT_EQUAL_UINT64(2, backlog_peek(&backlog)->bucket);
+    backlog_pop(&backlog);
+    TEST_ASSERT_NULL(backlog_peek(&backlog));
+}
+
+void test_evicts_oldest_when_full(void) {
+    for (uint64_t i = 0; i < BACKLOG_SIZE; ++i) {
+        struct Joined_Record record = make_record(i);
+        TEST_ASSERT_FALSE(backlog_push(&backlog, &record));
+    }
+
+    struct Joined_Record newest = make_record(BACKLOG_SIZE);
+    TEST_ASSERT_TRUE(backlog_push(&backlog, &newest));
+    TEST_ASSERT_EQUAL_UINT32(BACKLOG_SIZE, backlog.count);
+    TEST_ASSERT_EQUAL_UINT32(1, backlog.dropped);
+    TEST_ASSERT_EQUAL_UINT64(1, backlog_peek(&backlog)->bucket);
+}
+
+void test_sent_records_stay_until_popped(void) {
+    for (uint64_t i = 1; i <= 3; ++i) {
+        struct Joined_Record record = make_record(i);
+        backlog_push(&backlog, &record);
+    }
+
+    backlog_sent(&backlog);
+    backlog_sent(&backlog);
+    TEST_ASSERT_EQUAL_UINT64(3, backlog_next(&backlog)->bucket);
+    TEST_ASSERT_EQUAL_UINT64(1, backlog_peek(&backlog)->bucket);
+
+    //A confirmed record leaves, the other one is sent again after a lost connection
+    backlog_pop(&backlog);
+    TEST_ASSERT_EQUAL_UINT32(1, backlog.sent);
+    backlog_resend(&backlog);
+    TEST_ASSERT_EQUAL_UINT64(2, backlog_next(&backlog)->bucket);
+
+    backlog_sent(&backlog);
+    backlog_sent(&backlog);
+    TEST_ASSERT_NULL(backlog_next(&backlog));
+    backlog_sent(&backlog);
+    TEST_ASSERT_EQUAL_UINT32(2, backlog.sent);
+}
+
+void test_evicting_a_sent_record_uncounts_it(void) {
+    for (uint64_t i = 0; i < BACKLOG_SIZE; ++i) {
+        struct Joined_Record record = make_record(i);
+        backlog_push(&backlog, &record);
+    }
+    backlog_sent(&backlog);
+
+    struct Joined_Record newest = make_record(BACKLOG_SIZE);
+    TEST_ASSERT_TRUE(backlog_push(&backlog, &newest));
+    TEST_ASSERT_EQUAL_UINT32(0, backlog.sent);
+    TEST_ASSERT_EQUAL_UINT64(1, backlog_next(&backlog)->bucket);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_publishes_oldest_first);
+    RUN_TEST(test_evicts_oldest_when_full);
+    RUN_TEST(test_sent_records_stay_until_popped);
+    RUN_TEST(test_evicting_a_sent_record_uncounts_it);
+    return UNITY_END();
+}
@@ -0,0 +1,128 @@
+#include <stdlib.h>
+#include "../unity/Unity/src/unity.h"
+#include "../src/bus_capture.c"
+#include "../src/i2c_bus.c"
+
+#define FIRST_ADDRESS 0x69
+#define SECOND_ADDRESS 0x62
+
+static char path[] = "/tmp/bus_capture_testsXXXXXX";
+static struct Bus_Capture written;
+static struct Bus_Capture replayed;
+
+void setUp() {
+    int fd = mkstemp(path);
+
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+}
+
+void tearDown() {
+    i2c_bus_replay(NULL);
+    bus_capture_close(&written);
+    bus_capture_close(&replayed);
+    unlink(path);
+    strcpy(path, "/tmp/bus_capture_testsXXXXXX");
+}
+
+void test_records_are_one_cache_line(void) {
+    TEST_ASSERT_EQUAL_size_t(64, sizeof(struct Bus_Capture_Record));
+}
+
+void test_replays_each_device_in_order(void) {
+    const uint8_t command[] = {0x02, 0x02};
+    const uint8_t response[] = {0x00, 0x01, 0xB0};
+    const struct Bus_Capture_Record* record;
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, bus_capture_create(&written, path, 16));
+    bus_capture_add(&written, FIRST_ADDRESS, BUS_WRITE, command, sizeof(command), NOERR);
+    bus_capture_add(&written, SECOND_ADDRESS, BUS_READ, response, sizeof(response), NACK_ERR);
+    bus_capture_add(&written, FIRST_ADDRESS, BUS_READ, response, sizeof(response), NOERR);
+    bus_capture_close(&written);
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, bus_capture_open(&replayed, path));
+    TEST_ASSERT_EQUAL_UINT64(3, bus_capture_count(&replayed));
+
+    record = bus_capture_next(&replayed, FIRST_ADDRESS, BUS_WRITE);
+    TEST_ASSERT_NOT_NULL(record);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(command, record->data, sizeof(command));
+
+    record = bus_capture_next(&replayed, FIRST_ADDRESS, BUS_READ);
+    TEST_ASSERT_NOT_NULL(record);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(response, record->data, sizeof(response));
+    TEST_ASSERT_TRUE(bus_capture_done(&replayed, FIRST_ADDRESS));
+
+    //A failed read keeps its result but none of its bytes
+    record = bus_capture_next(&replayed, SECOND_ADDRESS, BUS_READ);
+    TEST_ASSERT_NOT_NULL(record);
+    TEST_ASSERT_EQUAL_INT8(NACK_ERR, record->result);
+    TEST_ASSERT_EQUAL_HEX8(0, record->data[0]);
+
+    bus_capture_rewind(&replayed);
+    TEST_ASSERT_FALSE(bus_capture_done(&replayed, FIRST_ADDRESS));
+}
+
+void test_ring_keeps_the_newest_records(void) {
+    uint8_t value;
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, bus_capture_create(&written, path, 4));
+    for (value = 0; value < 10; ++value) {
+        bus_capture_add(&written, FIRST_ADDRESS, BUS_WRITE, &value, 1, NOERR);
+    }
+    bus_capture_close(&written);
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, bus_capture_open(&replayed, path));
+    TEST_ASSERT_EQUAL_UINT64(4, bus_capture_count(&replayed));
+    for (value = 6; value < 10; ++value) {
+        TEST_ASSERT_EQUAL_HEX8(value, bus_capture_next(&replayed, FIRST_ADDRESS, BUS_WRITE)->data[0]);
+    }
+    TEST_ASSERT_NULL(bus_capture_next(&replayed, FIRST_ADDRESS, BUS_WRITE));
+}
+
+void test_rejects_other_files(void) {
+    FILE* file = fopen(path, "w");
+
+    fputs("not a capture, but long enough to hold a capture's header", file);
+    fclose(file);
+    TEST_ASSERT_EQUAL_INT8(SIZE_ERR, bus_capture_open(&replayed, path));
+    TEST_ASSERT_EQUAL_INT8(SIZE_ERR, bus_capture_create(&written, path, 0));
+}
+
+void test_bus_serves_transfers_from_replay(void) {
+    uint8_t command[] = {0x03, 0xC4};
+    uint8_t other[] = {0x02, 0x02};
+    const uint8_t response[] = {0xBE, 0xEF, 0x92};
+    uint8_t data[3] = {0};
+    int fd;
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, bus_capture_create(&written, path, 16));
+    bus_capture_add(&written, FIRST_ADDRESS, BUS_WRITE, command, sizeof(command), NOERR);
+    bus_capture_add(&written, FIRST_ADDRESS, BUS_READ, response, sizeof(response), NOERR);
+    bus_capture_add(&written, FIRST_ADDRESS, BUS_WRITE, command, sizeof(command), NOERR);
+    bus_capture_close(&written);
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, bus_capture_open(&replayed, path));
+    i2c_bus_replay(&replayed);
+    TEST_ASSERT_TRUE(i2c_bus_replaying());
+    TEST_ASSERT_EQUAL_INT(NOERR, i2c_bus_open(1, &fd));
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, i2c_bus_write(command, sizeof(command), FIRST_ADDRESS, &fd));
+    TEST_ASSERT_EQUAL_INT8(NOERR, i2c_bus_read(data, sizeof(data), FIRST_ADDRESS, &fd));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(response, data, sizeof(response));
+
+    //A different command than the one captured has diverged
+    TEST_ASSERT_EQUAL_INT8(WRITE_ERR, i2c_bus_write(other, sizeof(other), FIRST_ADDRESS, &fd));
+    TEST_ASSERT_EQUAL_INT8(READ_ERR, i2c_bus_read(data, sizeof(data), FIRST_ADDRESS, &fd));
+
+    i2c_bus_close(&fd);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_records_are_one_cache_line);
+    RUN_TEST(test_replays_each_device_in_order);
+    RUN_TEST(test_ring_keeps_the_newest_records);
+    RUN_TEST(test_rejects_other_files);
+    RUN_TEST(test_bus_serves_transfers_from_replay);
+    return UNITY_END();
+}
@@ -0,0 +1,80 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/functions.c"
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_decodes_unsigned_words(void) {
+    const uint8_t bytes[] = {0x01, 0x2C};
+
+    TEST_ASSERT_EQUAL_FLOAT(30.0F, channel_decode(bytes, CHANNEL_UNSIGNED, 0.1F, 0.0F, 0xFFFF));
+}
+
+void test_decodes_signed_words(void) {
+    const uint8_t bytes[] = {0xFF, 0x38};
+
+    TEST_ASSERT_EQUAL_FLOAT(-2.0F, channel_decode(bytes, CHANNEL_SIGNED, 0.01F, 0.0F, 0x7FFF));
+}
+
+void test_invalid_marker_is_nan(void) {
+    const uint8_t max_unsigned[] = {0xFF, 0xFF};
+    const uint8_t max_signed[] = {0x7F, 0xFF};
+
+    TEST_ASSERT_TRUE(isnan(channel_decode(max_unsigned, CHANNEL_UNSIGNED, 0.1F, 0.0F, 0xFFFF)));
+    TEST_ASSERT_TRUE(isnan(channel_decode(max_signed, CHANNEL_SIGNED, 0.1F, 0.0F, 0x7FFF)));
+    TEST_ASSERT_FALSE(isnan(channel_decode(max_unsigned, CHANNEL_UNSIGNED, 1.0F, 0.0F, 
+                                           CHANNEL_NO_INVALID)));
+}
+
+void test_sen55_temperature_in_fahrenheit(void) {
+    const struct Channel_Descriptor* channel = channel_descriptor(SEN55_ADDRESS, SEN55_TEMPERATURE);
+    const uint8_t bytes[] = {0x13, 0x88};
+
+    TEST_ASSERT_EQUAL_STRING("F", channel->unit);
+    TEST_ASSERT_FLOAT_WITHIN(0.001F, 77.0F, channel_decode(bytes, channel->is_signed, channel->scale,
+                                                           channel->offset, channel->invalid));
+}
+
+void test_tables_are_consistent(void) {
+    int num_devices;
+    const uint8_t* addresses = known_devices(&num_devices);
+
+    for (int i = 0; i < num_devices; ++i) {
+        for (int j = 0; j < channel_count(addresses[i]); ++j) {
+            const struct Channel_Descriptor* channel = channel_descriptor(addresses[i], j);
+
+            TEST_ASSERT_NOT_NULL(channel);
+            for (int k = 0; k < j; ++k) {
+                TEST_ASSERT_NOT_EQUAL(channel->word, channel_descriptor(addresses[i], k)->word);
+                TEST_ASSERT_NOT_EQUAL(0, strcmp(channel->key, channel_name(addresses[i], k)));
+            }
+        }
+
+        TEST_ASSERT_NULL(channel_descriptor(addresses[i], channel_count(addresses[i])));
+        TEST_ASSERT_NULL(channel_descriptor(addresses[i], -1));
+    }
+}
+
+void test_parses_channel_references(void) {
+    uint8_t address;
+    int channel;
+
+    TEST_ASSERT_TRUE(channel_parse("SEN55.pm2_5", 11, &address, &channel));
+    TEST_ASSERT_EQUAL_HEX8(SEN55_ADDRESS, address);
+    TEST_ASSERT_EQUAL_INT(SEN55_PM2_5, channel);
+    TEST_ASSERT_TRUE(channel_parse("SCD40.co2", 9, &address, &channel));
+    TEST_ASSERT_EQUAL_INT(SCD40_CO2, channel);
+    TEST_ASSERT_FALSE(channel_parse("SCD40.pm2_5", 11, &address, &channel));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_decodes_unsigned_words);
+    RUN_TEST(test_decodes_signed_words);
+    RUN_TEST(test_invalid_marker_is_nan);
+    RUN_TEST(test_sen55_temperature_in_fahrenheit);
+    RUN_TEST(test_tables_are_consistent);
+    RUN_TEST(test_parses_channel_references);
+    return UNITY_END();
+}
@@ -0,0 +1,69 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/clock_source.c"
+
+#define EPOCH_NS 1700000000000000000ULL
+#define SECOND_US 1000000ULL
+
+void setUp() {
+    clock_source_use_virtual(EPOCH_NS);
+}
+
+void tearDown() {
+    clock_source_use_real();
+}
+
+void test_virtual_clock_only_moves_when_slept_on(void) {
+    struct timespec monotonic;
+    struct timespec realtime;
+
+    TEST_ASSERT_TRUE(clock_source_is_virtual());
+    TEST_ASSERT_EQUAL_UINT64(CLOCK_SOURCE_VIRTUAL_START_NS / 1000, clock_source_now_us());
+
+    clock_source_sleep_us(1500);
+    clock_source_now(CLOCK_MONOTONIC, &monotonic);
+    clock_source_now(CLOCK_REALTIME, &realtime);
+    TEST_ASSERT_EQUAL_INT64(1, monotonic.tv_sec);
+    TEST_ASSERT_EQUAL_INT64(1500000, monotonic.tv_nsec);
+    TEST_ASSERT_EQUAL_INT64((EPOCH_NS + 1500000) / 1000000000, realtime.tv_sec);
+    TEST_ASSERT_EQUAL_INT64((EPOCH_NS + 1500000) % 1000000000, realtime.tv_nsec);
+
+    //The clock never goes back
+    clock_source_advance_to(0);
+    TEST_ASSERT_EQUAL_UINT64(CLOCK_SOURCE_VIRTUAL_START_NS / 1000 + 1500, clock_source_now_us());
+}
+
+void test_timer_counts_overruns(void) {
+    struct Clock_Timer timer;
+    uint64_t start_us = clock_source_now_us();
+
+    clock_timer_start(&timer, SECOND_US);
+    TEST_ASSERT_EQUAL_UINT64(1, clock_timer_wait(&timer));
+    TEST_ASSERT_EQUAL_UINT64(start_us + SECOND_US, clock_source_now_us());
+
+    //Running over two and a half periods misses the expirations in between
+    clock_source_sleep_us(5 * SECOND_US / 2);
+    TEST_ASSERT_EQUAL_UINT64(2, clock_timer_wait(&timer));
+    TEST_ASSERT_EQUAL_UINT64(1, clock_timer_wait(&timer));
+    TEST_ASSERT_EQUAL_UINT64(start_us + 4 * SECOND_US, clock_source_now_us());
+}
+
+void test_real_clock_sleeps(void) {
+    struct Clock_Timer timer;
+    uint64_t start_us;
+
+    clock_source_use_real();
+    TEST_ASSERT_FALSE(clock_source_is_virtual());
+
+    start_us = clock_source_now_us();
+    clock_timer_start(&timer, 2000);
+    TEST_ASSERT_TRUE(clock_timer_wait(&timer) >= 1);
+    TEST_ASSERT_TRUE(clock_source_now_us() - start_us >= 2000);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_virtual_clock_only_moves_when_slept_on);
+    RUN_TEST(test_timer_counts_overruns);
+    RUN_TEST(test_real_clock_sleeps);
+    return UNITY_END();
+}
@@ -0,0 +1,100 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/sensor_data.c"
+#include "../src/columnar.c"
+
+#define START_MS 1700000000000ULL
+#define PERIOD_MS 5000
+#define ROWS (COLUMNAR_ROW_GROUP + 10)
+
+static char directory[] = "/tmp/columnar_testsXXXXXX";
+static char path[COLUMNAR_PATH_SIZE + 64];
+static struct Column_Writer writer;
+static struct Column_Reader reader;
+static uint64_t timestamps[COLUMNAR_ROW_GROUP];
+static float values[MAX_DATAPOINTS][COLUMNAR_ROW_GROUP];
+
+void setUp() {
+    columnar_writer_init(&writer, directory, 86400, SCD40_ADDRESS, SCD40_DATAPOINTS);
+}
+
+void tearDown() {
+    columnar_reader_close(&reader);
+    remove(path);
+}
+
+static void add_reading(uint64_t ms, float co2) {
+    struct Sensor_Data sample = {.device_addr = SCD40_ADDRESS, .num_data = SCD40_DATAPOINTS};
+    sample.realtime.tv_sec = ms / 1000;
+    sample.realtime.tv_nsec = (ms % 1000) * 1000000;
+    sample.data[0] = co2;
+    sample.data[1] = 21.5f;
+    sample.data[2] = NAN;
+    TEST_ASSERT_EQUAL_INT(NOERR, columnar_writer_add(&writer, &sample));
+}
+
+static void write_rows(void) {
+    for (uint64_t i = 0; i < ROWS; ++i) {
+        add_reading(START_MS + i * PERIOD_MS, 400.0f + (float)(i % 50));
+    }
+    TEST_ASSERT_EQUAL_INT(NOERR, columnar_writer_close(&writer));
+
+    //The first row falls on 2023-11-14 UTC
+    snprintf(path, sizeof(path), "%s/SCD40-20231114T000000Z.aqc", directory);
+    TEST_ASSERT_EQUAL_INT(NOERR, columnar_reader_open(path, &reader));
+}
+
+void test_row_groups_round_trip(void) {
+    write_rows();
+
+    TEST_ASSERT_EQUAL_UINT8(SCD40_ADDRESS, reader.footer.device_addr);
+    TEST_ASSERT_EQUAL_STRING("co2", reader.footer.channels[0]);
+    TEST_ASSERT_EQUAL_UINT32(2, reader.footer.num_groups);
+    TEST_ASSERT_EQUAL_UINT32(10, reader.footer.groups[1].num_rows);
+
+    TEST_ASSERT_EQUAL_INT(NOERR, columnar_reader_group(&reader, 1, timestamps, values));
+    TEST_ASSERT_EQUAL_UINT64(START_MS + COLUMNAR_ROW_GROUP * PERIOD_MS, timestamps[0]);
+    TEST_ASSERT_EQUAL_UINT64(START_MS + (ROWS - 1) * PERIOD_MS, timestamps[9]);
+    TEST_ASSERT_EQUAL_FLOAT(420.0f, values[0][0]);
+    TEST_ASSERT_EQUAL_FLOAT(21.5f, values[1][9]);
+    TEST_ASSERT_TRUE(isnan(values[2][5]));
+}
+
+void test_statistics_skip_row_groups(void) {
+    const struct Row_Group_Info* first;
+
+    write_rows();
+    first = &reader.footer.groups[0];
+
+    TEST_ASSERT_EQUAL_FLOAT(400.0f, first->min[0]);
+    TEST_ASSERT_EQUAL_FLOAT(449.0f, first->max[0]);
+    TEST_ASSERT_EQUAL_UINT32(COLUMNAR_ROW_GROUP, first->nan_count[2]);
+
+    TEST_ASSERT_TRUE(columnar_group_matches(first, 0, 440.0f, 500.0f, 0, UINT64_MAX));
+    TEST_ASSERT_FALSE(columnar_group_matches(first, 0, 1000.0f, 5000.0f, 0, UINT64_MAX));
+    TEST_ASSERT_FALSE(columnar_group_matches(first, 2, -100.0f, 100.0f, 0, UINT64_MAX));
+    TEST_ASSERT_FALSE(columnar_group_matches(first, -1, 0, 0, first->timestamp_max + 1, UINT64_MAX));
+}
+
+void test_unfinished_file_is_rejected(void) {
+    add_reading(START_MS, 400.0f);
+    fflush(writer.file);
+
+    snprintf(path, sizeof(path), "%s/SCD40-20231114T000000Z.aqc", directory);
+    TEST_ASSERT_EQUAL_INT(READ_ERR, columnar_reader_open(path, &reader));
+    columnar_writer_close(&writer);
+}
+
+int main(void) {
+    if (mkdtemp(directory) == NULL) {
+        return 1;
+    }
+
+    UNITY_BEGIN();
+    RUN_TEST(test_row_groups_round_trip);
+    RUN_TEST(test_statistics_skip_row_groups);
+    RUN_TEST(test_unfinished_file_is_rejected);
+    int result = UNITY_END();
+
+    rmdir(directory);
+    return result;
+}
@@ -0,0 +1,152 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/config.c"
+
+static char path[] = "/tmp/config_tests_XXXXXX";
+static struct Config config;
+static int error_line;
+
+void setUp() {
+    int fd = mkstemp(path);
+
+    TEST_ASSERT_TRUE(fd >= 0);
+    close(fd);
+}
+
+void tearDown() {
+    unlink(path);
+    strcpy(path, "/tmp/config_tests_XXXXXX");
+}
+
+static int8_t load(const char* text) {
+    FILE* file = fopen(path, "w");
+
+    TEST_ASSERT_NOT_NULL(file);
+    fputs(text, file);
+    fclose(file);
+
+    return config_load(path, &config, &error_line);
+}
+
+void test_missing_file_keeps_the_defaults(void) {
+    TEST_ASSERT_EQUAL_INT8(NOERR, config_load("/nonexistent/publisher.conf", &config, &error_line));
+    TEST_ASSERT_EQUAL_INT(0, error_line);
+    TEST_ASSERT_EQUAL_STRING(TOPIC, config.topic);
+    TEST_ASSERT_EQUAL_INT(QOS, config.qos);
+    TEST_ASSERT_EQUAL_INT(2, config.num_devices);
+    TEST_ASSERT_EQUAL_HEX8(SCD40_ADDRESS, config.devices[0].address);
+    TEST_ASSERT_EQUAL_HEX8(SEN55_ADDRESS, config.devices[1].address);
+    TEST_ASSERT_EQUAL_UINT32(WAIT_TIME, config.devices[1].period);
+}
+
+void test_applies_settings_and_ignores_comments(void) {
+    TEST_ASSERT_EQUAL_INT8(NOERR, load("# a comment\n"
+                                       "\n"
+                                       "  topic = office/air   # trailing comment\n"
+                                       "qos = 2\n"
+                                       "retain_channels = yes\n"
+                                       "shm_name =\n"
+                                       "gateway = office-1\n"));
+    TEST_ASSERT_EQUAL_INT(0, error_line);
+    TEST_ASSERT_EQUAL_STRING("office/air", config.topic);
+    TEST_ASSERT_EQUAL_INT(2, config.qos);
+    TEST_ASSERT_TRUE(config.retain_channels);
+    TEST_ASSERT_EQUAL_STRING("", config.shm_name);
+    TEST_ASSERT_EQUAL_STRING("office-1", config.gateway);
+}
+
+void test_parses_devices(void) {
+    TEST_ASSERT_EQUAL_INT8(NOERR, load("wait_time = 10\n"
+                                       "device = SEN55\n"
+                                       "device = 0x62 3 2\n"));
+    TEST_ASSERT_EQUAL_INT(2, config.num_devices);
+
+    TEST_ASSERT_EQUAL_HEX8(SEN55_ADDRESS, config.devices[0].address);
+    TEST_ASSERT_EQUAL_UINT32(ADAPTER_NUM, config.devices[0].adapter_num);
+    //A device without a period samples every wait_time
+    TEST_ASSERT_EQUAL_UINT32(10, config.devices[0].period);
+
+    TEST_ASSERT_EQUAL_HEX8(SCD40_ADDRESS, config.devices[1].address);
+    TEST_ASSERT_EQUAL_UINT32(3, config.devices[1].adapter_num);
+    TEST_ASSERT_EQUAL_UINT32(2, config.devices[1].period);
+}
+
+void test_rejects_invalid_devices(void) {
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("device = SEN55\ndevice = 0x69\n"));
+    TEST_ASSERT_EQUAL_INT(2, error_line);
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("device = 0x10\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("device = 0x80\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("device = SCD40 one\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("device = SCD40 1 5 7\n"));
+}
+
+void test_rejects_invalid_settings(void) {
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("topic = a\ngateway = office/1\n"));
+    TEST_ASSERT_EQUAL_INT(2, error_line);
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("gateway = office+\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("shm_name = /sensors/extra\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("shm_name = sensors\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("qos = 3\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("alert_qos = -1\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("wait_time = 0\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("history_length = 0\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("retain_channels = maybe\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("channel_topic = sensors/{room}\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("unknown_key = 1\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("\n\ntopic\n"));
+    TEST_ASSERT_EQUAL_INT(3, error_line);
+}
+
+void test_parses_realtime_settings(void) {
+    TEST_ASSERT_EQUAL_INT8(NOERR, load("realtime = true\n"
+                                       "acquisition_cpu = 0\n"
+                                       "publish_cpu = none\n"
+                                       "acquisition_priority = 50\n"));
+    TEST_ASSERT_TRUE(config.realtime.enabled);
+    TEST_ASSERT_EQUAL_INT(0, config.realtime.acquisition_cpu);
+    TEST_ASSERT_EQUAL_INT(PROCESSING_CPU, config.realtime.processing_cpu);
+    TEST_ASSERT_EQUAL_INT(NO_CPU_PIN, config.realtime.publish_cpu);
+    TEST_ASSERT_EQUAL_INT(50, config.realtime.acquisition_priority);
+
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("acquisition_priority = 0\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("acquisition_priority = 100\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("processing_cpu = 100000\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("publish_cpu = -1\n"));
+}
+
+void test_invalid_file_leaves_the_configuration_untouched(void) {
+    TEST_ASSERT_EQUAL_INT8(NOERR, load("topic = kept\n"));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, load("topic = replaced\nqos = 5\n"));
+    TEST_ASSERT_EQUAL_STRING("kept", config.topic);
+}
+
+void test_broker_and_devices_changed(void) {
+    struct Config old_config;
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, load("device = SEN55\ndevice = SCD40\n"));
+    old_config = config;
+
+    //Moving or reordering the devices only changes their settings
+    TEST_ASSERT_EQUAL_INT8(NOERR, load("topic = other\ndevice = SCD40 2 1\ndevice = SEN55\n"));
+    TEST_ASSERT_FALSE(config_broker_changed(&old_config, &config));
+    TEST_ASSERT_FALSE(config_devices_changed(&old_config, &config));
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, load("client_id = other\ndevice = SEN55\n"));
+    TEST_ASSERT_TRUE(config_broker_changed(&old_config, &config));
+    TEST_ASSERT_TRUE(config_devices_changed(&old_config, &config));
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, load("address = tcp://other:1883\n"));
+    TEST_ASSERT_TRUE(config_broker_changed(&old_config, &config));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_missing_file_keeps_the_defaults);
+    RUN_TEST(test_applies_settings_and_ignores_comments);
+    RUN_TEST(test_parses_devices);
+    RUN_TEST(test_rejects_invalid_devices);
+    RUN_TEST(test_rejects_invalid_settings);
+    RUN_TEST(test_parses_realtime_settings);
+    RUN_TEST(test_invalid_file_leaves_the_configuration_untouched);
+    RUN_TEST(test_broker_and_devices_changed);
+    return UNITY_END();
+}
@@ -0,0 +1,95 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/delivery.c"
+
+static struct Delivery_Tracker tracker;
+
+void setUp() {
+    delivery_init(&tracker);
+}
+
+void tearDown() {}
+
+void test_records_complete_in_order(void) {
+    const int first[] = {1, 2, 3};
+    const int second[] = {4};
+
+    delivery_track(&tracker, first, 3, 100);
+    delivery_track(&tracker, second, 1, 200);
+
+    //The second record is confirmed first but waits on the first
+    delivery_confirm(&tracker, 4);
+    delivery_confirm(&tracker, 2);
+    TEST_ASSERT_EQUAL_UINT32(0, delivery_collect(&tracker));
+
+    delivery_confirm(&tracker, 3);
+    delivery_confirm(&tracker, 1);
+    TEST_ASSERT_EQUAL_UINT32(2, delivery_collect(&tracker));
+    TEST_ASSERT_EQUAL_UINT32(0, tracker.count);
+}
+
+void test_unknown_tokens_and_records_without_tokens(void) {
+    const int tokens[] = {7};
+
+    delivery_track(&tracker, NULL, 0, 100);
+    delivery_track(&tracker, tokens, 1, 100);
+
+    //An alert's token matches nothing
+    delivery_confirm(&tracker, 9);
+    TEST_ASSERT_EQUAL_UINT32(1, delivery_collect(&tracker));
+
+    delivery_confirm(&tracker, 7);
+    TEST_ASSERT_EQUAL_UINT32(1, delivery_collect(&tracker));
+}
+
+void test_oldest_record_expires(void) {
+    const int tokens[] = {1};
+
+    TEST_ASSERT_EQUAL_INT(-1, delivery_timeout(&tracker, 100, 1000));
+
+    delivery_track(&tracker, tokens, 1, 100);
+    delivery_track(&tracker, tokens, 1, 600);
+    TEST_ASSERT_EQUAL_INT(700, delivery_timeout(&tracker, 400, 1000));
+    TEST_ASSERT_EQUAL_INT(0, delivery_timeout(&tracker, 1500, 1000));
+
+    delivery_forget_oldest(&tracker);
+    TEST_ASSERT_EQUAL_INT(100, delivery_timeout(&tracker, 1500, 1000));
+}
+
+void test_reset_drops_records_and_confirmations(void) {
+    const int tokens[] = {1};
+
+    for (int i = 0; i < DELIVERY_MAX_RECORDS; ++i) {
+        delivery_track(&tracker, tokens, 1, 0);
+    }
+    TEST_ASSERT_TRUE(delivery_full(&tracker));
+
+    delivery_confirm(&tracker, 1);
+    delivery_reset(&tracker);
+    TEST_ASSERT_FALSE(delivery_full(&tracker));
+
+    delivery_track(&tracker, tokens, 1, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, delivery_collect(&tracker));
+}
+
+void test_full_ring_drops_confirmations(void) {
+    const int tokens[] = {DELIVERY_RING_SIZE};
+
+    delivery_track(&tracker, tokens, 1, 0);
+    for (int i = 0; i <= DELIVERY_RING_SIZE; ++i) {
+        delivery_confirm(&tracker, i);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(0, delivery_collect(&tracker));
+    delivery_confirm(&tracker, DELIVERY_RING_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(1, delivery_collect(&tracker));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_records_complete_in_order);
+    RUN_TEST(test_unknown_tokens_and_records_without_tokens);
+    RUN_TEST(test_oldest_record_expires);
+    RUN_TEST(test_reset_drops_records_and_confirmations);
+    RUN_TEST(test_full_ring_drops_confirmations);
+    return UNITY_END();
+}
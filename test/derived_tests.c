@@ -0,0 +1,78 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/derived.c"
+
+#define PERIOD_MS 5000ULL
+#define HOUR_MS 3600000ULL
+
+static struct Derived derived;
+static struct Derived_Values values;
+
+void setUp() {
+    derived_init(&derived, OUTDOOR_CO2);
+}
+
+void tearDown() {
+}
+
+static void add(uint64_t time_ms, float pm2_5, float co2) {
+    struct Derived_Inputs inputs = {pm2_5, pm2_5, 22.0f, 50.0f, co2};
+    derived_update(&derived, time_ms, &inputs, &values);
+}
+
+void test_aqi_breakpoints(void) {
+    TEST_ASSERT_EQUAL_FLOAT(0, aqi_pm2_5(0));
+    TEST_ASSERT_EQUAL_FLOAT(50, aqi_pm2_5(9.0f));
+    TEST_ASSERT_EQUAL_FLOAT(100, aqi_pm2_5(35.45f));
+    TEST_ASSERT_EQUAL_FLOAT(151, aqi_pm2_5(55.5f));
+    TEST_ASSERT_EQUAL_FLOAT(500, aqi_pm2_5(900.0f));
+    TEST_ASSERT_EQUAL_FLOAT(51, aqi_pm10(55.0f));
+    TEST_ASSERT_TRUE(isnan(aqi_pm2_5(NAN)));
+}
+
+void test_humidity_metrics(void) {
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 11.1f, dew_point(22.0f, 50.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 9.7f, absolute_humidity(22.0f, 50.0f));
+    TEST_ASSERT_TRUE(isnan(dew_point(22.0f, 0)));
+}
+
+void test_aqi_waits_for_enough_of_the_window(void) {
+    uint64_t time_ms = 0;
+
+    for (; time_ms < 12 * HOUR_MS; time_ms += PERIOD_MS) {
+        add(time_ms, 12.0f, NAN);
+    }
+    TEST_ASSERT_TRUE(isnan(values.values[DERIVED_AQI]));
+
+    for (; time_ms < 24 * HOUR_MS; time_ms += PERIOD_MS) {
+        add(time_ms, 12.0f, NAN);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 12.0f, values.values[DERIVED_PM2_5_24H]);
+    TEST_ASSERT_EQUAL_FLOAT(56, values.values[DERIVED_AQI]);
+
+    //A day later the old readings have rolled out of the window
+    for (; time_ms < 48 * HOUR_MS; time_ms += PERIOD_MS) {
+        add(time_ms, 40.0f, NAN);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 40.0f, values.values[DERIVED_PM2_5_24H]);
+}
+
+void test_air_changes_from_co2_decay(void) {
+    //The excess over outdoors halves over the 15 minute window
+    add(0, NAN, OUTDOOR_CO2 + 800.0f);
+    add(DERIVED_TREND_MS, NAN, OUTDOOR_CO2 + 400.0f);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, -1600.0f, values.values[DERIVED_CO2_RATE]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, logf(2) * 4, values.values[DERIVED_AIR_CHANGES]);
+
+    add(DERIVED_TREND_MS * 2, NAN, OUTDOOR_CO2 + 600.0f);
+    TEST_ASSERT_TRUE(isnan(values.values[DERIVED_AIR_CHANGES]));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_aqi_breakpoints);
+    RUN_TEST(test_humidity_metrics);
+    RUN_TEST(test_aqi_waits_for_enough_of_the_window);
+    RUN_TEST(test_air_changes_from_co2_decay);
+    return UNITY_END();
+}
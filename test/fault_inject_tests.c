@@ -0,0 +1,174 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/fault_inject.c"
+
+#define SEED 42
+
+static struct Fault_Injector injector;
+
+void setUp() {}
+
+void tearDown() {}
+
+/**
+ * @brief Sets up the injector with a single rule
+ *
+ * @param text the rule's text
+ */
+static void inject(const char* text) {
+    struct Fault_Rule rule;
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, fault_parse(text, &rule));
+    fault_inject_init(&injector, &rule, 1, SEED);
+}
+
+void test_parses_faults(void) {
+    struct Fault_Rule rule;
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, fault_parse("SEN55 crc 0.25", &rule));
+    TEST_ASSERT_EQUAL_INT(FAULT_DEVICE, rule.site);
+    TEST_ASSERT_EQUAL_HEX8(SEN55_ADDRESS, rule.device_addr);
+    TEST_ASSERT_EQUAL_INT(FAULT_CRC, rule.kind);
+    TEST_ASSERT_EQUAL_INT(FAULT_PROBABILITY, rule.trigger);
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, (float)rule.probability);
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, fault_parse("bus nack every 10", &rule));
+    TEST_ASSERT_EQUAL_HEX8(FAULT_ANY_DEVICE, rule.device_addr);
+    TEST_ASSERT_EQUAL_INT(FAULT_EVERY, rule.trigger);
+    TEST_ASSERT_EQUAL_UINT32(10, rule.count);
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, fault_parse("broker latency at 3 2000", &rule));
+    TEST_ASSERT_EQUAL_INT(FAULT_BROKER, rule.site);
+    TEST_ASSERT_EQUAL_INT(FAULT_AT, rule.trigger);
+    TEST_ASSERT_EQUAL_UINT32(2000, rule.amount);
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, fault_parse("0x62 short 1", &rule));
+    TEST_ASSERT_EQUAL_HEX8(SCD40_ADDRESS, rule.device_addr);
+    TEST_ASSERT_EQUAL_UINT32(FAULT_SHORT_KEPT, rule.amount);
+}
+
+void test_rejects_invalid_faults(void) {
+    struct Fault_Rule rule;
+
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, fault_parse("broker crc 0.5", &rule));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, fault_parse("SEN55 disconnect 0.5", &rule));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, fault_parse("SEN55 latency 0.5", &rule));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, fault_parse("SEN55 crc 1.5", &rule));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, fault_parse("SEN55 crc every 0", &rule));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, fault_parse("SEN55 nack 0.5 3", &rule));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, fault_parse("0x10 nack 0.5", &rule));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, fault_parse("SEN55 flood 0.5", &rule));
+    TEST_ASSERT_EQUAL_INT8(CONFIG_ERR, fault_parse("SEN55", &rule));
+}
+
+void test_scripted_faults_fire_on_matching_transfers(void) {
+    uint8_t data[3] = {0};
+
+    inject("SEN55 nack every 3");
+    for (int transfer = 1; transfer <= 6; ++transfer) {
+        //The other device's transfers and the ones that already failed aren't counted
+        TEST_ASSERT_EQUAL_INT8(NOERR, fault_inject_bus(&injector, SCD40_ADDRESS, BUS_READ, data, 3, NOERR));
+        TEST_ASSERT_EQUAL_INT8(READ_ERR, fault_inject_bus(&injector, SEN55_ADDRESS, BUS_READ, data, 3, READ_ERR));
+        TEST_ASSERT_EQUAL_INT8(transfer % 3 == 0 ? NACK_ERR : NOERR, fault_inject_bus(&injector,
+                               SEN55_ADDRESS, transfer % 2 ? BUS_WRITE : BUS_READ, data, 2, NOERR));
+    }
+    TEST_ASSERT_EQUAL_UINT64(2, fault_injected(&injector, 0));
+
+    //Each device's transfers are counted on their own
+    inject("bus error at 2");
+    TEST_ASSERT_EQUAL_INT8(NOERR, fault_inject_bus(&injector, SCD40_ADDRESS, BUS_READ, data, 3, NOERR));
+    TEST_ASSERT_EQUAL_INT8(NOERR, fault_inject_bus(&injector, SEN55_ADDRESS, BUS_WRITE, data, 2, NOERR));
+    TEST_ASSERT_EQUAL_INT8(WRITE_ERR, fault_inject_bus(&injector, SEN55_ADDRESS, BUS_WRITE, data, 2, NOERR));
+    TEST_ASSERT_EQUAL_INT8(READ_ERR, fault_inject_bus(&injector, SCD40_ADDRESS, BUS_READ, data, 3, NOERR));
+    TEST_ASSERT_EQUAL_INT8(NOERR, fault_inject_bus(&injector, SCD40_ADDRESS, BUS_READ, data, 3, NOERR));
+}
+
+void test_corrupts_the_bytes_read(void) {
+    const uint8_t response[] = {0x01, 0x02, 0x17, 0x03, 0x04, 0x68};
+    uint8_t data[sizeof(response)];
+    int flipped = 0;
+
+    inject("SEN55 crc 1");
+    memcpy(data, response, sizeof(data));
+    TEST_ASSERT_EQUAL_INT8(NOERR, fault_inject_bus(&injector, SEN55_ADDRESS, BUS_READ, data, sizeof(data), NOERR));
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        flipped += __builtin_popcount(data[i] ^ response[i]);
+    }
+    TEST_ASSERT_EQUAL_INT(1, flipped);
+
+    //A failed read has nothing to corrupt
+    TEST_ASSERT_EQUAL_INT8(NACK_ERR, fault_inject_bus(&injector, SEN55_ADDRESS, BUS_READ, data, sizeof(data), NACK_ERR));
+    TEST_ASSERT_EQUAL_UINT64(1, fault_injected(&injector, 0));
+
+    inject("SEN55 short 1 2");
+    memcpy(data, response, sizeof(data));
+    fault_inject_bus(&injector, SEN55_ADDRESS, BUS_READ, data, sizeof(data), NOERR);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(response, data, 2);
+    for (size_t i = 2; i < sizeof(data); ++i) {
+        TEST_ASSERT_EQUAL_HEX8(0xFF, data[i]);
+    }
+}
+
+void test_probability_is_reproducible(void) {
+    uint8_t data[3] = {0};
+    uint64_t first;
+
+    inject("SCD40 error 0.1");
+    for (int i = 0; i < 10000; ++i) {
+        fault_inject_bus(&injector, SCD40_ADDRESS, BUS_READ, data, sizeof(data), NOERR);
+    }
+    first = fault_injected(&injector, 0);
+    TEST_ASSERT_TRUE(first > 800 && first < 1200);
+
+    inject("SCD40 error 0.1");
+    for (int i = 0; i < 10000; ++i) {
+        fault_inject_bus(&injector, SCD40_ADDRESS, BUS_READ, data, sizeof(data), NOERR);
+    }
+    TEST_ASSERT_EQUAL_UINT64(first, fault_injected(&injector, 0));
+}
+
+void test_draws_dont_depend_on_other_devices(void) {
+    uint8_t data[3] = {0};
+    int8_t alone[64];
+
+    inject("bus error 0.5");
+    for (int i = 0; i < 64; ++i) {
+        alone[i] = fault_inject_bus(&injector, SEN55_ADDRESS, BUS_READ, data, sizeof(data), NOERR);
+    }
+
+    //Another worker's transfers interleaved at random leave the device's faults as they were
+    inject("bus error 0.5");
+    for (int i = 0; i < 64; ++i) {
+        for (int j = 0; j < i % 3; ++j) {
+            fault_inject_bus(&injector, SCD40_ADDRESS, BUS_READ, data, sizeof(data), NOERR);
+        }
+        TEST_ASSERT_EQUAL_INT8(alone[i],
+                               fault_inject_bus(&injector, SEN55_ADDRESS, BUS_READ, data, sizeof(data), NOERR));
+    }
+}
+
+void test_broker_faults(void) {
+    bool disconnect;
+
+    inject("broker disconnect at 2");
+    TEST_ASSERT_EQUAL_INT8(NOERR, fault_inject_broker(&injector, &disconnect));
+    TEST_ASSERT_FALSE(disconnect);
+    TEST_ASSERT_EQUAL_INT8(WRITE_ERR, fault_inject_broker(&injector, &disconnect));
+    TEST_ASSERT_TRUE(disconnect);
+
+    //Device faults never touch the broker
+    inject("bus error 1");
+    TEST_ASSERT_EQUAL_INT8(NOERR, fault_inject_broker(&injector, &disconnect));
+    TEST_ASSERT_EQUAL_UINT64(0, fault_injected(&injector, 0));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parses_faults);
+    RUN_TEST(test_rejects_invalid_faults);
+    RUN_TEST(test_scripted_faults_fire_on_matching_transfers);
+    RUN_TEST(test_corrupts_the_bytes_read);
+    RUN_TEST(test_probability_is_reproducible);
+    RUN_TEST(test_draws_dont_depend_on_other_devices);
+    RUN_TEST(test_broker_faults);
+    return UNITY_END();
+}
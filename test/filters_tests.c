@@ -0,0 +1,90 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/sensor_data.c"
+#include "../src/filters.c"
+
+#define PERIOD_MS 1000
+
+static struct Filter_Chain chain;
+static uint64_t time_ms;
+
+void setUp() {
+    time_ms = 0;
+}
+
+void tearDown() {
+}
+
+static void use(const char* text) {
+    struct Filter_Config config;
+
+    TEST_ASSERT_EQUAL_INT(NOERR, filter_parse(text, &config));
+    filter_chain_init(&chain, &config, 1);
+}
+
+static float add(float pm2_5) {
+    struct Sensor_Data sample = {.device_addr = SEN55_ADDRESS, .num_data = SEN55_DATAPOINTS};
+
+    time_ms += PERIOD_MS;
+    sample.monotonic.tv_sec = time_ms / 1000;
+    sample.monotonic.tv_nsec = (time_ms % 1000) * 1000000;
+    sample.data[1] = pm2_5;
+    sample.data[0] = 99.0f;
+
+    filter_chain_apply(&chain, &sample);
+    TEST_ASSERT_EQUAL_FLOAT(99.0f, sample.data[0]);
+    return sample.data[1];
+}
+
+void test_rejects_invalid_filters(void) {
+    struct Filter_Config config;
+
+    TEST_ASSERT_EQUAL_INT(CONFIG_ERR, filter_parse("SEN55.pm2_5 median 4", &config));
+    TEST_ASSERT_EQUAL_INT(CONFIG_ERR, filter_parse("SEN55.pm2_5 median 11", &config));
+    TEST_ASSERT_EQUAL_INT(CONFIG_ERR, filter_parse("SEN55.pm2_5 ewma 1.5", &config));
+    TEST_ASSERT_EQUAL_INT(CONFIG_ERR, filter_parse("SEN55.co2 rate 10", &config));
+    TEST_ASSERT_EQUAL_INT(CONFIG_ERR, filter_parse("SEN55.pm2_5 rate 10 extra", &config));
+    TEST_ASSERT_EQUAL_INT(NOERR, filter_parse("SCD40.co2 rate 10", &config));
+    TEST_ASSERT_EQUAL_UINT8(SCD40_ADDRESS, config.device_addr);
+    TEST_ASSERT_EQUAL_INT(FILTER_RATE, config.type);
+}
+
+void test_median_drops_a_single_spike(void) {
+    use("SEN55.pm2_5 median 3");
+
+    add(10.0f);
+    add(11.0f);
+    TEST_ASSERT_EQUAL_FLOAT(11.0f, add(500.0f));
+    TEST_ASSERT_EQUAL_FLOAT(12.0f, add(12.0f));
+    TEST_ASSERT_EQUAL_FLOAT(12.0f, add(NAN));
+    TEST_ASSERT_EQUAL_UINT32(1, chain.filters[0].rejected);
+}
+
+void test_ewma_smooths_and_holds_over_nan(void) {
+    use("SEN55.pm2_5 ewma 0.5");
+
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, add(10.0f));
+    TEST_ASSERT_EQUAL_FLOAT(15.0f, add(20.0f));
+    TEST_ASSERT_EQUAL_FLOAT(15.0f, add(NAN));
+    TEST_ASSERT_EQUAL_UINT32(1, chain.filters[0].rejected);
+}
+
+void test_rate_limit_gives_in_to_a_real_step(void) {
+    use("SEN55.pm2_5 rate 5");
+
+    add(10.0f);
+    TEST_ASSERT_EQUAL_FLOAT(14.0f, add(14.0f));
+    for (int i = 0; i < FILTER_MAX_HELD; ++i) {
+        TEST_ASSERT_EQUAL_FLOAT(14.0f, add(100.0f));
+    }
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, add(100.0f));
+    TEST_ASSERT_EQUAL_UINT32(FILTER_MAX_HELD, chain.filters[0].rejected);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_rejects_invalid_filters);
+    RUN_TEST(test_median_drops_a_single_spike);
+    RUN_TEST(test_ewma_smooths_and_holds_over_nan);
+    RUN_TEST(test_rate_limit_gives_in_to_a_real_step);
+    return UNITY_END();
+}
@@ -0,0 +1,123 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/sensor_data.c"
+#include "../src/scan.c"
+#include "../src/history.c"
+#include "../src/query_server.c"
+
+#define CAPACITY 4
+
+static const uint8_t ADDRS[1] = {SCD40_ADDRESS};
+static struct History history;
+
+void setUp() {
+    history_init(&history, ADDRS, 1, CAPACITY);
+}
+
+void tearDown() {
+    history_free(&history);
+}
+
+static void add_reading(uint64_t ms, float co2) {
+    struct Sensor_Data sample = {.device_addr = SCD40_ADDRESS, .num_data = SCD40_DATAPOINTS};
+    sample.realtime.tv_sec = ms / 1000;
+    sample.realtime.tv_nsec = (ms % 1000) * 1000000;
+    sample.data[0] = co2;
+    history_add(&history, &sample);
+}
+
+void test_ring_keeps_latest_readings_in_order(void) {
+    struct History_Point points[CAPACITY];
+    const struct History_Series* series = history_find(&history, SCD40_ADDRESS);
+
+    for (int i = 0; i < 6; ++i) {
+        add_reading(1000 * (i + 1), 400.0f + i);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(CAPACITY, history_range(series, 0, 0, UINT64_MAX, points, CAPACITY));
+    TEST_ASSERT_EQUAL_UINT64(3000, points[0].timestamp_ms);
+    TEST_ASSERT_EQUAL_FLOAT(405.0f, points[3].value);
+
+    TEST_ASSERT_EQUAL_UINT32(2, history_range(series, 0, 3500, 5000, points, CAPACITY));
+    TEST_ASSERT_EQUAL_UINT64(4000, points[0].timestamp_ms);
+}
+
+void test_downsample_summarizes_each_step(void) {
+    struct History_Bucket buckets[CAPACITY];
+    const struct History_Series* series = history_find(&history, SCD40_ADDRESS);
+
+    add_reading(1000, 400.0f);
+    add_reading(2000, 410.0f);
+    add_reading(3000, NAN);
+    add_reading(5000, 430.0f);
+
+    TEST_ASSERT_EQUAL_UINT32(2, history_downsample(series, 0, 1000, 6000, 3000, buckets, CAPACITY));
+    TEST_ASSERT_EQUAL_UINT32(2, buckets[0].count);
+    TEST_ASSERT_EQUAL_FLOAT(400.0f, buckets[0].min);
+    TEST_ASSERT_EQUAL_FLOAT(410.0f, buckets[0].max);
+    TEST_ASSERT_EQUAL_FLOAT(405.0f, buckets[0].mean);
+    TEST_ASSERT_EQUAL_UINT64(4000, buckets[1].start_ms);
+}
+
+void test_aggregate_scans_across_ring_wrap(void) {
+    struct Scan_Result result;
+    const struct History_Series* series = history_find(&history, SCD40_ADDRESS);
+
+    for (uint64_t i = 1; i <= CAPACITY + 2; ++i) {
+        add_reading(i * 1000, i == 5 ? NAN : 400.0f + (float)i);
+    }
+
+    TEST_ASSERT_TRUE(history_aggregate(series, 0, 0, UINT64_MAX, 404.0f, &result));
+    TEST_ASSERT_EQUAL_UINT32(3, result.count);
+    TEST_ASSERT_EQUAL_UINT32(1, result.nan_count);
+    TEST_ASSERT_EQUAL_UINT32(1, result.above);
+    TEST_ASSERT_EQUAL_FLOAT(403.0f, result.min);
+    TEST_ASSERT_EQUAL_FLOAT(406.0f, result.max);
+    TEST_ASSERT_EQUAL_FLOAT(1213.0f, (float)result.sum);
+}
+
+void test_query_latest_and_unknown_device(void) {
+    static uint8_t response[QUERY_RESPONSE_SIZE];
+    struct Query_Request request = {.type = QUERY_LATEST, .device_addr = SCD40_ADDRESS};
+    struct Query_Response* header = (struct Query_Response*)response;
+    struct Query_Point point;
+
+    add_reading(1000, 400.0f);
+    add_reading(2000, 410.0f);
+
+    TEST_ASSERT_EQUAL_size_t(sizeof(*header) + sizeof(point), query_execute(&history, &request, response));
+    TEST_ASSERT_EQUAL_INT(NOERR, header->status);
+    memcpy(&point, response + sizeof(*header), sizeof(point));
+    TEST_ASSERT_EQUAL_FLOAT(410.0f, point.value);
+
+    request.device_addr = SEN55_ADDRESS;
+    TEST_ASSERT_EQUAL_size_t(sizeof(*header), query_execute(&history, &request, response));
+    TEST_ASSERT_EQUAL_INT(ADDR_ERR, header->status);
+}
+
+void test_changing_devices_keeps_the_remaining_series(void) {
+    const uint8_t both[2] = {SEN55_ADDRESS, SCD40_ADDRESS};
+    struct History_Point point;
+
+    add_reading(1000, 400.0f);
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, history_set_devices(&history, both, 2));
+    TEST_ASSERT_EQUAL_INT(2, history.num_series);
+    TEST_ASSERT_TRUE(history_latest(history_find(&history, SCD40_ADDRESS), 0, &point));
+    TEST_ASSERT_EQUAL_FLOAT(400.0f, point.value);
+    TEST_ASSERT_FALSE(history_latest(history_find(&history, SEN55_ADDRESS), 0, &point));
+    TEST_ASSERT_EQUAL_UINT32(CAPACITY, history_find(&history, SEN55_ADDRESS)->capacity);
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, history_set_devices(&history, both, 1));
+    TEST_ASSERT_NULL(history_find(&history, SCD40_ADDRESS));
+    TEST_ASSERT_NOT_NULL(history_find(&history, SEN55_ADDRESS));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_keeps_latest_readings_in_order);
+    RUN_TEST(test_downsample_summarizes_each_step);
+    RUN_TEST(test_aggregate_scans_across_ring_wrap);
+    RUN_TEST(test_query_latest_and_unknown_device);
+    RUN_TEST(test_changing_devices_keeps_the_remaining_series);
+    return UNITY_END();
+}
@@ -0,0 +1,84 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/sensor_data.c"
+#include "../src/record_join.c"
+
+#define BUCKET_MS 5000
+#define LATENESS_MS 1000
+
+static const uint8_t ADDRS[2] = {SEN55_ADDRESS, SCD40_ADDRESS};
+static struct Record_Join join;
+static struct Joined_Record records[JOIN_MAX_PENDING];
+
+void setUp() {
+    record_join_init(&join, ADDRS, 2, BUCKET_MS, LATENESS_MS);
+}
+
+void tearDown() {}
+
+static struct Sensor_Data make_sample(uint8_t addr, uint32_t sequence, uint64_t ms) {
+    struct Sensor_Data sample = {.device_addr = addr, .sequence = sequence, .num_data = 1};
+    sample.monotonic.tv_sec = ms / 1000;
+    sample.monotonic.tv_nsec = (ms % 1000) * 1000000;
+    sample.data[0] = (float)sequence;
+    return sample;
+}
+
+void test_emits_once_when_every_device_reported(void) {
+    struct Sensor_Data sen55 = make_sample(SEN55_ADDRESS, 0, 100000);
+    struct Sensor_Data scd40 = make_sample(SCD40_ADDRESS, 0, 100200);
+
+    TEST_ASSERT_EQUAL_INT(0, record_join_add(&join, &sen55, records));
+    TEST_ASSERT_EQUAL_INT(1, record_join_add(&join, &scd40, records));
+    TEST_ASSERT_EQUAL_INT(FIELD_FRESH, records[0].states[0]);
+    TEST_ASSERT_EQUAL_INT(FIELD_FRESH, records[0].states[1]);
+    TEST_ASSERT_EQUAL_INT(0, record_join_poll(&join, 200000, records));
+}
+
+void test_marks_missing_after_lateness_window(void) {
+    struct Sensor_Data sen55 = make_sample(SEN55_ADDRESS, 0, 100000);
+
+    TEST_ASSERT_EQUAL_INT(0, record_join_add(&join, &sen55, records));
+    TEST_ASSERT_EQUAL_INT(0, record_join_poll(&join, 103000, records));
+    TEST_ASSERT_EQUAL_INT(1, record_join_poll(&join, 103500, records));
+    TEST_ASSERT_EQUAL_INT(FIELD_FRESH, records[0].states[0]);
+    TEST_ASSERT_EQUAL_INT(FIELD_MISSING, records[0].states[1]);
+}
+
+void test_marks_stale_and_drops_late_samples(void) {
+    struct Sensor_Data sen55 = make_sample(SEN55_ADDRESS, 0, 100000);
+    struct Sensor_Data scd40 = make_sample(SCD40_ADDRESS, 0, 100100);
+    struct Sensor_Data next_sen55 = make_sample(SEN55_ADDRESS, 1, 105000);
+    struct Sensor_Data late_scd40 = make_sample(SCD40_ADDRESS, 1, 105100);
+
+    record_join_add(&join, &sen55, records);
+    TEST_ASSERT_EQUAL_INT(1, record_join_add(&join, &scd40, records));
+    TEST_ASSERT_EQUAL_INT(0, record_join_add(&join, &next_sen55, records));
+    TEST_ASSERT_EQUAL_INT(1, record_join_poll(&join, 108500, records));
+    TEST_ASSERT_EQUAL_INT(FIELD_STALE, records[0].states[1]);
+    TEST_ASSERT_EQUAL_UINT32(0, records[0].samples[1].sequence);
+
+    TEST_ASSERT_EQUAL_INT(0, record_join_add(&join, &late_scd40, records));
+    TEST_ASSERT_EQUAL_UINT32(1, join.late_samples);
+}
+
+void test_device_moving_past_bucket_closes_it(void) {
+    struct Sensor_Data sen55 = make_sample(SEN55_ADDRESS, 0, 100000);
+    struct Sensor_Data next_sen55 = make_sample(SEN55_ADDRESS, 1, 105000);
+    struct Sensor_Data scd40 = make_sample(SCD40_ADDRESS, 0, 105200);
+
+    record_join_add(&join, &sen55, records);
+    record_join_add(&join, &next_sen55, records);
+    TEST_ASSERT_EQUAL_INT(2, record_join_add(&join, &scd40, records));
+    TEST_ASSERT_EQUAL_INT(FIELD_MISSING, records[0].states[1]);
+    TEST_ASSERT_EQUAL_INT(FIELD_FRESH, records[1].states[0]);
+    TEST_ASSERT_EQUAL_INT(FIELD_FRESH, records[1].states[1]);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_emits_once_when_every_device_reported);
+    RUN_TEST(test_marks_missing_after_lateness_window);
+    RUN_TEST(test_marks_stale_and_drops_late_samples);
+    RUN_TEST(test_device_moving_past_bucket_closes_it);
+    return UNITY_END();
+}
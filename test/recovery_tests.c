@@ -0,0 +1,79 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/recovery.c"
+
+static struct Recovery recovery;
+
+void setUp() {
+    recovery_init(&recovery);
+}
+
+void tearDown() {}
+
+void test_escalates_after_each_steps_attempts(void) {
+    for (int step = RECOVERY_RETRY; step < RECOVERY_STEPS; ++step) {
+        for (int i = 0; i < RECOVERY_STEP_ATTEMPTS; ++i) {
+            TEST_ASSERT_EQUAL_INT(step, recovery_fail(&recovery, 0));
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT(RECOVERY_RETRY, recovery_fail(&recovery, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, recovery.stats.faults);
+    TEST_ASSERT_EQUAL_UINT32(RECOVERY_STEPS * RECOVERY_STEP_ATTEMPTS + 1, recovery.stats.attempts);
+}
+
+void test_backoff_doubles_up_to_the_cap(void) {
+    recovery_fail(&recovery, 1000);
+    TEST_ASSERT_EQUAL_INT(RECOVERY_MIN_BACKOFF_MS, recovery_timeout(&recovery, 1000));
+
+    recovery_fail(&recovery, 1000);
+    TEST_ASSERT_EQUAL_INT(2 * RECOVERY_MIN_BACKOFF_MS, recovery_timeout(&recovery, 1000));
+
+    for (int i = 0; i < 40; ++i) {
+        recovery_fail(&recovery, 1000);
+    }
+    TEST_ASSERT_EQUAL_INT(RECOVERY_MAX_BACKOFF_MS, recovery_timeout(&recovery, 1000));
+
+    recovery_step_taken(&recovery);
+    TEST_ASSERT_EQUAL_INT(-1, recovery_timeout(&recovery, 1000));
+}
+
+void test_success_records_recovery_time_and_resets(void) {
+    TEST_ASSERT_FALSE(recovery_succeed(&recovery, 500));
+
+    recovery_fail(&recovery, 1000);
+    recovery_fail(&recovery, 1100);
+    recovery_step_taken(&recovery);
+    TEST_ASSERT_TRUE(recovery_succeed(&recovery, 4000));
+    TEST_ASSERT_EQUAL_UINT32(3000, recovery.stats.last_recovery_ms);
+    TEST_ASSERT_EQUAL_UINT32(1, recovery.stats.recoveries);
+
+    //A new fault starts over from retrying with the shortest backoff
+    TEST_ASSERT_EQUAL_INT(RECOVERY_RETRY, recovery_fail(&recovery, 5000));
+    TEST_ASSERT_EQUAL_INT(RECOVERY_MIN_BACKOFF_MS, recovery_timeout(&recovery, 5000));
+    TEST_ASSERT_EQUAL_UINT32(2, recovery.stats.faults);
+}
+
+void test_fail_from_skips_steps_without_longer_backoff(void) {
+    TEST_ASSERT_EQUAL_INT(RECOVERY_ADAPTER, recovery_fail_from(&recovery, RECOVERY_ADAPTER, 1000));
+    TEST_ASSERT_EQUAL_INT(RECOVERY_MIN_BACKOFF_MS, recovery_timeout(&recovery, 1000));
+
+    //The rest of the step's attempts are taken before starting over
+    for (int i = 1; i < RECOVERY_STEP_ATTEMPTS; ++i) {
+        TEST_ASSERT_EQUAL_INT(RECOVERY_ADAPTER, recovery_fail(&recovery, 1000));
+    }
+    TEST_ASSERT_EQUAL_INT(RECOVERY_RETRY, recovery_fail(&recovery, 1000));
+
+    //An earlier step than the current one doesn't step back
+    TEST_ASSERT_EQUAL_INT(RECOVERY_RESET, recovery_fail_from(&recovery, RECOVERY_RESET, 1000));
+    TEST_ASSERT_EQUAL_INT(RECOVERY_RESET, recovery_fail_from(&recovery, RECOVERY_RETRY, 1000));
+    TEST_ASSERT_EQUAL_UINT32(1, recovery.stats.faults);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_escalates_after_each_steps_attempts);
+    RUN_TEST(test_backoff_doubles_up_to_the_cap);
+    RUN_TEST(test_success_records_recovery_time_and_resets);
+    RUN_TEST(test_fail_from_skips_steps_without_longer_backoff);
+    return UNITY_END();
+}
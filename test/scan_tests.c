@@ -0,0 +1,76 @@
+#include "../unity/Unity/src/unity.h"
+#include <stdlib.h>
+#include "../src/scan.c"
+
+#define LENGTH 4099
+
+static float values[LENGTH];
+
+void setUp() {
+    srand(1);
+    for (int i = 0; i < LENGTH; ++i) {
+        values[i] = rand() % 7 == 0 ? NAN : (float)(rand() % 2000) / 10.0f;
+    }
+}
+
+void tearDown() {
+}
+
+void test_empty_and_all_nan_columns(void) {
+    struct Scan_Result result;
+    const float nans[5] = {NAN, NAN, NAN, NAN, NAN};
+
+    scan_init(&result);
+    scan_column(values, 0, 0, &result);
+    TEST_ASSERT_EQUAL_UINT32(0, result.count);
+    TEST_ASSERT_TRUE(isnan(scan_mean(&result)));
+
+    scan_column(nans, 5, 0, &result);
+    TEST_ASSERT_EQUAL_UINT32(0, result.count);
+    TEST_ASSERT_EQUAL_UINT32(5, result.nan_count);
+    TEST_ASSERT_TRUE(isnan(result.min));
+    TEST_ASSERT_TRUE(isnan(result.max));
+}
+
+void test_masks_nan_in_every_lane(void) {
+    struct Scan_Result result;
+    const float column[9] = {NAN, 3.0f, -2.0f, NAN, 50.0f, NAN, 7.5f, NAN, 1.0f};
+
+    scan_init(&result);
+    scan_column(column, 9, 5.0f, &result);
+
+    TEST_ASSERT_EQUAL_UINT32(5, result.count);
+    TEST_ASSERT_EQUAL_UINT32(4, result.nan_count);
+    TEST_ASSERT_EQUAL_UINT32(2, result.above);
+    TEST_ASSERT_EQUAL_FLOAT(-2.0f, result.min);
+    TEST_ASSERT_EQUAL_FLOAT(50.0f, result.max);
+    TEST_ASSERT_EQUAL_FLOAT(59.5f, (float)result.sum);
+}
+
+void test_kernel_matches_scalar(void) {
+    struct Scan_Result vector;
+    struct Scan_Result scalar;
+
+    //Odd lengths and offsets cover the unaligned loads and the scalar tail
+    for (uint32_t offset = 0; offset < 4; ++offset) {
+        scan_init(&vector);
+        scan_init(&scalar);
+        scan_column(values + offset, LENGTH - offset, 100.0f, &vector);
+        scan_column_scalar(values + offset, LENGTH - offset, 100.0f, &scalar);
+
+        TEST_ASSERT_EQUAL_UINT32(scalar.count, vector.count);
+        TEST_ASSERT_EQUAL_UINT32(scalar.nan_count, vector.nan_count);
+        TEST_ASSERT_EQUAL_UINT32(scalar.above, vector.above);
+        TEST_ASSERT_EQUAL_FLOAT(scalar.min, vector.min);
+        TEST_ASSERT_EQUAL_FLOAT(scalar.max, vector.max);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, scan_mean(&scalar), scan_mean(&vector));
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_and_all_nan_columns);
+    RUN_TEST(test_masks_nan_in_every_lane);
+    RUN_TEST(test_kernel_matches_scalar);
+    return UNITY_END();
+}
@@ -0,0 +1,257 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/sensirion.c"
+#include "../src/clock_source.c"
+
+#define TEST_ADDRESS 0x10
+
+static uint8_t written[SENSIRION_WORD_SIZE];
+static int writes;
+static int reads;
+static int corrupt_reads;
+static int nacked_reads;
+static int stuck_reads;
+static bool varied_corruption;
+static int8_t write_result;
+
+int8_t i2c_bus_write(uint8_t* data, uint16_t count, uint8_t device_addr, int* fd) {
+    (void)fd;
+    TEST_ASSERT_EQUAL_HEX8(TEST_ADDRESS, device_addr);
+    TEST_ASSERT_EQUAL_UINT16(SENSIRION_WORD_SIZE, count);
+    memcpy(written, data, SENSIRION_WORD_SIZE);
+    ++writes;
+    return write_result;
+}
+
+//Answers with the words 0xBEEF, 0x0102, ... after NACKing the first nacked_reads reads.
+//The first stuck_reads responses are all ones, and the first corrupt_reads have the same
+//bits flipped each time or, with varied_corruption, different ones
+int8_t i2c_bus_read(uint8_t* data, uint16_t count, uint8_t device_addr, int* fd) {
+    (void)fd;
+    (void)device_addr;
+    if (nacked_reads > 0) {
+        --nacked_reads;
+        ++reads;
+        return NACK_ERR;
+    }
+
+    for (int i = 0; i < count / 3; ++i) {
+        data[i * 3] = i == 0 ? 0xBE : (uint8_t)(2 * i - 1);
+        data[i * 3 + 1] = i == 0 ? 0xEF : (uint8_t)(2 * i);
+        data[i * 3 + 2] = sensirion_crc(&data[i * 3]);
+    }
+
+    if (reads < stuck_reads) {
+        memset(data, 0xFF, count);
+    }
+
+    if (reads++ < corrupt_reads) {
+        data[2] ^= varied_corruption ? (uint8_t)reads : 0xFF;
+    }
+    return NOERR;
+}
+
+bool i2c_bus_replaying(void) {
+    return false;
+}
+
+void setUp() {
+    writes = 0;
+    reads = 0;
+    corrupt_reads = 0;
+    nacked_reads = 0;
+    stuck_reads = 0;
+    varied_corruption = false;
+    write_result = NOERR;
+    //The waits advance a virtual clock, so the calibration's timing is exact
+    clock_source_use_virtual(0);
+}
+
+void tearDown() {}
+
+void test_crc_matches_datasheet(void) {
+    const uint8_t word[] = {0xBE, 0xEF};
+
+    TEST_ASSERT_EQUAL_HEX8(0x92, sensirion_crc(word));
+}
+
+void test_writes_command_big_endian(void) {
+    const struct Sensirion_Command command = {0x03C4, 0, 0, 1, 0};
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, sensirion_execute(TEST_ADDRESS, &command, NULL, NULL, NULL));
+    TEST_ASSERT_EQUAL_HEX8(0x03, written[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xC4, written[1]);
+    TEST_ASSERT_EQUAL_INT(0, reads);
+}
+
+void test_strips_crc_from_response(void) {
+    const struct Sensirion_Command command = {0x0202, 0, 2, 1, 0};
+    uint8_t response[4];
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, sensirion_execute(TEST_ADDRESS, &command, NULL, response, NULL));
+    TEST_ASSERT_EQUAL_HEX8(0xBE, response[0]);
+    TEST_ASSERT_EQUAL_HEX8(0xEF, response[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, response[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, response[3]);
+}
+
+void test_retries_until_attempts_run_out(void) {
+    const struct Sensirion_Command command = {0x03C4, 0, 1, 3, 0};
+    uint8_t response[2];
+
+    corrupt_reads = 2;
+    TEST_ASSERT_EQUAL_INT8(NOERR, sensirion_execute(TEST_ADDRESS, &command, NULL, response, NULL));
+    TEST_ASSERT_EQUAL_INT(3, writes);
+
+    setUp();
+    corrupt_reads = 3;
+    TEST_ASSERT_EQUAL_INT8(CRC_ERR, sensirion_execute(TEST_ADDRESS, &command, NULL, response, NULL));
+    TEST_ASSERT_EQUAL_INT(3, writes);
+}
+
+void test_write_error_is_not_retried(void) {
+    const struct Sensirion_Command command = {0x03C4, 0, 1, 3, 0};
+    uint8_t response[2];
+
+    write_result = WRITE_ERR;
+    TEST_ASSERT_EQUAL_INT8(WRITE_ERR, sensirion_execute(TEST_ADDRESS, &command, NULL, response, NULL));
+    TEST_ASSERT_EQUAL_INT(1, writes);
+    TEST_ASSERT_EQUAL_INT(0, reads);
+}
+
+void test_calibrates_below_execution_time(void) {
+    const struct Sensirion_Command command = {0x0202, 20000, 1, 1, 0};
+    struct Sensirion_Tuning tuning = {0};
+
+    nacked_reads = 1;
+    TEST_ASSERT_EQUAL_INT8(NOERR, sensirion_calibrate(TEST_ADDRESS, &command, &tuning, NULL));
+    TEST_ASSERT_EQUAL_INT(SENSIRION_CALIBRATION_ROUNDS, writes);
+    TEST_ASSERT_EQUAL_INT(SENSIRION_CALIBRATION_ROUNDS + 1, reads);
+    TEST_ASSERT_EQUAL_UINT32(2 * SENSIRION_PROBE_STEP_US + SENSIRION_MARGIN_MIN_US, tuning.delay_us);
+    TEST_ASSERT_EQUAL_UINT32(tuning.calibrated_us, tuning.delay_us);
+}
+
+void test_failed_calibration_keeps_datasheet_delay(void) {
+    const struct Sensirion_Command command = {0x0202, 2000, 1, 1, 0};
+    const struct Sensirion_Command no_response = {0x0021, 2000, 0, 1, 0};
+    struct Sensirion_Tuning tuning = {0};
+
+    nacked_reads = 1000;
+    TEST_ASSERT_EQUAL_INT8(NACK_ERR, sensirion_calibrate(TEST_ADDRESS, &command, &tuning, NULL));
+    TEST_ASSERT_EQUAL_UINT32(command.execution_us, sensirion_delay(&command, &tuning));
+
+    setUp();
+    TEST_ASSERT_EQUAL_INT8(SIZE_ERR, sensirion_calibrate(TEST_ADDRESS, &no_response, &tuning, NULL));
+    TEST_ASSERT_EQUAL_INT(0, writes);
+}
+
+void test_nack_rereads_and_backs_off(void) {
+    const struct Sensirion_Command command = {0x03C4, 5000, 1, 1, 0};
+    struct Sensirion_Tuning tuning = {.delay_us = 1000, .calibrated_us = 1000};
+    uint8_t response[2];
+
+    nacked_reads = 1;
+    TEST_ASSERT_EQUAL_INT8(NOERR, sensirion_execute(TEST_ADDRESS, &command, &tuning, response, NULL));
+    TEST_ASSERT_EQUAL_INT(1, writes);
+    TEST_ASSERT_EQUAL_INT(2, reads);
+    TEST_ASSERT_EQUAL_UINT32(1, tuning.nacks);
+    TEST_ASSERT_EQUAL_UINT32(1000 + 500 + SENSIRION_MARGIN_MIN_US, tuning.delay_us);
+
+    //A NACK at the execution time isn't the delay's fault
+    setUp();
+    tuning.delay_us = command.execution_us;
+    nacked_reads = 1;
+    TEST_ASSERT_EQUAL_INT8(NACK_ERR, sensirion_execute(TEST_ADDRESS, &command, &tuning, response, NULL));
+    TEST_ASSERT_EQUAL_UINT32(1, tuning.nacks);
+}
+
+void test_clean_reads_tighten_delay(void) {
+    const struct Sensirion_Command command = {0x03C4, 5000, 1, 1, 0};
+    struct Sensirion_Tuning tuning = {.delay_us = 1200, .calibrated_us = 1000};
+    uint8_t response[2];
+
+    for (int i = 0; i < SENSIRION_TIGHTEN_AFTER - 1; ++i) {
+        TEST_ASSERT_EQUAL_INT8(NOERR, sensirion_execute(TEST_ADDRESS, &command, &tuning, response, NULL));
+    }
+    TEST_ASSERT_EQUAL_UINT32(1200, tuning.delay_us);
+
+    TEST_ASSERT_EQUAL_INT8(NOERR, sensirion_execute(TEST_ADDRESS, &command, &tuning, response, NULL));
+    TEST_ASSERT_EQUAL_UINT32(1100, tuning.delay_us);
+    TEST_ASSERT_EQUAL_UINT32(SENSIRION_TIGHTEN_AFTER, tuning.responses);
+}
+
+void test_classifies_crc_errors(void) {
+    const uint8_t ones[] = {0xFF, 0xFF, 0xFF};
+    const uint8_t zeros[] = {0x00, 0x00, 0x00};
+    const uint8_t bad[] = {0xBE, 0xEF, 0x00};
+    const uint8_t other[] = {0xBE, 0xEE, 0x00};
+
+    TEST_ASSERT_EQUAL_INT(SENSIRION_CRC_BUS_STUCK, sensirion_classify(ones, sizeof(ones), NULL));
+    TEST_ASSERT_EQUAL_INT(SENSIRION_CRC_BUS_STUCK, sensirion_classify(zeros, sizeof(zeros), NULL));
+    TEST_ASSERT_EQUAL_INT(SENSIRION_CRC_NOISE, sensirion_classify(bad, sizeof(bad), NULL));
+    TEST_ASSERT_EQUAL_INT(SENSIRION_CRC_NOISE, sensirion_classify(bad, sizeof(bad), other));
+    TEST_ASSERT_EQUAL_INT(SENSIRION_CRC_SYSTEMATIC, sensirion_classify(bad, sizeof(bad), bad));
+}
+
+void test_noise_is_read_again_without_resending(void) {
+    const struct Sensirion_Command command = {0x03C4, 0, 1, 3, 2};
+    struct Sensirion_Tuning tuning = {0};
+    uint8_t response[2];
+
+    corrupt_reads = 2;
+    varied_corruption = true;
+    TEST_ASSERT_EQUAL_INT8(NOERR, sensirion_execute(TEST_ADDRESS, &command, &tuning, response, NULL));
+    TEST_ASSERT_EQUAL_INT(1, writes);
+    TEST_ASSERT_EQUAL_INT(3, reads);
+    TEST_ASSERT_EQUAL_UINT32(2, tuning.rereads);
+    TEST_ASSERT_EQUAL_UINT32(3, tuning.responses);
+    TEST_ASSERT_EQUAL_UINT32(1, tuning.crc_errors[SENSIRION_CRC_NOISE]);
+    TEST_ASSERT_EQUAL_HEX8(0xBE, response[0]);
+}
+
+void test_repeated_bad_bytes_resend_the_command(void) {
+    const struct Sensirion_Command command = {0x03C4, 0, 1, 3, 2};
+    struct Sensirion_Tuning tuning = {0};
+    uint8_t response[2];
+
+    corrupt_reads = 2;
+    TEST_ASSERT_EQUAL_INT8(NOERR, sensirion_execute(TEST_ADDRESS, &command, &tuning, response, NULL));
+    TEST_ASSERT_EQUAL_INT(2, writes);
+    TEST_ASSERT_EQUAL_INT(3, reads);
+    TEST_ASSERT_EQUAL_UINT32(1, tuning.crc_errors[SENSIRION_CRC_SYSTEMATIC]);
+    TEST_ASSERT_EQUAL_UINT32(0, tuning.crc_errors[SENSIRION_CRC_NOISE]);
+}
+
+void test_stuck_bus_is_not_retried(void) {
+    const struct Sensirion_Command command = {0x03C4, 0, 1, 3, 2};
+    struct Sensirion_Tuning tuning = {0};
+    struct Sensirion_Stats stats = {0};
+    uint8_t response[2];
+
+    stuck_reads = 1;
+    TEST_ASSERT_EQUAL_INT8(BUS_ERR, sensirion_execute(TEST_ADDRESS, &command, &tuning, response, NULL));
+    TEST_ASSERT_EQUAL_INT(1, writes);
+    TEST_ASSERT_EQUAL_INT(1, reads);
+
+    sensirion_add_stats(&stats, &tuning);
+    sensirion_add_stats(&stats, &tuning);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.crc_errors[SENSIRION_CRC_BUS_STUCK]);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.responses);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_crc_matches_datasheet);
+    RUN_TEST(test_writes_command_big_endian);
+    RUN_TEST(test_strips_crc_from_response);
+    RUN_TEST(test_retries_until_attempts_run_out);
+    RUN_TEST(test_write_error_is_not_retried);
+    RUN_TEST(test_calibrates_below_execution_time);
+    RUN_TEST(test_failed_calibration_keeps_datasheet_delay);
+    RUN_TEST(test_nack_rereads_and_backs_off);
+    RUN_TEST(test_clean_reads_tighten_delay);
+    RUN_TEST(test_classifies_crc_errors);
+    RUN_TEST(test_noise_is_read_again_without_resending);
+    RUN_TEST(test_repeated_bad_bytes_resend_the_command);
+    RUN_TEST(test_stuck_bus_is_not_retried);
+    return UNITY_END();
+}
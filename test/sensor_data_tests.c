@@ -0,0 +1,57 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/sensor_data.c"
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_schedule_numbers_every_period(void) {
+    struct Sensor_Data sample;
+    uint32_t sequence = 0;
+
+    sensor_data_schedule(&sample, &sequence, 1);
+    TEST_ASSERT_EQUAL_UINT32(0, sample.sequence);
+    TEST_ASSERT_EQUAL_UINT32(1, sequence);
+
+    //The sample takes the latest of the periods started since the last one
+    sensor_data_schedule(&sample, &sequence, 3);
+    TEST_ASSERT_EQUAL_UINT32(3, sample.sequence);
+    TEST_ASSERT_EQUAL_UINT32(4, sequence);
+}
+
+void test_period_without_a_sample_leaves_a_gap(void) {
+    struct Sensor_Data sample;
+    uint32_t sequence = 0;
+    uint32_t previous;
+
+    sensor_data_schedule(&sample, &sequence, 1);
+    previous = sample.sequence;
+    sensor_data_schedule(&sample, &sequence, 1);
+    TEST_ASSERT_EQUAL_UINT32(0, sensor_data_gap(previous, sample.sequence));
+
+    //As if the next period's read failed and its sample was never sent
+    previous = sample.sequence;
+    sensor_data_schedule(&sample, &sequence, 1);
+    sensor_data_schedule(&sample, &sequence, 1);
+    TEST_ASSERT_EQUAL_UINT32(1, sensor_data_gap(previous, sample.sequence));
+}
+
+void test_gap_across_sequence_wraparound(void) {
+    struct Sensor_Data sample;
+    uint32_t sequence = UINT32_MAX;
+
+    sensor_data_schedule(&sample, &sequence, 2);
+    TEST_ASSERT_EQUAL_UINT32(0, sample.sequence);
+    TEST_ASSERT_EQUAL_UINT32(1, sequence);
+
+    TEST_ASSERT_EQUAL_UINT32(0, sensor_data_gap(UINT32_MAX, 0));
+    TEST_ASSERT_EQUAL_UINT32(2, sensor_data_gap(UINT32_MAX - 1, 1));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_schedule_numbers_every_period);
+    RUN_TEST(test_period_without_a_sample_leaves_a_gap);
+    RUN_TEST(test_gap_across_sequence_wraparound);
+    return UNITY_END();
+}
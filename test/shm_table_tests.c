@@ -0,0 +1,97 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/sensor_data.c"
+#include "../src/shm_writer.c"
+#include "../src/shm_reader.c"
+
+#define TEST_SHM_NAME "/air_quality_sensors_test"
+
+static const uint8_t ADDRS[2] = {SEN55_ADDRESS, SCD40_ADDRESS};
+static struct Shm_Table* table;
+static struct Shm_Reader reader;
+
+void setUp() {
+    TEST_ASSERT_EQUAL_INT(NOERR, shm_table_create(TEST_SHM_NAME, &table));
+    shm_table_layout(table, ADDRS, 2);
+    TEST_ASSERT_EQUAL_INT(NOERR, shm_reader_open(TEST_SHM_NAME, &reader));
+}
+
+void tearDown() {
+    shm_reader_close(&reader);
+    shm_table_destroy(TEST_SHM_NAME, &table);
+}
+
+void test_reads_latest_value(void) {
+    struct Sensor_Data sample = {.device_addr = SCD40_ADDRESS, .sequence = 7, .num_data = 3};
+    struct Shm_Handle handle;
+    struct Shm_Value value;
+
+    sample.data[0] = 415.0f;
+    sample.monotonic.tv_sec = 12;
+
+    TEST_ASSERT_EQUAL_INT(NOERR, shm_reader_lookup(&reader, "SCD40", "co2", &handle));
+    TEST_ASSERT_EQUAL_INT(READ_ERR, shm_reader_read(&reader, &handle, &value));
+
+    shm_table_update(table, &sample);
+    TEST_ASSERT_EQUAL_INT(NOERR, shm_reader_read(&reader, &handle, &value));
+    TEST_ASSERT_EQUAL_FLOAT(415.0f, value.value);
+    TEST_ASSERT_EQUAL_UINT32(7, value.sample_sequence);
+    TEST_ASSERT_EQUAL_UINT64(12000, value.monotonic_ms);
+}
+
+void test_unknown_channel_and_stale_handle(void) {
+    struct Shm_Handle handle;
+    struct Shm_Value value;
+
+    TEST_ASSERT_EQUAL_INT(ADDR_ERR, shm_reader_lookup(&reader, "SCD40", "pm2_5", &handle));
+    TEST_ASSERT_EQUAL_INT(NOERR, shm_reader_lookup(&reader, "SEN55", "pm2_5", &handle));
+
+    shm_table_layout(table, ADDRS, 1);
+    TEST_ASSERT_EQUAL_INT(STALE_ERR, shm_reader_read(&reader, &handle, &value));
+}
+
+void test_reordered_devices_start_without_a_value(void) {
+    const uint8_t reordered[2] = {SCD40_ADDRESS, SEN55_ADDRESS};
+    struct Sensor_Data sample = {.device_addr = SCD40_ADDRESS, .sequence = 7, .num_data = 3};
+    struct Shm_Handle handle;
+    struct Shm_Value value;
+
+    sample.data[0] = 415.0f;
+    sample.monotonic.tv_sec = 12;
+    shm_table_update(table, &sample);
+
+    //The SEN55 now sits where the SCD40's readings were
+    shm_table_layout(table, reordered, 2);
+    TEST_ASSERT_EQUAL_INT(NOERR, shm_reader_lookup(&reader, "SEN55", "pm1_0", &handle));
+    TEST_ASSERT_EQUAL_INT(READ_ERR, shm_reader_read(&reader, &handle, &value));
+    TEST_ASSERT_EQUAL_INT(NOERR, shm_reader_lookup(&reader, "SCD40", "co2", &handle));
+    TEST_ASSERT_EQUAL_INT(READ_ERR, shm_reader_read(&reader, &handle, &value));
+
+    shm_table_update(table, &sample);
+    TEST_ASSERT_EQUAL_INT(NOERR, shm_reader_read(&reader, &handle, &value));
+    TEST_ASSERT_EQUAL_FLOAT(415.0f, value.value);
+}
+
+void test_create_closes_interrupted_writes(void) {
+    struct Shm_Table* reopened;
+    struct Shm_Handle handle;
+    struct Shm_Value value;
+
+    //As if the publisher crashed in the middle of writing
+    atomic_fetch_add(&table->layout, 1);
+    atomic_fetch_add(&table->devices[1].slots[0].sequence, 1);
+
+    TEST_ASSERT_EQUAL_INT(NOERR, shm_table_create(TEST_SHM_NAME, &reopened));
+    TEST_ASSERT_EQUAL_UINT32(0, atomic_load(&reopened->layout) & 1);
+    TEST_ASSERT_EQUAL_INT(NOERR, shm_reader_lookup(&reader, "SCD40", "co2", &handle));
+    TEST_ASSERT_EQUAL_INT(READ_ERR, shm_reader_read(&reader, &handle, &value));
+    munmap(reopened, sizeof(*reopened));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_reads_latest_value);
+    RUN_TEST(test_unknown_channel_and_stale_handle);
+    RUN_TEST(test_reordered_devices_start_without_a_value);
+    RUN_TEST(test_create_closes_interrupted_writes);
+    return UNITY_END();
+}
@@ -0,0 +1,111 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/timing_stats.c"
+
+static struct Timing_Stats stats;
+
+void setUp() {
+    memset(&stats, 0, sizeof(stats));
+}
+
+void tearDown() {}
+
+/**
+ * @brief Makes a sample read the lateness after its scheduled time
+ *
+ * @param lateness_us the lateness in microseconds
+ * @param overruns the periods the device has missed so far
+ * @return the sample
+ */
+static struct Sensor_Data late_sample(uint64_t lateness_us, uint32_t overruns) {
+    //Scheduled just before a second boundary so the read usually lands after it
+    struct Sensor_Data sample = {.overruns = overruns, .scheduled = {.tv_sec = 10, .tv_nsec = 999000000}};
+    uint64_t read_us = (uint64_t)sample.scheduled.tv_nsec / 1000 + lateness_us;
+
+    sample.monotonic.tv_sec = sample.scheduled.tv_sec + (time_t)(read_us / 1000000);
+    sample.monotonic.tv_nsec = (long)(read_us % 1000000) * 1000;
+    return sample;
+}
+
+/**
+ * @brief Adds the samples, all read the same lateness after their scheduled times
+ *
+ * @param count the number of samples
+ * @param lateness_us the lateness in microseconds
+ */
+static void add_samples(int count, uint64_t lateness_us) {
+    for (int i = 0; i < count; ++i) {
+        struct Sensor_Data sample = late_sample(lateness_us, 0);
+
+        timing_stats_add(&stats, &sample);
+    }
+}
+
+void test_lateness_crosses_seconds_and_ignores_early_reads(void) {
+    struct Sensor_Data sample = late_sample(2500, 0);
+
+    TEST_ASSERT_EQUAL_UINT64(2500, timing_lateness_us(&sample));
+
+    sample.monotonic = sample.scheduled;
+    sample.monotonic.tv_nsec -= 1000;
+    TEST_ASSERT_EQUAL_UINT64(0, timing_lateness_us(&sample));
+}
+
+void test_bucket_edges_are_powers_of_two(void) {
+    TEST_ASSERT_EQUAL_INT(0, lateness_bucket(0));
+    TEST_ASSERT_EQUAL_INT(0, lateness_bucket(1));
+    TEST_ASSERT_EQUAL_INT(1, lateness_bucket(2));
+    TEST_ASSERT_EQUAL_INT(1, lateness_bucket(3));
+    TEST_ASSERT_EQUAL_INT(2, lateness_bucket(4));
+    TEST_ASSERT_EQUAL_INT(9, lateness_bucket(1023));
+    TEST_ASSERT_EQUAL_INT(10, lateness_bucket(1024));
+
+    //Anything past the last bucket's lower bound is kept in it
+    TEST_ASSERT_EQUAL_INT(TIMING_BUCKETS - 1, lateness_bucket(1ULL << (TIMING_BUCKETS - 1)));
+    TEST_ASSERT_EQUAL_INT(TIMING_BUCKETS - 1, lateness_bucket(UINT64_MAX));
+}
+
+void test_percentiles_are_bucket_upper_bounds(void) {
+    TEST_ASSERT_EQUAL_UINT64(0, timing_stats_percentile(&stats, 50));
+
+    add_samples(90, 10);
+    add_samples(9, 600);
+    add_samples(1, 5000);
+
+    TEST_ASSERT_EQUAL_UINT64(100, stats.samples);
+    TEST_ASSERT_EQUAL_UINT64(5000, stats.max_lateness_us);
+    TEST_ASSERT_EQUAL_UINT64(15, timing_stats_percentile(&stats, 50));
+    TEST_ASSERT_EQUAL_UINT64(15, timing_stats_percentile(&stats, 90));
+    TEST_ASSERT_EQUAL_UINT64(1023, timing_stats_percentile(&stats, 95));
+    TEST_ASSERT_EQUAL_UINT64(1023, timing_stats_percentile(&stats, 99));
+    TEST_ASSERT_EQUAL_UINT64(5000, timing_stats_percentile(&stats, 100));
+}
+
+void test_percentiles_are_capped_at_the_max(void) {
+    add_samples(1, 5);
+
+    TEST_ASSERT_EQUAL_UINT64(5, timing_stats_percentile(&stats, 0));
+    TEST_ASSERT_EQUAL_UINT64(5, timing_stats_percentile(&stats, 50));
+    TEST_ASSERT_EQUAL_UINT64(5, timing_stats_percentile(&stats, 99.9));
+}
+
+void test_keeps_the_latest_overrun_count(void) {
+    struct Sensor_Data sample = late_sample(100, 3);
+
+    timing_stats_add(&stats, &sample);
+    sample.overruns = 7;
+    timing_stats_add(&stats, &sample);
+
+    TEST_ASSERT_EQUAL_UINT32(7, stats.overruns);
+    TEST_ASSERT_EQUAL_UINT64(100, stats.last_lateness_us);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.histogram[6]);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_lateness_crosses_seconds_and_ignores_early_reads);
+    RUN_TEST(test_bucket_edges_are_powers_of_two);
+    RUN_TEST(test_percentiles_are_bucket_upper_bounds);
+    RUN_TEST(test_percentiles_are_capped_at_the_max);
+    RUN_TEST(test_keeps_the_latest_overrun_count);
+    return UNITY_END();
+}
@@ -0,0 +1,50 @@
+#include "../unity/Unity/src/unity.h"
+#include "../src/topics.c"
+
+static struct Topic_Aliases aliases;
+static char topic[TOPIC_SIZE];
+
+void setUp() {
+    topic_aliases_reset(&aliases, 2);
+}
+
+void tearDown() {}
+
+void test_expands_every_placeholder(void) {
+    TEST_ASSERT_EQUAL_INT(NOERR, topic_format(topic, sizeof(topic), 
+                            "sensors/{gateway}/{device}/{channel}", "gw1", "SCD40", "co2"));
+    TEST_ASSERT_EQUAL_STRING("sensors/gw1/SCD40/co2", topic);
+}
+
+void test_rejects_unknown_placeholders_and_long_topics(void) {
+    TEST_ASSERT_EQUAL_INT(CONFIG_ERR, topic_format(topic, sizeof(topic), 
+                            "sensors/{site}", "gw1", "SCD40", "co2"));
+    TEST_ASSERT_EQUAL_INT(SIZE_ERR, topic_format(topic, 8, 
+                            "sensors/{channel}", "gw1", "SCD40", "co2"));
+}
+
+void test_assigns_aliases_up_to_the_maximum(void) {
+    bool established;
+
+    TEST_ASSERT_EQUAL_UINT16(1, topic_alias_lookup(&aliases, "a", &established));
+    TEST_ASSERT_FALSE(established);
+    topic_alias_established(&aliases, 1);
+
+    TEST_ASSERT_EQUAL_UINT16(1, topic_alias_lookup(&aliases, "a", &established));
+    TEST_ASSERT_TRUE(established);
+    TEST_ASSERT_EQUAL_UINT16(2, topic_alias_lookup(&aliases, "b", &established));
+    TEST_ASSERT_EQUAL_UINT16(0, topic_alias_lookup(&aliases, "c", &established));
+
+    //A new connection starts without any aliases
+    topic_aliases_reset(&aliases, 2);
+    TEST_ASSERT_EQUAL_UINT16(1, topic_alias_lookup(&aliases, "c", &established));
+    TEST_ASSERT_FALSE(established);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_expands_every_placeholder);
+    RUN_TEST(test_rejects_unknown_placeholders_and_long_topics);
+    RUN_TEST(test_assigns_aliases_up_to_the_maximum);
+    return UNITY_END();
+}